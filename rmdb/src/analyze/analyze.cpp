@@ -86,6 +86,12 @@ std::shared_ptr<Query> Analyze::do_analyze(
         for (auto& sv_val : x->vals) {
             query->values.push_back(convert_sv_value(sv_val));
         }
+    } else if (auto x = std::dynamic_pointer_cast<ast::LoadData>(parse)) {
+        // 检查表是否存在
+        if (!sm_manager_->db_.is_table(x->tab_name)) {
+            throw TableNotFoundError(x->tab_name);
+        }
+        query->tables = {x->tab_name};
     } else {
         // do nothing
     }
@@ -185,7 +191,7 @@ void Analyze::check_clause(const std::vector<std::string>& tab_names,
             auto rhs_col = rhs_tab.get_col(cond.rhs_col.col_name);
             rhs_type = rhs_col->type;
         }
-        if (lhs_type != rhs_type) {
+        if (!is_same_type(lhs_type, rhs_type)) {
             if (lhs_type == ColType::TYPE_INT &&
                 rhs_type == ColType::TYPE_FLOAT) {
             } else if (lhs_type == ColType::TYPE_FLOAT &&
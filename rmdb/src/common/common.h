@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <cassert>
+#include <cctype>
 #include <cstring>
 #include <memory>
 #include <regex>
@@ -34,6 +35,40 @@ struct OrderCol {
     bool is_desc_;
 };
 
+/**
+ * @description: 解析"YYYY-MM-DD HH:MM:SS"格式的时间字符串（日期与时间之间允许多个空白字符），
+ *               结果按YYYYMMDDHHMMSS编码为int64_t，例如20230722205031
+ * @return {bool} 格式是否合法，只检查格式，不检查各字段的取值范围
+ * @param {char*} str 时间字符串首地址，不要求以'\0'结尾
+ * @param {size_t} len 时间字符串长度
+ * @param {int64_t*} datetime 传出参数，编码后的时间
+ */
+inline bool parse_datetime(const char *str, size_t len, int64_t *datetime) {
+    // 依次读取width位数字，累加到res中
+    auto read_digits = [&](size_t &pos, int width, int64_t &res) {
+        if (pos + width > len) return false;
+        for (int i = 0; i < width; ++i, ++pos) {
+            unsigned char c = str[pos] - '0';
+            if (c > 9) return false;
+            res = res * 10 + c;
+        }
+        return true;
+    };
+    size_t pos = 0;
+    int64_t res = 0;
+    if (!read_digits(pos, 4, res) || pos >= len || str[pos++] != '-') return false;
+    if (!read_digits(pos, 2, res) || pos >= len || str[pos++] != '-') return false;
+    if (!read_digits(pos, 2, res)) return false;
+    size_t space_begin = pos;
+    while (pos < len && isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+    if (pos == space_begin) return false;
+    if (!read_digits(pos, 2, res) || pos >= len || str[pos++] != ':') return false;
+    if (!read_digits(pos, 2, res) || pos >= len || str[pos++] != ':') return false;
+    if (!read_digits(pos, 2, res) || pos != len) return false;
+    *datetime = res;
+    return true;
+}
+
 struct Value {
     ColType type;  // type of value
     union {
@@ -62,17 +97,9 @@ struct Value {
 
     void set_dateTime(std::string datetime_val_) {
         type = TYPE_DATETIME;
-
-        static const std::regex pattern(
-            R"(^(\d{4})-(\d{2})-(\d{2})\s+(\d{2}):(\d{2}):(\d{2})$)");
-        std::smatch match;
-        std::regex_match(datetime_val_, match, pattern);
-        std::string resStr;
-        for (int i = 1; i <= 6; i++) {
-            resStr += match.str(i);
+        if (!parse_datetime(datetime_val_.data(), datetime_val_.size(), &datetime_val)) {
+            throw DateTimeAbsurdError("", datetime_val_);
         }
-
-        datetime_val = std::stoll(resStr);
     }
 
     void init_raw(int len) {
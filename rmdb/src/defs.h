@@ -40,7 +40,7 @@ struct Rid {
 };
 
 enum ColType {
-    TYPE_INT, TYPE_FLOAT, TYPE_STRING, TYPE_DATETIME
+    TYPE_INT, TYPE_FLOAT, TYPE_STRING, TYPE_DATETIME, TYPE_VARCHAR
 };
 
 inline std::string coltype2str(ColType type) {
@@ -48,11 +48,19 @@ inline std::string coltype2str(ColType type) {
             {TYPE_INT,    "INT"},
             {TYPE_FLOAT,  "FLOAT"},
             {TYPE_STRING, "STRING"},
-            {TYPE_DATETIME, "DATETIME"}
+            {TYPE_DATETIME, "DATETIME"},
+            {TYPE_VARCHAR, "VARCHAR"}
     };
     return m.at(type);
 }
 
+// CHAR(n)和VARCHAR(n)在内存中都是n字节、以'\0'补齐的字符串，只有落盘格式不同，比较和赋值时视为相同类型
+inline bool is_string_type(ColType type) { return type == TYPE_STRING || type == TYPE_VARCHAR; }
+
+inline bool is_same_type(ColType lhs, ColType rhs) {
+    return lhs == rhs || (is_string_type(lhs) && is_string_type(rhs));
+}
+
 class RecScan {
 public:
     virtual ~RecScan() = default;
@@ -71,7 +71,17 @@ class InvalidRecordSizeError : public RMDBError {
     InvalidRecordSizeError(int record_size) : RMDBError("Invalid record size: " + std::to_string(record_size)) {}
 };
 
+class InvalidStorageFormatError : public RMDBError {
+   public:
+    InvalidStorageFormatError(const std::string &storage) : RMDBError("Invalid storage format: " + storage) {}
+};
+
 // IX errors
+class InvalidFillFactorError : public RMDBError {
+   public:
+    InvalidFillFactorError(int fill_factor) : RMDBError("Invalid fill factor: " + std::to_string(fill_factor)) {}
+};
+
 class InvalidColLengthError : public RMDBError {
    public:
     InvalidColLengthError(int col_len) : RMDBError("Invalid column length: " + std::to_string(col_len)) {}
@@ -132,6 +142,44 @@ class IndexExistsError : public RMDBError {
     }
 };
 
+class InvalidIndexError : public RMDBError {
+   public:
+    InvalidIndexError(const std::string &tab_name, const std::vector<std::string> &col_names,
+                      const std::string &reason) {
+        _msg += "Cannot create index " + tab_name + ".(";
+        for(size_t i = 0; i < col_names.size(); ++i) {
+            if(i > 0) _msg += ", ";
+            _msg += col_names[i];
+        }
+        _msg += "): " + reason;
+    }
+};
+
+class UniqueConstraintError : public RMDBError {
+   public:
+    UniqueConstraintError(const std::string &tab_name, const std::vector<std::string> &col_names) {
+        _msg += "Duplicate key violates unique index: " + tab_name + ".(";
+        for(size_t i = 0; i < col_names.size(); ++i) {
+            if(i > 0) _msg += ", ";
+            _msg += col_names[i];
+        }
+        _msg += ")";
+    }
+};
+
+class InvalidReindexError : public RMDBError {
+   public:
+    InvalidReindexError(const std::string &tab_name, const std::vector<std::string> &col_names,
+                        const std::string &reason) {
+        _msg += "Cannot reindex " + tab_name + ".(";
+        for(size_t i = 0; i < col_names.size(); ++i) {
+            if(i > 0) _msg += ", ";
+            _msg += col_names[i];
+        }
+        _msg += "): " + reason;
+    }
+};
+
 // QL errors
 class InvalidValueCountError : public RMDBError {
    public:
@@ -0,0 +1,80 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/* 有界的多生产者单消费者队列，用于并行算子把工作线程的结果交给上层算子，不保证顺序
+ * 队列满时生产者阻塞；所有生产者结束后消费者取空队列即结束；消费者可以提前close()让生产者退出 */
+template <typename T>
+class ExchangeQueue {
+   private:
+    std::mutex latch_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    size_t capacity_;
+    int num_producers_ = 0;    // 还没有结束的生产者个数
+    bool closed_ = false;      // 消费者不再需要数据
+
+   public:
+    explicit ExchangeQueue(size_t capacity) : capacity_(capacity) {}
+
+    /* 开始新一轮生产，只能在没有生产者运行时调用 */
+    void reset(int num_producers) {
+        std::lock_guard<std::mutex> lock(latch_);
+        items_.clear();
+        num_producers_ = num_producers;
+        closed_ = false;
+    }
+
+    /* 放入一项数据，队列已关闭时返回false，生产者应当停止 */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(latch_);
+        not_full_.wait(lock, [&] { return items_.size() < capacity_ || closed_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /* 取出一项数据，所有生产者都结束且队列为空时返回false */
+    bool pop(T *item) {
+        std::unique_lock<std::mutex> lock(latch_);
+        not_empty_.wait(lock, [&] { return !items_.empty() || num_producers_ == 0 || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        *item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void producer_done() {
+        std::lock_guard<std::mutex> lock(latch_);
+        if (--num_producers_ == 0) {
+            not_empty_.notify_all();
+        }
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(latch_);
+        closed_ = true;
+        items_.clear();
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+};
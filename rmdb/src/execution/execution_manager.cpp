@@ -23,16 +23,19 @@ See the Mulan PSL v2 for more details. */
 const char *help_info = "Supported SQL syntax:\n"
                    "  command ;\n"
                    "command:\n"
-                   "  CREATE TABLE table_name (column_name type [, column_name type ...])\n"
+                   "  CREATE TABLE table_name (column_name type [, column_name type ...]) [STORAGE = {FIXED | SLOTTED | PAX}]\n"
                    "  DROP TABLE table_name\n"
                    "  CREATE INDEX table_name (column_name)\n"
                    "  DROP INDEX table_name (column_name)\n"
+                   "  REINDEX table_name (column_name)\n"
+                   "  SHOW INDEX STATS table_name\n"
                    "  INSERT INTO table_name VALUES (value [, value ...])\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "  LOAD DATA INFILE 'file_name' INTO TABLE table_name\n"
                    "type:\n"
-                   "  {INT | FLOAT | CHAR(n)}\n"
+                   "  {INT | FLOAT | CHAR(n) | VARCHAR(n) | DATETIME}\n"
                    "where_clause:\n"
                    "  condition [AND condition ...]\n"
                    "condition:\n"
@@ -50,7 +53,17 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
         switch(x->tag) {
             case T_CreateTable:
             {
-                sm_manager_->create_table(x->tab_name_, x->cols_, context);
+                sm_manager_->create_table(x->tab_name_, x->cols_, x->storage_, context);
+                if (!x->tab_col_names_.empty()) {
+                    // 主键：在主键字段上建立唯一的B+树索引，失败时（如主键字段不存在）把表也删除
+                    try {
+                        sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context, IX_DEFAULT_FILL_FACTOR,
+                                                  INDEX_BTREE, true);
+                    } catch (RMDBError &) {
+                        sm_manager_->drop_table(x->tab_name_, context);
+                        throw;
+                    }
+                }
                 break;
             }
             case T_DropTable:
@@ -60,7 +73,8 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
             }
             case T_CreateIndex:
             {
-                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context);
+                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context, x->fill_factor_, x->index_type_,
+                                          x->unique_, x->bloom_);
                 break;
             }
             case T_DropIndex:
@@ -68,6 +82,11 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
                 sm_manager_->drop_index(x->tab_name_, x->tab_col_names_, context);
                 break;
             }
+            case T_Reindex:
+            {
+                sm_manager_->reindex(x->tab_name_, x->tab_col_names_, context);
+                break;
+            }
             default:
                 throw InternalError("Unexpected field type");
                 break;  
@@ -95,6 +114,11 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->desc_table(x->tab_name_, context);
                 break;
             }
+            case T_ShowIndexStats:
+            {
+                sm_manager_->show_index_stats(x->tab_name_, context);
+                break;
+            }
             case T_Transaction_begin:
             {
                 // 显示开启一个事务
@@ -119,6 +143,12 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 txn_mgr_->abort(context->txn_, context->log_mgr_);
                 break;
             }     
+            case T_LoadData:
+            {
+                auto load_plan = std::dynamic_pointer_cast<LoadDataPlan>(x);
+                sm_manager_->load_data(load_plan->file_name_, load_plan->tab_name_, context);
+                break;
+            }
             default:
                 throw InternalError("Unexpected field type");
                 break;                        
@@ -153,52 +183,56 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
     // Print records
     size_t num_rec = 0;
 
-    // 执行query_plan
-    for (executorTreeRoot->beginTuple(); !executorTreeRoot->is_end(); executorTreeRoot->nextTuple()) {
-        auto Tuple = executorTreeRoot->Next();
-        std::vector<std::string> columns;
-        for (auto &col : executorTreeRoot->cols()) {
-            std::string col_str;
-            char *rec_buf = Tuple->data + col.offset;
-            if (col.type == TYPE_INT) {
-                col_str = std::to_string(*(int *)rec_buf);
-            } else if (col.type == TYPE_FLOAT) {
-                col_str = std::to_string(*(float *)rec_buf);
-            } else if (col.type == TYPE_STRING) {
-                col_str = std::string((char *)rec_buf, col.len);
-                col_str.resize(strlen(col_str.c_str()));
-            } else if(col.type == TYPE_DATETIME){
-                std::string str = std::to_string(*(int64_t *)rec_buf);
-                col_str.reserve(16);  // 预分配内存
-                // 拼接年
-                col_str += str.substr(0, 4);
-                col_str += "-";
-                // 拼接月
-                col_str += str.substr(4, 2);
-                col_str += "-";
-                // 拼接日
-                col_str += str.substr(6, 2);
-                col_str += " ";
-                // 拼接时
-                col_str += str.substr(8, 2);
-                col_str += ":";
-                // 拼接分
-                col_str += str.substr(10, 2);
-                col_str += ":";
-                // 拼接秒
-                col_str += str.substr(12, 2);
+    // 按批执行query_plan
+    TupleBatch batch;
+    executorTreeRoot->beginBatch();
+    while (executorTreeRoot->NextBatch(batch)) {
+        for (size_t k = 0; k < batch.num_sel; ++k) {
+            char *tuple_data = batch.selected(k);
+            std::vector<std::string> columns;
+            for (auto &col : executorTreeRoot->cols()) {
+                std::string col_str;
+                char *rec_buf = tuple_data + col.offset;
+                if (col.type == TYPE_INT) {
+                    col_str = std::to_string(*(int *)rec_buf);
+                } else if (col.type == TYPE_FLOAT) {
+                    col_str = std::to_string(*(float *)rec_buf);
+                } else if (is_string_type(col.type)) {
+                    col_str = std::string((char *)rec_buf, col.len);
+                    col_str.resize(strlen(col_str.c_str()));
+                } else if(col.type == TYPE_DATETIME){
+                    std::string str = std::to_string(*(int64_t *)rec_buf);
+                    col_str.reserve(16);  // 预分配内存
+                    // 拼接年
+                    col_str += str.substr(0, 4);
+                    col_str += "-";
+                    // 拼接月
+                    col_str += str.substr(4, 2);
+                    col_str += "-";
+                    // 拼接日
+                    col_str += str.substr(6, 2);
+                    col_str += " ";
+                    // 拼接时
+                    col_str += str.substr(8, 2);
+                    col_str += ":";
+                    // 拼接分
+                    col_str += str.substr(10, 2);
+                    col_str += ":";
+                    // 拼接秒
+                    col_str += str.substr(12, 2);
+                }
+                columns.push_back(col_str);
             }
-            columns.push_back(col_str);
-        }
-        // print record into buffer
-        rec_printer.print_record(columns, context);
-        // print record into file
-        outfile << "|";
-        for(size_t i = 0; i < columns.size(); ++i) {
-            outfile << " " << columns[i] << " |";
+            // print record into buffer
+            rec_printer.print_record(columns, context);
+            // print record into file
+            outfile << "|";
+            for(size_t i = 0; i < columns.size(); ++i) {
+                outfile << " " << columns[i] << " |";
+            }
+            outfile << "\n";
+            num_rec++;
         }
-        outfile << "\n";
-        num_rec++;
     }
     outfile.close();
     // Print footer into buffer
@@ -41,20 +41,21 @@ class SortExecutor : public AbstractExecutor {
         // 清空已使用的元组
         used_tuple.clear();
 
-        // 初始化前一个执行器的元组
-        prev_->beginTuple();
+        tuples.clear();
+        tuple_num = 0;
 
-        // 检查前一个执行器是否已结束，如果已结束，则当前执行器也结束
-        if (prev_->is_end()) {
-            is_end_ = true;
-            return;
-        } else {
-            is_end_ = false;
+        // 按批读取前一个执行器的所有记录，收集到tuples中
+        prev_->beginBatch();
+        TupleBatch batch;
+        size_t len = prev_->tupleLen();
+        while (prev_->NextBatch(batch)) {
+            for (size_t k = 0; k < batch.num_sel; ++k) {
+                tuples.push_back(std::make_unique<RmRecord>(len, batch.selected(k)));
+            }
         }
-
-        // 遍历前一个执行器的所有记录，收集到tuples中
-        for (; !prev_->is_end(); prev_->nextTuple()) {
-            tuples.push_back(prev_->Next());
+        is_end_ = tuples.empty();
+        if (is_end_) {
+            return;
         }
 
         // 对收集到的记录进行排序
@@ -85,13 +86,20 @@ class SortExecutor : public AbstractExecutor {
     }
 
     void nextTuple() override {
-        prev_->nextTuple();
-        if (prev_->is_end()) {
-            is_end_ = true;
-        }
         tuple_num++;
     }
 
+    void beginBatch() override { beginTuple(); }
+
+    bool NextBatch(TupleBatch& batch) override {
+        batch.reset(tupleLen());
+        while (!is_end() && !batch.full()) {
+            memcpy(batch.append(_abstract_rid), tuples[tuple_num]->data, batch.tuple_len);
+            tuple_num++;
+        }
+        return batch.num_sel > 0;
+    }
+
     std::unique_ptr<RmRecord> Next() override {
         return std::move(tuples[tuple_num]);
     }
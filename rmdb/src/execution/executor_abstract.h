@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/common.h"
 #include "index/ix.h"
 #include "system/sm.h"
+#include "tuple_batch.h"
 
 class AbstractExecutor {
    public:
@@ -44,6 +45,23 @@ class AbstractExecutor {
 
     virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta();};
 
+    /* 向量化接口：开始按批读取。同一个算子要么逐条读取，要么按批读取，不能混用 */
+    virtual void beginBatch() { beginTuple(); }
+
+    /**
+     * @description: 读取下一批记录，返回false表示已经没有记录；返回true时batch中至少有一条有效记录
+     * 默认实现逐条调用Next()拼成一批，供还没有实现向量化的算子使用
+     */
+    virtual bool NextBatch(TupleBatch &batch) {
+        batch.reset(tupleLen());
+        while (!is_end() && !batch.full()) {
+            auto rec = Next();
+            memcpy(batch.append(rid()), rec->data, batch.tuple_len);
+            nextTuple();
+        }
+        return batch.num_sel > 0;
+    }
+
     std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
         auto pos = std::find_if(rec_cols.begin(), rec_cols.end(), [&](const ColMeta &col) {
             return col.tab_name == target.tab_name && col.name == target.col_name;
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
+#include "predicate.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
@@ -23,7 +24,7 @@ private:
     std::vector<ColMeta> cols_;                 // join后记录的字段元数据
 
     std::vector<Condition> fed_conds_;          // join条件
-    std::vector<std::pair<ColMeta, ColMeta>> join_cols_; // 连接的列对
+    PredicateList preds_;                       // 编译后的join条件
     bool is_end_;                              // 是否已结束
 
     static constexpr int JOIN_POOL_SIZE = BUFFER_POOL_SIZE / 2; // join缓冲池大小
@@ -102,7 +103,7 @@ private:
                     while (right_buffer_page_inner_iter_ < right_num_now_inner_) {
                         memcpy(join_record.data + left_len_, right_page->get_data() + right_buffer_page_inner_iter_ * right_len_, right_len_);
                         right_buffer_page_inner_iter_++;
-                        if (CheckConditions(join_record.data)) {
+                        if (preds_.eval(join_record.data)) {
                             return true; // 如果条件满足，则返回true
                         }
                     }
@@ -145,11 +146,11 @@ public:
             assert(!cond.is_rhs_val);
             auto left_join_col = *get_col(cols_, cond.lhs_col);
             auto right_join_col = *get_col(cols_, cond.rhs_col);
-            if (left_join_col.type != right_join_col.type) {
+            if (!is_same_type(left_join_col.type, right_join_col.type)) {
                 throw IncompatibleTypeError(coltype2str(left_join_col.type), coltype2str(right_join_col.type));
             }
-            join_cols_.emplace_back(left_join_col, right_join_col);
         }
+        preds_.compile(cols_, fed_conds_);
     }
 
     void beginTuple() override {
@@ -195,6 +196,18 @@ public:
         }
     }
 
+    void beginBatch() override { beginTuple(); }
+
+    // 两侧仍逐条读入缓冲页面，连接结果直接拷贝进batch
+    bool NextBatch(TupleBatch& batch) override {
+        batch.reset(len_);
+        while (!is_end_ && !batch.full()) {
+            memcpy(batch.append(_abstract_rid), join_record.data, len_);
+            nextTuple();
+        }
+        return batch.num_sel > 0;
+    }
+
     std::unique_ptr<RmRecord> Next() override {
         if (is_end_) {
             return nullptr; // 如果已经结束，返回nullptr
@@ -223,34 +236,4 @@ public:
     ColMeta get_col_offset(const TabCol& target) override {
         return AbstractExecutor::get_col_offset(target); // 返回字段的偏移量
     }
-
-    bool CheckConditions(const char* data) {
-        bool result = true;
-        auto join_size = fed_conds_.size();
-        for (decltype(join_size) i = 0; i < join_size; i++) {
-            result &= CheckCondition(data, i); // 检查每个条件
-        }
-        return result;
-    }
-
-    bool CheckCondition(const char* data, const size_t i) {
-        const auto& left_col = join_cols_.at(i).first;
-        const auto& right_col = join_cols_.at(i).second;
-        const char* l_value = data + left_col.offset;
-        const char* r_value = data + right_col.offset;
-        int cmp = ix_compare(l_value, r_value, left_col.type, left_col.len);
-        return eval_cmp_result(fed_conds_.at(i), cmp); // 判断条件是否成立
-    }
-
-    bool eval_cmp_result(const Condition& cond, int cmp) {
-        switch (cond.op) {
-            case OP_EQ: return cmp == 0;
-            case OP_NE: return cmp != 0;
-            case OP_LT: return cmp < 0;
-            case OP_GT: return cmp > 0;
-            case OP_LE: return cmp <= 0;
-            case OP_GE: return cmp >= 0;
-            default: throw InternalError("Unexpected op type"); // 未知的操作类型
-        }
-    }
 };
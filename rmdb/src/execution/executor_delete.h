@@ -44,8 +44,10 @@ class DeleteExecutor : public AbstractExecutor {
             // 获取记录
             auto rec = fh_->get_record(rid, context_);
             
-            // 删除记录文件中的记录
+            // 先删除记录文件中的记录，再删除索引中的键值对，
+            // 在线REINDEX开始记录旁路日志时，之前对索引的修改都已经写入表中
             fh_->delete_record(rid, context_);
+            sm_manager_->delete_index_entries(tab_, rec->data, rid, context_->txn_);
 
         }
 
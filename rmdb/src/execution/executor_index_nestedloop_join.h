@@ -0,0 +1,247 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "predicate.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/* 索引嵌套循环连接：右侧（内表）的B+树索引前缀字段上都有等值条件，值来自左侧（外表）的连接字段或内表上的常量条件。
+ * 每次从外表按批读取一批记录，按编码后的探测key排序后依次在索引中查找，相邻的探测落在同一个或相邻的叶结点上，
+ * 这些页面仍在缓冲池中；探测key相同的外表记录共用一次查找的结果。输出仍按外表记录的原有顺序，
+ * 记录格式与其他连接算子相同，左侧在前。内表上的其余条件在取出内表记录后检查，连接条件在拼接后全部检查 */
+class IndexNestedLoopJoinExecutor : public AbstractExecutor {
+   private:
+    /* 探测key中的一个字段：取自外表记录的outer_offset处，或者是常量value */
+    struct ProbeCol {
+        bool from_outer;
+        int outer_offset;
+        const char *value;
+        int len;
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;        // 外表执行器
+    std::vector<ColMeta> right_cols_;               // 内表记录的字段元数据
+    std::vector<Condition> inner_conds_;            // 内表上的条件
+    PredicateList inner_preds_;                     // 编译后的inner_conds_
+    RmFileHandle *fh_;
+    IxIndexHandle *ih_;
+    BufferPoolManager *bpm_;
+    std::vector<ProbeCol> probe_cols_;
+    int key_len_;                                   // 编码后的索引key的长度，包括非唯一索引附加的rid字段
+    int prefix_len_;                                // 探测key的前缀长度
+
+    size_t left_len_;
+    size_t right_len_;
+    size_t len_;                                    // join后每条记录的总长度
+    std::vector<ColMeta> cols_;                     // join后记录的字段元数据
+    std::vector<Condition> fed_conds_;              // join条件
+    PredicateList preds_;                           // 编译后的fed_conds_
+
+    TupleBatch outer_;                              // 当前批次的外表记录
+    std::vector<std::vector<Rid>> matches_;         // 每条有效的外表记录在索引中找到的rid
+    size_t batch_pos_ = 0;
+    size_t match_pos_ = 0;
+    bool is_end_ = true;
+    RmRecord join_record_;
+
+   public:
+    IndexNestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, SmManager *sm_manager, const std::string &tab_name,
+                                std::vector<Condition> inner_conds, const std::vector<std::string> &index_col_names,
+                                std::vector<Condition> conds, Context *context) {
+        context_ = context;
+        left_ = std::move(left);
+        inner_conds_ = std::move(inner_conds);
+        TabMeta &tab = sm_manager->db_.get_table(tab_name);
+        right_cols_ = tab.cols;
+        fh_ = sm_manager->fhs_.at(tab_name).get();
+        ih_ = sm_manager->ihs_.at(sm_manager->get_ix_manager()->get_index_name(tab_name, index_col_names)).get();
+        bpm_ = sm_manager->get_bpm();
+        fed_conds_ = std::move(conds);
+
+        left_len_ = left_->tupleLen();
+        right_len_ = right_cols_.back().offset + right_cols_.back().len;
+        len_ = left_len_ + right_len_;
+        join_record_ = RmRecord(len_);
+        cols_ = left_->cols();
+        for (auto col : right_cols_) {
+            col.offset += left_len_;
+            cols_.push_back(col);
+        }
+        inner_preds_.compile(right_cols_, inner_conds_);
+        preds_.compile(cols_, fed_conds_);
+
+        // 依次为索引的每个字段找等值条件，先找连接条件，再找内表上的常量条件，找不到时探测key的前缀到此为止
+        const IndexMeta &index = *tab.get_index_meta(index_col_names);
+        key_len_ = ih_->get_key_codec().key_len();
+        prefix_len_ = 0;
+        for (auto &col : index.cols) {
+            bool found = false;
+            for (auto &cond : fed_conds_) {
+                if (cond.op != OP_EQ || cond.is_rhs_val) {
+                    continue;
+                }
+                const TabCol *outer = cond.lhs_col.tab_name == tab_name && cond.lhs_col.col_name == col.name ? &cond.rhs_col
+                                      : cond.rhs_col.tab_name == tab_name && cond.rhs_col.col_name == col.name ? &cond.lhs_col
+                                                                                                                : nullptr;
+                if (outer == nullptr || outer->tab_name == tab_name) {
+                    continue;
+                }
+                auto outer_col = get_col(left_->cols(), *outer);
+                if (outer_col->type == col.type && outer_col->len == col.len) {
+                    probe_cols_.push_back({.from_outer = true, .outer_offset = outer_col->offset, .value = nullptr, .len = col.len});
+                    found = true;
+                    break;
+                }
+            }
+            for (auto &cond : inner_conds_) {
+                if (found) {
+                    break;
+                }
+                if (cond.op == OP_EQ && cond.is_rhs_val && cond.lhs_col.col_name == col.name && cond.rhs_val.type == col.type) {
+                    probe_cols_.push_back({.from_outer = false, .outer_offset = 0, .value = cond.rhs_val.raw->data, .len = col.len});
+                    found = true;
+                }
+            }
+            if (!found) {
+                break;
+            }
+            prefix_len_ += col.len;
+        }
+        if (probe_cols_.empty()) {
+            throw InternalError("IndexNestedLoopJoinExecutor: no equality condition on the first index column");
+        }
+    }
+
+    void beginTuple() override {
+        left_->beginBatch();
+        is_end_ = false;
+        outer_.reset(left_len_);
+        matches_.clear();
+        batch_pos_ = match_pos_ = 0;
+        find_next();
+    }
+
+    void nextTuple() override {
+        match_pos_++;
+        find_next();
+    }
+
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        while (!is_end_ && !batch.full()) {
+            memcpy(batch.append(_abstract_rid), join_record_.data, len_);
+            nextTuple();
+        }
+        return batch.num_sel > 0;
+    }
+
+    std::unique_ptr<RmRecord> Next() override {
+        if (is_end_) {
+            return nullptr;
+        }
+        return std::make_unique<RmRecord>(join_record_);
+    }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "Index NestedLoop Join Executor"; }
+
+    bool is_end() const override { return is_end_; }
+
+    ColMeta get_col_offset(const TabCol &target) override { return AbstractExecutor::get_col_offset(target); }
+
+   private:
+    /* 从(batch_pos_, match_pos_)开始找到下一条满足全部条件的连接结果，当前批次用完后读入下一批 */
+    void find_next() {
+        while (true) {
+            while (batch_pos_ < outer_.num_sel) {
+                auto &rids = matches_[batch_pos_];
+                for (; match_pos_ < rids.size(); ++match_pos_) {
+                    auto rec = fh_->get_record(rids[match_pos_], context_);
+                    if (!inner_preds_.eval(rec->data)) {
+                        continue;
+                    }
+                    memcpy(join_record_.data, outer_.selected(batch_pos_), left_len_);
+                    memcpy(join_record_.data + left_len_, rec->data, right_len_);
+                    if (preds_.eval(join_record_.data)) {
+                        context_->lock_mgr_->lock_shared_on_record(context_->txn_, rids[match_pos_], fh_->GetFd());
+                        return;
+                    }
+                }
+                batch_pos_++;
+                match_pos_ = 0;
+            }
+            if (!load_batch()) {
+                is_end_ = true;
+                return;
+            }
+        }
+    }
+
+    /* 读入下一批外表记录，按探测key排序后依次查找索引，外表没有记录时返回false */
+    bool load_batch() {
+        if (!left_->NextBatch(outer_)) {
+            return false;
+        }
+        size_t n = outer_.num_sel;
+        matches_.assign(n, std::vector<Rid>());
+        batch_pos_ = match_pos_ = 0;
+
+        // 编码后的下界，前缀之后的字段填全0，上界在查找时把这部分改成全0xff
+        const IxKeyCodec &codec = ih_->get_key_codec();
+        std::vector<char> raw(key_len_, 0);
+        std::vector<char> keys(n * key_len_);
+        for (size_t i = 0; i < n; ++i) {
+            int offset = 0;
+            for (auto &probe : probe_cols_) {
+                const char *src = probe.from_outer ? outer_.selected(i) + probe.outer_offset : probe.value;
+                memcpy(raw.data() + offset, src, probe.len);
+                offset += probe.len;
+            }
+            char *key = keys.data() + i * key_len_;
+            codec.encode(raw.data(), key);
+            memset(key + prefix_len_, 0, key_len_ - prefix_len_);
+        }
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return memcmp(keys.data() + a * key_len_, keys.data() + b * key_len_, prefix_len_) < 0;
+        });
+
+        std::vector<char> upper(key_len_);
+        for (size_t j = 0; j < n; ++j) {
+            size_t i = order[j];
+            const char *key = keys.data() + i * key_len_;
+            if (j > 0 && memcmp(key, keys.data() + order[j - 1] * key_len_, prefix_len_) == 0) {
+                matches_[i] = matches_[order[j - 1]];
+                continue;
+            }
+            memcpy(upper.data(), key, prefix_len_);
+            memset(upper.data() + prefix_len_, 0xff, key_len_ - prefix_len_);
+            IxScan scan(ih_, key, false, upper.data(), false, bpm_);
+            for (; !scan.is_end(); scan.next()) {
+                matches_[i].push_back(scan.rid());
+            }
+        }
+        return true;
+    }
+};
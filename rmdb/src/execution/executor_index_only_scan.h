@@ -0,0 +1,58 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "executor_index_scan.h"
+
+/* 只访问索引的扫描：查询用到的字段都在索引key中时，直接用叶结点中的key解码出输出的元组，不再读取数据文件
+ * 输出的元组只包含索引字段，按索引字段的顺序紧密排列，与原始格式的key相同 */
+class IndexOnlyScanExecutor : public IndexScanExecutor {
+   private:
+    std::unique_ptr<RmRecord> key_rec_;     // 当前元组，即解码后的key
+
+   public:
+    IndexOnlyScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                          std::vector<std::string> index_col_names, Context *context)
+        : IndexScanExecutor(sm_manager, std::move(tab_name), std::move(conds), std::move(index_col_names), context) {
+        cols_ = index_meta_.cols;
+        int offset = 0;
+        for (auto &col : cols_) {
+            col.offset = offset;
+            offset += col.len;
+        }
+        len_ = offset;
+        compile_conds();
+        key_rec_ = std::make_unique<RmRecord>(len_);
+    }
+
+    std::unique_ptr<RmRecord> Next() override {
+        if (scan_->is_end()) {
+            return nullptr;
+        }
+        return std::make_unique<RmRecord>(*key_rec_);
+    }
+
+    std::string getType() override { return "IndexOnlyScanExecutor"; }
+
+   protected:
+    const char *current_data() const override { return key_rec_->data; }
+
+    void find_next() override {
+        while (!scan_->is_end()) {
+            rid_ = static_cast<IxScan *>(scan_.get())->entry(key_rec_->data);
+            if (preds_.eval(key_rec_->data)) {
+                context_->lock_mgr_->lock_shared_on_record(context_->txn_, rid_, fh_->GetFd());
+                break;
+            }
+            scan_->next();
+        }
+    }
+};
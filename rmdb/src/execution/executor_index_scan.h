@@ -13,68 +13,171 @@ See the Mulan PSL v2 for more details. */
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
+#include "executor_seq_scan.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
-class IndexScanExecutor : public AbstractExecutor {
-   private:
-    std::string tab_name_;                      // 表名称
-    TabMeta tab_;                               // 表的元数据
-    std::vector<Condition> conds_;              // 扫描条件
-    RmFileHandle *fh_;                          // 表的数据文件句柄
-    std::vector<ColMeta> cols_;                 // 需要读取的字段
-    size_t len_;                                // 选取出来的一条记录的长度
-    std::vector<Condition> fed_conds_;          // 扫描条件，和conds_字段相同
-
+/* 索引范围扫描：根据索引前缀字段上与常量比较的条件推导出扫描的上下界，沿叶子链表扫描[lower, upper)，
+ * 用于推导上下界的条件不再重复检查，其余条件在取出记录后检查。谓词求值复用SeqScanExecutor的实现 */
+class IndexScanExecutor : public SeqScanExecutor {
+   protected:
     std::vector<std::string> index_col_names_;  // index scan涉及到的索引包含的字段
     IndexMeta index_meta_;                      // index scan涉及到的索引元数据
+    IxIndexHandle *ih_;
 
-    Rid rid_;
-    std::unique_ptr<RecScan> scan_;
-
-    SmManager *sm_manager_;
+    // 编码后的上下界。lower_strict_为true时从第一个大于lower_key_的位置开始，否则从第一个不小于它的位置开始；
+    // upper_strict_为true时扫描到第一个不小于upper_key_的位置为止，否则到第一个大于它的位置为止
+    std::vector<char> lower_key_;
+    std::vector<char> upper_key_;
+    bool lower_strict_ = false;
+    bool upper_strict_ = false;
+    bool is_empty_range_ = false;               // 条件互相矛盾，扫描结果为空
 
    public:
-    IndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, std::vector<std::string> index_col_names,
-                    Context *context) {
-        sm_manager_ = sm_manager;
-        context_ = context;
-        tab_name_ = std::move(tab_name);
-        tab_ = sm_manager_->db_.get_table(tab_name_);
-        conds_ = std::move(conds);
-        // index_no_ = index_no;
-        index_col_names_ = index_col_names; 
-        index_meta_ = *(tab_.get_index_meta(index_col_names_));
-        fh_ = sm_manager_->fhs_.at(tab_name_).get();
-        cols_ = tab_.cols;
-        len_ = cols_.back().offset + cols_.back().len;
-        std::map<CompOp, CompOp> swap_op = {
-            {OP_EQ, OP_EQ}, {OP_NE, OP_NE}, {OP_LT, OP_GT}, {OP_GT, OP_LT}, {OP_LE, OP_GE}, {OP_GE, OP_LE},
-        };
-
-        for (auto &cond : conds_) {
-            if (cond.lhs_col.tab_name != tab_name_) {
-                // lhs is on other table, now rhs must be on this table
-                assert(!cond.is_rhs_val && cond.rhs_col.tab_name == tab_name_);
-                // swap lhs and rhs
-                std::swap(cond.lhs_col, cond.rhs_col);
-                cond.op = swap_op.at(cond.op);
-            }
-        }
-        fed_conds_ = conds_;
+    IndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                      std::vector<std::string> index_col_names, Context *context)
+        : SeqScanExecutor(sm_manager, std::move(tab_name), std::move(conds), context),
+          index_col_names_(std::move(index_col_names)) {
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name_);
+        index_meta_ = *(tab.get_index_meta(index_col_names_));
+        ih_ = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_col_names_)).get();
+        build_range();
     }
 
     void beginTuple() override {
-        
+        // 条件互相矛盾时下界大于上界，IxScan不访问索引，结果为空
+        scan_ = std::make_unique<IxScan>(ih_, lower_key_.data(), lower_strict_, upper_key_.data(), upper_strict_,
+                                         sm_manager_->get_bpm());
+        find_next();
     }
 
     void nextTuple() override {
-        
+        scan_->next();
+        find_next();
+    }
+
+    void beginBatch() override { beginTuple(); }
+
+    /* 与逐条读取共用find_next，当前位置的记录已经在find_next中取出并检查过，直接拷贝进batch */
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        while (!scan_->is_end() && !batch.full()) {
+            memcpy(batch.append(rid_), current_data(), len_);
+            scan_->next();
+            find_next();
+        }
+        return batch.num_sel > 0;
+    }
+
+    std::string getType() override { return "IndexScanExecutor"; }
+
+   protected:
+    std::unique_ptr<RmRecord> cur_rec_;         // find_next找到的记录
+
+    /* 当前位置的记录数据 */
+    virtual const char *current_data() const { return cur_rec_->data; }
+
+    /* 从scan_的当前位置开始，找到第一条满足剩余条件的记录 */
+    virtual void find_next() {
+        while (!scan_->is_end()) {
+            rid_ = scan_->rid();
+            cur_rec_ = fh_->get_record(rid_, context_);
+            if (preds_.eval(cur_rec_->data)) {
+                context_->lock_mgr_->lock_shared_on_record(context_->txn_, rid_, fh_->GetFd());
+                break;
+            }
+            scan_->next();
+        }
     }
 
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+   private:
+    /* 条件能否用于推导索引字段col的上下界：与同类型常量比较，且不是!= */
+    bool is_sargable(const Condition &cond, const ColMeta &col) const {
+        return cond.is_rhs_val && cond.op != OP_NE && cond.lhs_col.tab_name == tab_name_ &&
+               cond.lhs_col.col_name == col.name && is_same_type(col.type, cond.rhs_val.type);
     }
 
-    Rid &rid() override { return rid_; }
+    /**
+     * @description: 推导扫描的上下界
+     * 依次处理索引的每个字段：字段上有等值条件时把常量放进上下界并继续处理下一个字段；
+     * 否则取该字段上最紧的下界和上界后停止。之后的字段不受限制，编码后按memcmp比较，
+     * 因此下界中填全0表示最小值，上界中填全0xff表示最大值；严格不等时反过来填，再配合upper_bound/lower_bound跳过相等的前缀
+     */
+    void build_range() {
+        // 非唯一索引的key末尾还有rid字段，不受条件限制
+        const IxKeyCodec &codec = ih_->get_key_codec();
+        int key_len = codec.key_len();
+        std::vector<char> lower_raw(key_len, 0), upper_raw(key_len, 0);
+        std::vector<bool> used(fed_conds_.size(), false);
+        int prefix_len = 0;         // 等值条件确定的前缀长度
+        int lower_len = 0, upper_len = 0;
+        for (auto &col : index_meta_.cols) {
+            int eq = -1, lo = -1, hi = -1;
+            for (size_t i = 0; i < fed_conds_.size(); ++i) {
+                auto &cond = fed_conds_[i];
+                if (!is_sargable(cond, col)) {
+                    continue;
+                }
+                const char *val = cond.rhs_val.raw->data;
+                if (cond.op == OP_EQ) {
+                    if (eq < 0) {
+                        eq = i;
+                    }
+                } else if (cond.op == OP_GT || cond.op == OP_GE) {
+                    int cmp = lo < 0 ? 1 : ix_compare(val, fed_conds_[lo].rhs_val.raw->data, col.type, col.len);
+                    if (cmp > 0 || (cmp == 0 && cond.op == OP_GT)) {
+                        lo = i;
+                    }
+                } else {
+                    int cmp = hi < 0 ? -1 : ix_compare(val, fed_conds_[hi].rhs_val.raw->data, col.type, col.len);
+                    if (cmp < 0 || (cmp == 0 && cond.op == OP_LT)) {
+                        hi = i;
+                    }
+                }
+            }
+            if (eq >= 0) {
+                memcpy(lower_raw.data() + prefix_len, fed_conds_[eq].rhs_val.raw->data, col.len);
+                memcpy(upper_raw.data() + prefix_len, fed_conds_[eq].rhs_val.raw->data, col.len);
+                used[eq] = true;
+                prefix_len += col.len;
+                continue;
+            }
+            lower_len = upper_len = prefix_len;
+            if (lo >= 0) {
+                memcpy(lower_raw.data() + prefix_len, fed_conds_[lo].rhs_val.raw->data, col.len);
+                lower_strict_ = fed_conds_[lo].op == OP_GT;
+                lower_len += col.len;
+                used[lo] = true;
+            }
+            if (hi >= 0) {
+                memcpy(upper_raw.data() + prefix_len, fed_conds_[hi].rhs_val.raw->data, col.len);
+                upper_strict_ = fed_conds_[hi].op == OP_LT;
+                upper_len += col.len;
+                used[hi] = true;
+            }
+            break;
+        }
+        if (prefix_len == index_meta_.col_tot_len) {
+            lower_len = upper_len = prefix_len;
+        }
+
+        lower_key_.resize(key_len);
+        upper_key_.resize(key_len);
+        codec.encode(lower_raw.data(), lower_key_.data());
+        codec.encode(upper_raw.data(), upper_key_.data());
+        memset(lower_key_.data() + lower_len, lower_strict_ ? 0xff : 0, key_len - lower_len);
+        memset(upper_key_.data() + upper_len, upper_strict_ ? 0 : 0xff, key_len - upper_len);
+        int cmp = memcmp(lower_key_.data(), upper_key_.data(), key_len);
+        is_empty_range_ = cmp > 0 || (cmp == 0 && (lower_strict_ || upper_strict_));
+
+        // 已经由上下界保证的条件不再检查
+        std::vector<Condition> residual;
+        for (size_t i = 0; i < fed_conds_.size(); ++i) {
+            if (!used[i]) {
+                residual.push_back(fed_conds_[i]);
+            }
+        }
+        fed_conds_ = std::move(residual);
+        compile_conds();
+    }
 };
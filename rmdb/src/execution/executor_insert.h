@@ -43,7 +43,7 @@ class InsertExecutor : public AbstractExecutor {
         for (size_t i = 0; i < values_.size(); i++) {
             auto &col = tab_.cols[i];
             auto &val = values_[i];
-            if (col.type != val.type) {
+            if (!is_same_type(col.type, val.type)) {
                 throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
             }
             val.init_raw(col.len);
@@ -52,17 +52,12 @@ class InsertExecutor : public AbstractExecutor {
         // Insert into record file
         rid_ = fh_->insert_record(rec.data, context_);
         
-        // Insert into index
-        for(size_t i = 0; i < tab_.indexes.size(); ++i) {
-            auto& index = tab_.indexes[i];
-            auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char* key = new char[index.col_tot_len];
-            int offset = 0;
-            for(size_t i = 0; i < static_cast<size_t>(index.col_num); ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
-            }
-            ih->insert_entry(key, rid_, context_->txn_);
+        // Insert into index，传入原始格式的key，由索引在插入时编码；违反唯一约束时撤销对记录文件的插入
+        try {
+            sm_manager_->insert_index_entries(tab_, rec.data, rid_, context_->txn_);
+        } catch (UniqueConstraintError &) {
+            fh_->delete_record(rid_, context_);
+            throw;
         }
         return nullptr;
     }
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
+#include "predicate.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
@@ -23,6 +24,7 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                 // join后获得的记录的字段
 
     std::vector<Condition> fed_conds_;          // join条件
+    PredicateList preds_;                       // 编译后的join条件
     bool isend;
 
     std::unique_ptr<RmRecord> cur_left_record_;
@@ -44,6 +46,7 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
         isend = false;
         fed_conds_ = std::move(conds);
+        preds_.compile(cols_, fed_conds_);
     }
 
     void beginTuple() override {
@@ -64,7 +67,7 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         memcpy(rec->data + cur_left_record_->size, cur_right_record_->data, cur_right_record_->size);
 
         // 评估连接后的记录是否满足条件
-        if (eval_conds(cols_, fed_conds_, rec.get())) {
+        if (preds_.eval(rec->data)) {
             current_record_ = std::move(rec);
         } else {
             nextTuple();
@@ -90,7 +93,7 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         memcpy(rec->data + cur_left_record_->size, cur_right_record_->data, cur_right_record_->size);
         //current_record_ = std::move(rec);
         // 评估连接后的记录是否满足条件
-        if (eval_conds(cols_, fed_conds_, rec.get())) {
+        if (preds_.eval(rec->data)) {
             current_record_ = std::move(rec);
         }else {
             nextTuple();
@@ -116,44 +119,4 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
 
     private:
     std::unique_ptr<RmRecord> current_record_;  // 当前符合条件的记录
-
-    bool eval_cond(const std::vector<ColMeta> &rec_cols, const Condition &cond, const RmRecord *rec) {
-        auto lhs_col = get_col(rec_cols, cond.lhs_col);
-        char *lhs = rec->data + lhs_col->offset;
-        char *rhs;
-        ColType rhs_type;
-        if (cond.is_rhs_val) {
-            // value
-            rhs_type = cond.rhs_val.type;
-            rhs = cond.rhs_val.raw->data;
-        } else {
-            // column
-            auto rhs_col = get_col(rec_cols, cond.rhs_col);
-            rhs_type = rhs_col->type;
-            rhs = rec->data + rhs_col->offset;
-        }
-        
-        assert(rhs_type == lhs_col->type);
-        int cmp = ix_compare(lhs, rhs, rhs_type, lhs_col->len);
-        if (cond.op == OP_EQ) {
-            return cmp == 0;
-        } else if (cond.op == OP_NE) {
-            return cmp != 0;
-        } else if (cond.op == OP_LT) {
-            return cmp < 0;
-        } else if (cond.op == OP_GT) {
-            return cmp > 0;
-        } else if (cond.op == OP_LE) {
-            return cmp <= 0;
-        } else if (cond.op == OP_GE) {
-            return cmp >= 0;
-        } else {
-            throw InternalError("Unexpected op type");
-        }
-    }
-
-    bool eval_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds, const RmRecord *rec) {
-        return std::all_of(conds.begin(), conds.end(),
-                           [&](const Condition &cond) { return eval_cond(rec_cols, cond, rec); });
-    }
 };
\ No newline at end of file
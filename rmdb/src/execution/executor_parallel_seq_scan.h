@@ -0,0 +1,192 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include "exchange_queue.h"
+#include "executor_seq_scan.h"
+
+/* 并行顺序扫描：多个工作线程从共享的原子游标上每次领取一段连续页面（morsel），
+ * 各自扫描、过滤后把满足条件的记录按批放进有界的交换队列，上层算子从队列中逐条取出，输出顺序不确定
+ * 扫描开始时对整张表加共享锁，工作线程读取记录时不再逐条加锁 */
+class ParallelSeqScanExecutor : public SeqScanExecutor {
+   private:
+    static constexpr int MORSEL_PAGES = 64;         // 每次领取的页面个数
+    static constexpr size_t BATCH_SIZE = 256;       // 每批记录条数
+    static constexpr size_t QUEUE_CAPACITY = 16;    // 交换队列中最多缓存的批数
+    static constexpr int MIN_PARALLEL_PAGES = 256;  // 表的页面数少于该值时不值得并行
+
+    struct ScanBatch {
+        std::vector<Rid> rids;
+        std::vector<char> data;     // 连续存放的记录，每条长度为len_
+    };
+
+    size_t num_workers_;
+    std::atomic<int> next_page_;    // morsel游标，指向下一个还没有被领取的页面
+    ExchangeQueue<ScanBatch> queue_;
+    std::vector<std::thread> workers_;
+    std::mutex error_latch_;
+    std::exception_ptr error_;      // 工作线程抛出的第一个异常，由上层线程重新抛出
+
+    ScanBatch batch_;               // 当前正在输出的一批记录
+    size_t batch_idx_ = 0;
+    bool is_end_ = true;
+
+   public:
+    ParallelSeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                            Context *context, size_t num_workers)
+        : SeqScanExecutor(sm_manager, std::move(tab_name), std::move(conds), context),
+          num_workers_(num_workers),
+          queue_(QUEUE_CAPACITY) {}
+
+    ~ParallelSeqScanExecutor() override { stop_workers(); }
+
+    /**
+     * @description: 决定扫描一张表时使用的工作线程个数，返回0表示应当使用单线程的SeqScanExecutor
+     */
+    static size_t choose_num_workers(RmFileHandle *fh) {
+        size_t num_cores = std::thread::hardware_concurrency();
+        if (num_cores <= 1 || fh->get_file_hdr().num_pages < MIN_PARALLEL_PAGES) {
+            return 0;
+        }
+        return num_cores;
+    }
+
+    void beginTuple() override {
+        stop_workers();
+        if (context_ != nullptr && context_->txn_ != nullptr) {
+            context_->lock_mgr_->lock_shared_on_table(context_->txn_, fh_->GetFd());
+        }
+        auto filters = build_scan_filters();
+        auto ranges = build_zone_ranges();
+        next_page_ = RM_FIRST_RECORD_PAGE;
+        error_ = nullptr;
+        queue_.reset(num_workers_);
+        for (size_t i = 0; i < num_workers_; ++i) {
+            workers_.emplace_back([this, filters, ranges]() { worker(filters, ranges); });
+        }
+        is_end_ = false;
+        fetch_batch();
+    }
+
+    void nextTuple() override {
+        if (is_end_) {
+            return;
+        }
+        if (++batch_idx_ < batch_.rids.size()) {
+            rid_ = batch_.rids[batch_idx_];
+        } else {
+            fetch_batch();
+        }
+    }
+
+    std::unique_ptr<RmRecord> Next() override {
+        if (is_end_) {
+            return nullptr;
+        }
+        return std::make_unique<RmRecord>(len_, batch_.data.data() + batch_idx_ * len_);
+    }
+
+    void beginBatch() override { beginTuple(); }
+
+    /* 工作线程已经过滤好的记录直接从交换队列的批中拷贝过来 */
+    bool NextBatch(TupleBatch &batch) override {
+        batch.reset(len_);
+        while (!is_end_ && !batch.full()) {
+            size_t n = std::min(batch_.rids.size() - batch_idx_, TUPLE_BATCH_SIZE - batch.num_rows);
+            memcpy(batch.row(batch.num_rows), batch_.data.data() + batch_idx_ * len_, n * len_);
+            std::copy_n(batch_.rids.begin() + batch_idx_, n, batch.rids.begin() + batch.num_rows);
+            batch.num_rows += n;
+            batch_idx_ += n;
+            if (batch_idx_ == batch_.rids.size()) {
+                fetch_batch();
+            }
+        }
+        batch.select_all();
+        return batch.num_sel > 0;
+    }
+
+    bool is_end() const override { return is_end_; }
+
+    std::string getType() override { return "ParallelSeqScanExecutor"; }
+
+   private:
+    /**
+     * @description: 从交换队列中取出下一批非空的记录，所有工作线程都结束后置is_end_
+     */
+    void fetch_batch() {
+        batch_idx_ = 0;
+        while (queue_.pop(&batch_)) {
+            if (!batch_.rids.empty()) {
+                rid_ = batch_.rids[0];
+                return;
+            }
+        }
+        is_end_ = true;
+        stop_workers();
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    void worker(const std::vector<RmScanFilter> &filters, const std::vector<RmZoneRange> &ranges) {
+        try {
+            int num_pages = fh_->get_file_hdr().num_pages;
+            ScanBatch batch;
+            while (true) {
+                int start_page = next_page_.fetch_add(MORSEL_PAGES);
+                if (start_page >= num_pages) {
+                    break;
+                }
+                for (RmScan scan(fh_, filters, ranges, start_page, start_page + MORSEL_PAGES); !scan.is_end();
+                     scan.next()) {
+                    auto rec = fh_->get_record(scan.rid(), nullptr);
+                    if (!preds_.eval(rec->data)) {
+                        continue;
+                    }
+                    batch.rids.push_back(scan.rid());
+                    batch.data.insert(batch.data.end(), rec->data, rec->data + len_);
+                    if (batch.rids.size() == BATCH_SIZE) {
+                        if (!queue_.push(std::move(batch))) {
+                            // 上层已经不需要数据了
+                            queue_.producer_done();
+                            return;
+                        }
+                        batch = ScanBatch();
+                    }
+                }
+            }
+            if (!batch.rids.empty()) {
+                queue_.push(std::move(batch));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_latch_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        queue_.producer_done();
+    }
+
+    void stop_workers() {
+        if (workers_.empty()) {
+            return;
+        }
+        queue_.close();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+    }
+};
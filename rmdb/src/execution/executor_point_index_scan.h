@@ -0,0 +1,107 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "executor_seq_scan.h"
+
+/* 哈希索引或ART索引上的等值查找：索引的每个字段上都有与同类型常量的等值条件，拼出key后在索引中查找一次，
+ * 用于拼key的条件不再检查，其余条件在取出记录后检查。谓词求值复用SeqScanExecutor的实现 */
+class PointIndexScanExecutor : public SeqScanExecutor {
+   private:
+    IndexMeta index_meta_;          // 使用的索引的元数据
+    IxHashIndexHandle *hash_ih_ = nullptr;
+    IxArtIndex *art_ih_ = nullptr;
+    std::vector<char> key_;         // 原始格式的key
+    std::vector<Rid> rids_;         // 查找结果
+    size_t pos_ = 0;                // 当前记录在rids_中的下标
+
+   public:
+    PointIndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                           std::vector<std::string> index_col_names, Context *context)
+        : SeqScanExecutor(sm_manager, std::move(tab_name), std::move(conds), context) {
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name_);
+        index_meta_ = *(tab.get_index_meta(index_col_names));
+        std::string index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_col_names);
+        if (index_meta_.type == INDEX_ART) {
+            art_ih_ = sm_manager_->art_ihs_.at(index_name).get();
+        } else {
+            hash_ih_ = sm_manager_->hash_ihs_.at(index_name).get();
+        }
+
+        key_.resize(index_meta_.col_tot_len);
+        std::vector<bool> used(fed_conds_.size(), false);
+        int offset = 0;
+        for (auto &col : index_meta_.cols) {
+            for (size_t i = 0; i < fed_conds_.size(); ++i) {
+                auto &cond = fed_conds_[i];
+                if (cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name == tab_name_ &&
+                    cond.lhs_col.col_name == col.name && is_same_type(col.type, cond.rhs_val.type)) {
+                    memcpy(key_.data() + offset, cond.rhs_val.raw->data, col.len);
+                    used[i] = true;
+                    break;
+                }
+            }
+            offset += col.len;
+        }
+        std::vector<Condition> residual;
+        for (size_t i = 0; i < fed_conds_.size(); ++i) {
+            if (!used[i]) {
+                residual.push_back(fed_conds_[i]);
+            }
+        }
+        fed_conds_ = std::move(residual);
+        compile_conds();
+    }
+
+    void beginTuple() override {
+        rids_.clear();
+        if (art_ih_ != nullptr) {
+            art_ih_->get_value(key_.data(), &rids_);
+        } else {
+            hash_ih_->get_value(key_.data(), &rids_, context_->txn_);
+        }
+        pos_ = 0;
+        find_next();
+    }
+
+    void nextTuple() override {
+        ++pos_;
+        find_next();
+    }
+
+    std::unique_ptr<RmRecord> Next() override {
+        if (is_end()) {
+            return nullptr;
+        }
+        return fh_->get_record(rid_, context_);
+    }
+
+    // 点查只返回很少的记录，按批读取时沿用逐条读取的实现
+    void beginBatch() override { beginTuple(); }
+
+    bool NextBatch(TupleBatch &batch) override { return AbstractExecutor::NextBatch(batch); }
+
+    bool is_end() const override { return pos_ >= rids_.size(); }
+
+    std::string getType() override { return "PointIndexScanExecutor"; }
+
+   private:
+    void find_next() {
+        for (; pos_ < rids_.size(); ++pos_) {
+            rid_ = rids_[pos_];
+            auto rec = fh_->get_record(rid_, context_);
+            if (preds_.eval(rec->data)) {
+                context_->lock_mgr_->lock_shared_on_record(context_->txn_, rid_, fh_->GetFd());
+                break;
+            }
+        }
+    }
+};
@@ -21,6 +21,7 @@ private:
     std::vector<ColMeta> cols_;                     // 需要投影的字段
     size_t len_;                                    // 字段总长度
     std::vector<size_t> sel_idxs_;
+    TupleBatch prev_batch_;                         // 按批读取时儿子节点输出的一批记录
 
 public:
     ProjectionExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol>& sel_cols) {
@@ -60,6 +61,27 @@ public:
     }
 
 
+    void beginBatch() override { prev_->beginBatch(); }
+
+    /* 只投影儿子节点那一批中的有效记录，输出的记录全部有效 */
+    bool NextBatch(TupleBatch& batch) override {
+        batch.reset(len_);
+        if (!prev_->NextBatch(prev_batch_)) {
+            return false;
+        }
+        auto& prev_cols = prev_->cols();
+        for (size_t k = 0; k < prev_batch_.num_sel; ++k) {
+            size_t i = prev_batch_.sel[k];
+            const char* prev_data = prev_batch_.row(i);
+            char* proj_data = batch.append(prev_batch_.rids[i]);
+            for (size_t j = 0; j < sel_idxs_.size(); ++j) {
+                const auto& prev_col = prev_cols[sel_idxs_[j]];
+                std::copy_n(prev_data + prev_col.offset, prev_col.len, proj_data + cols_[j].offset);
+            }
+        }
+        return true;
+    }
+
     Rid& rid() override { return _abstract_rid; }
 
     bool is_end() const override { return prev_->is_end(); }
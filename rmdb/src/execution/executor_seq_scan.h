@@ -13,17 +13,19 @@ See the Mulan PSL v2 for more details. */
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
+#include "predicate.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
 class SeqScanExecutor : public AbstractExecutor {
-   private:
+   protected:
     std::string tab_name_;              // 表的名称
     std::vector<Condition> conds_;      // scan的条件
     RmFileHandle *fh_;                  // 表的数据文件句柄
     std::vector<ColMeta> cols_;         // scan后生成的记录的字段
     size_t len_;                        // scan后生成的每条记录的长度
     std::vector<Condition> fed_conds_;  // 同conds_，两个字段相同
+    PredicateList preds_;               // 编译后的fed_conds_，fed_conds_或cols_改变后要重新编译
 
     Rid rid_;
     std::unique_ptr<RecScan> scan_;     // table_iterator
@@ -57,7 +59,7 @@ class SeqScanExecutor : public AbstractExecutor {
         }
 
         fed_conds_ = conds_;
-
+        compile_conds();
     }
 
 
@@ -65,13 +67,13 @@ class SeqScanExecutor : public AbstractExecutor {
      * @brief 构建表迭代器scan_,并开始迭代扫描,直到扫描到第一个满足谓词条件的元组停止,并赋值给rid_
      */
     void beginTuple() override {
-        scan_ = std::make_unique<RmScan>(fh_);
+        scan_ = std::make_unique<RmScan>(fh_, build_scan_filters(), build_zone_ranges());
         // Debugging statement to ensure this method is working correctly
 
         while (!(scan_->is_end())) {
             rid_ = scan_->rid();
             auto rec = fh_->get_record(rid_, context_);
-            if (eval_conds(cols_, fed_conds_, rec.get())) {
+            if (preds_.eval(rec->data)) {
                 context_->lock_mgr_->lock_shared_on_record(context_->txn_, rid_, fh_->GetFd());
                 break;
             }
@@ -85,7 +87,7 @@ class SeqScanExecutor : public AbstractExecutor {
         while(!(scan_->is_end())) {
             rid_ = scan_->rid();
             auto rec = fh_->get_record(rid_, context_);
-            if (eval_conds(cols_, fed_conds_, rec.get())) {
+            if (preds_.eval(rec->data)) {
                 context_->lock_mgr_->lock_shared_on_record(context_->txn_, rid_, fh_->GetFd());
                 break;
             }
@@ -93,6 +95,19 @@ class SeqScanExecutor : public AbstractExecutor {
         }
     }
 
+    void beginBatch() override { scan_ = std::make_unique<RmScan>(fh_, build_scan_filters(), build_zone_ranges()); }
+
+    /* 每次从RmScan中整页地取出一批记录，再检查条件，把满足条件的记录放进选择向量 */
+    bool NextBatch(TupleBatch &batch) override {
+        auto scan = static_cast<RmScan *>(scan_.get());
+        batch.reset(len_);
+        while (batch.num_sel == 0 && !scan->is_end()) {
+            batch.num_rows = scan->next_batch(batch.data.data(), batch.rids.data(), TUPLE_BATCH_SIZE);
+            filter_batch(batch);
+        }
+        return batch.num_sel > 0;
+    }
+
     std::unique_ptr<RmRecord> Next() override {
         if (scan_->is_end()) {
             return nullptr;
@@ -111,10 +126,69 @@ class SeqScanExecutor : public AbstractExecutor {
                 cond.rhs_val = feed_dict.at(cond.rhs_col);
             }
         }
+        compile_conds();
     }
 
     Rid &rid() override { return rid_; }
 
+    /* 检查batch缓冲区中的每条记录，选择向量中只保留满足全部条件的记录 */
+    void filter_batch(TupleBatch &batch) {
+        batch.num_sel = 0;
+        for (size_t i = 0; i < batch.num_rows; ++i) {
+            if (preds_.eval(batch.row(i))) {
+                context_->lock_mgr_->lock_shared_on_record(context_->txn_, batch.rids[i], fh_->GetFd());
+                batch.sel[batch.num_sel++] = i;
+            }
+        }
+    }
+
+    /**
+     * @description: 把数值字段与常量的范围条件转换成RmZoneRange，RmScan据此利用zone map跳过整个页面
+     * 严格不等号也按闭区间处理，只会少跳过页面，不会漏掉记录
+     */
+    std::vector<RmZoneRange> build_zone_ranges() {
+        std::vector<RmZoneRange> ranges;
+        for (auto &cond : fed_conds_) {
+            if (!cond.is_rhs_val || cond.op == OP_NE) {
+                continue;
+            }
+            auto lhs_col = get_col(cols_, cond.lhs_col);
+            const Value &val = cond.rhs_val;
+            if (!RmZoneMap::is_zone_type(lhs_col->type) || !RmZoneMap::is_zone_type(val.type) ||
+                ((lhs_col->type == TYPE_DATETIME) != (val.type == TYPE_DATETIME))) {
+                continue;
+            }
+            double v = RmZoneMap::get_value(val.raw->data, val.type);
+            RmZoneRange range = {.offset = lhs_col->offset,
+                                 .lo = -std::numeric_limits<double>::infinity(),
+                                 .hi = std::numeric_limits<double>::infinity()};
+            if (cond.op == OP_EQ || cond.op == OP_GT || cond.op == OP_GE) {
+                range.lo = v;
+            }
+            if (cond.op == OP_EQ || cond.op == OP_LT || cond.op == OP_LE) {
+                range.hi = v;
+            }
+            ranges.push_back(range);
+        }
+        return ranges;
+    }
+
+    /**
+     * @description: 把字段与常量比较的条件下推到RmScan，直接在页面上过滤，不满足的记录不需要拷贝出来
+     * 下推只是预过滤，取出记录后仍然会检查全部条件
+     */
+    std::vector<RmScanFilter> build_scan_filters() {
+        std::vector<RmScanFilter> filters;
+        for (auto &pred : preds_.preds()) {
+            if (!pred.rhs_is_val()) {
+                continue;
+            }
+            filters.push_back({.offset = pred.lhs_offset(), .len = pred.len(),
+                               .pred = [field_pred = pred.on_field()](const char *lhs) { return field_pred.eval(lhs); }});
+        }
+        return filters;
+    }
+
     ColMeta get_col_offset(const TabCol &target) { 
         for (auto col : cols_) {
             if (target.col_name == col.name) {
@@ -136,66 +210,8 @@ class SeqScanExecutor : public AbstractExecutor {
 
     size_t get_len() { return len_; }
     
-    bool eval_cond(const std::vector<ColMeta> &rec_cols, const Condition &cond, const RmRecord *rec) {
-        auto lhs_col = get_col(rec_cols, cond.lhs_col);
-        char *lhs = rec->data + lhs_col->offset;
-        char *rhs;
-        ColType rhs_type;
-        if (cond.is_rhs_val) {
-            // value
-            rhs_type = cond.rhs_val.type;
-            rhs = cond.rhs_val.raw->data;
-        } else {
-            // column
-            auto rhs_col = get_col(rec_cols, cond.rhs_col);
-            rhs_type = rhs_col->type;
-            rhs = rec->data + rhs_col->offset;
-        }
-        
-        // Check if type conversion is needed
-        if (lhs_col->type != rhs_type) {
-            float lhs_value_as_float, rhs_value_as_float;
-
-            if (lhs_col->type == ColType::TYPE_INT && rhs_type == ColType::TYPE_FLOAT) {
-                lhs_value_as_float = static_cast<float>(*reinterpret_cast<int*>(lhs));
-                rhs_value_as_float = *reinterpret_cast<float*>(rhs);
-            } else if (lhs_col->type == ColType::TYPE_FLOAT && rhs_type == ColType::TYPE_INT) {
-                lhs_value_as_float = *reinterpret_cast<float*>(lhs);
-                rhs_value_as_float = static_cast<float>(*reinterpret_cast<int*>(rhs));
-            } else {
-                // do nothing
-            }
-
-            int cmp = ix_compare(reinterpret_cast<char*>(&lhs_value_as_float), reinterpret_cast<char*>(&rhs_value_as_float), ColType::TYPE_FLOAT, sizeof(float));
-            return eval_cmp_result(cond, cmp);
-        } else {
-            int cmp = ix_compare(lhs, rhs, rhs_type, lhs_col->len);
-            return eval_cmp_result(cond, cmp);
-        }
-    }
-
-    bool eval_cmp_result(const Condition &cond, int cmp) {
-        if (cond.op == OP_EQ) {
-            return cmp == 0;
-        } else if (cond.op == OP_NE) {
-            return cmp != 0;
-        } else if (cond.op == OP_LT) {
-            return cmp < 0;
-        } else if (cond.op == OP_GT) {
-            return cmp > 0;
-        } else if (cond.op == OP_LE) {
-            return cmp <= 0;
-        } else if (cond.op == OP_GE) {
-            return cmp >= 0;
-        } else {
-            throw InternalError("Unexpected op type");
-        }
-    }
-
-    bool eval_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds, const RmRecord *rec) {
-        return std::all_of(conds.begin(), conds.end(),
-                           [&](const Condition &cond) { return eval_cond(rec_cols, cond, rec); });    
-    }
+    /* 按当前的fed_conds_和cols_重新编译谓词 */
+    void compile_conds() { preds_.compile(cols_, fed_conds_); }
 
     bool is_single(const std::vector<Condition> &conds){
         return std::all_of(conds.begin(),conds.end(),[&](const Condition cond){
@@ -9,6 +9,8 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include <algorithm>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -17,12 +19,21 @@ See the Mulan PSL v2 for more details. */
 
 class UpdateExecutor : public AbstractExecutor {
    private:
+    /* 一条已经修改的记录，撤销时用到 */
+    struct UpdatedRow {
+        Rid rid;
+        RmRecord old_rec;
+        RmRecord new_rec;
+        std::vector<const IndexMeta*> changed_indexes;  // key的字节发生变化的索引
+    };
+
     TabMeta tab_;
     std::vector<Condition> conds_;
     RmFileHandle* fh_;
     std::vector<Rid> rids_;
     std::string tab_name_;
     std::vector<SetClause> set_clauses_;
+    std::vector<const IndexMeta*> affected_indexes_;  // key中包含被set子句修改的字段的索引，其余索引不需要维护
     SmManager* sm_manager_;
 
    public:
@@ -40,6 +51,16 @@ class UpdateExecutor : public AbstractExecutor {
         conds_ = conds;
         rids_ = rids;
         context_ = context;
+
+        for (auto& index : tab_.indexes) {
+            bool affected = std::any_of(index.cols.begin(), index.cols.end(), [&](const ColMeta& col) {
+                return std::any_of(set_clauses_.begin(), set_clauses_.end(),
+                                   [&](const SetClause& set_clause) { return set_clause.lhs.col_name == col.name; });
+            });
+            if (affected) {
+                affected_indexes_.push_back(&index);
+            }
+        }
     }
     std::unique_ptr<RmRecord> Next() override {
         // 锁定表以进行独占访问
@@ -53,7 +74,7 @@ class UpdateExecutor : public AbstractExecutor {
                 set_clause.rhs.type == TYPE_INT) {
                 set_clause.rhs.type = TYPE_FLOAT;
                 set_clause.rhs.float_val = set_clause.rhs.int_val;
-            } else if (lhs_col->type != set_clause.rhs.type) {
+            } else if (!is_same_type(lhs_col->type, set_clause.rhs.type)) {
                 throw IncompatibleTypeError(coltype2str(lhs_col->type),
                                             coltype2str(set_clause.rhs.type));
             }
@@ -63,28 +84,63 @@ class UpdateExecutor : public AbstractExecutor {
             }
         }
 
+        // 违反唯一约束时撤销之前已经修改的记录，整条语句不生效
+        std::vector<UpdatedRow> updated_rows;
+        updated_rows.reserve(rids_.size());
         for (const auto& rid : rids_) {
-            // 获取记录
+            // 获取记录，记录更新前的记录
             auto rec = fh_->get_record(rid, context_);
-
-            // 记录更新前的记录
-            RmRecord original_record = *rec;
+            UpdatedRow row{rid, *rec, *rec, {}};
 
             // 构造新数据
             for (size_t i = 0; i < set_clauses_.size(); i++) {
                 auto col = tab_.get_col(set_clauses_[i].lhs.col_name);
-                memcpy(rec->data + col->offset, set_clauses_[i].rhs.raw->data,
+                memcpy(row.new_rec.data + col->offset, set_clauses_[i].rhs.raw->data,
                        col->len);
             }
-            RmRecord updated_record = *rec;
 
-            // 更新记录文件中的记录
-            fh_->update_record(rid, updated_record.data, context_);
+            // 先更新记录文件中的记录，再维护索引，在线REINDEX开始记录旁路日志时，之前对索引的修改都已经写入表中
+            fh_->update_record(rid, row.new_rec.data, context_);
 
+            // 更新索引：只维护key的字节发生变化的索引，删除旧key，插入新key；
+            // 违反唯一约束时恢复这条记录和它的旧key
+            for (auto index : affected_indexes_) {
+                for (auto& col : index->cols) {
+                    if (memcmp(row.old_rec.data + col.offset, row.new_rec.data + col.offset, col.len) != 0) {
+                        row.changed_indexes.push_back(index);
+                        break;
+                    }
+                }
+            }
+            if (!row.changed_indexes.empty()) {
+                sm_manager_->delete_index_entries(row.changed_indexes, row.old_rec.data, rid, context_->txn_);
+                try {
+                    sm_manager_->insert_index_entries(row.changed_indexes, row.new_rec.data, rid, context_->txn_);
+                } catch (UniqueConstraintError &) {
+                    fh_->update_record(rid, row.old_rec.data, context_);
+                    sm_manager_->insert_index_entries(row.changed_indexes, row.old_rec.data, rid, context_->txn_);
+                    undo_updates(updated_rows);
+                    throw;
+                }
+            }
+            updated_rows.push_back(std::move(row));
         }
 
         return nullptr;
     }
 
     Rid& rid() override { return _abstract_rid; }
+
+   private:
+    /* 按相反的顺序撤销已经修改的记录：恢复记录文件中的记录，删除新key，插回旧key。
+     * 语句开始时旧key满足唯一约束，倒序撤销时每一步都回到之前的某个状态，插回旧key不会冲突 */
+    void undo_updates(const std::vector<UpdatedRow>& rows) {
+        for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
+            fh_->update_record(it->rid, it->old_rec.data, context_);
+            if (!it->changed_indexes.empty()) {
+                sm_manager_->delete_index_entries(it->changed_indexes, it->new_rec.data, it->rid, context_->txn_);
+                sm_manager_->insert_index_entries(it->changed_indexes, it->old_rec.data, it->rid, context_->txn_);
+            }
+        }
+    }
 };
\ No newline at end of file
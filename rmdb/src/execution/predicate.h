@@ -0,0 +1,205 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "common/common.h"
+#include "errors.h"
+#include "system/sm_meta.h"
+
+/* 编译后的单个条件：在算子构造时把Condition中的字段解析成记录内的偏移，并按(字段类型, 比较符, 右侧是否为常量)
+ * 选出一个模板实例化的求值函数，求值时不再按名字查找字段，也不再按类型和比较符分支。
+ * 比较的语义与ix_compare相同：INT与FLOAT比较时都转换成FLOAT，字符串按定长memcmp比较 */
+class CompiledPredicate {
+   public:
+    using EvalFunc = bool (*)(const CompiledPredicate &pred, const char *data);
+
+    /**
+     * @description: 编译条件cond，rec_cols为记录的字段，左右两侧的字段都要在其中
+     */
+    static CompiledPredicate compile(const std::vector<ColMeta> &rec_cols, const Condition &cond) {
+        CompiledPredicate pred;
+        const ColMeta &lhs_col = find_col(rec_cols, cond.lhs_col);
+        pred.lhs_offset_ = lhs_col.offset;
+        pred.len_ = lhs_col.len;
+        pred.rhs_is_val_ = cond.is_rhs_val;
+        ColType rhs_type;
+        if (cond.is_rhs_val) {
+            rhs_type = cond.rhs_val.type;
+            if (is_string_type(rhs_type)) {
+                pred.str_val_.assign(cond.rhs_val.raw->data, cond.rhs_val.raw->data + lhs_col.len);
+            } else {
+                memcpy(pred.num_val_, cond.rhs_val.raw->data, std::min<size_t>(cond.rhs_val.raw->size, sizeof(pred.num_val_)));
+            }
+        } else {
+            const ColMeta &rhs_col = find_col(rec_cols, cond.rhs_col);
+            rhs_type = rhs_col.type;
+            pred.rhs_offset_ = rhs_col.offset;
+        }
+        pred.eval_ = select(lhs_col.type, rhs_type, cond.op, cond.is_rhs_val);
+        return pred;
+    }
+
+    bool eval(const char *data) const { return eval_(*this, data); }
+
+    /* 与常量比较的条件改为直接对字段值求值，用于下推到RmScan的过滤条件（参数是字段值的地址） */
+    CompiledPredicate on_field() const {
+        CompiledPredicate pred = *this;
+        pred.lhs_offset_ = 0;
+        return pred;
+    }
+
+    int lhs_offset() const { return lhs_offset_; }
+
+    int len() const { return len_; }
+
+    bool rhs_is_val() const { return rhs_is_val_; }
+
+   private:
+    EvalFunc eval_ = nullptr;
+    int lhs_offset_ = 0;
+    int rhs_offset_ = 0;
+    int len_ = 0;
+    bool rhs_is_val_ = false;
+    alignas(8) char num_val_[8] = {};   // 数值常量的拷贝
+    std::vector<char> str_val_;         // 字符串常量的拷贝
+
+    static const ColMeta &find_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
+        auto pos = std::find_if(rec_cols.begin(), rec_cols.end(), [&](const ColMeta &col) {
+            return col.tab_name == target.tab_name && col.name == target.col_name;
+        });
+        if (pos == rec_cols.end()) {
+            throw ColumnNotFoundError(target.tab_name + '.' + target.col_name);
+        }
+        return *pos;
+    }
+
+    template <typename T>
+    static T load(const char *p) {
+        T v;
+        memcpy(&v, p, sizeof(T));
+        return v;
+    }
+
+    template <CompOp op>
+    static bool apply(int cmp) {
+        if constexpr (op == OP_EQ) {
+            return cmp == 0;
+        } else if constexpr (op == OP_NE) {
+            return cmp != 0;
+        } else if constexpr (op == OP_LT) {
+            return cmp < 0;
+        } else if constexpr (op == OP_GT) {
+            return cmp > 0;
+        } else if constexpr (op == OP_LE) {
+            return cmp <= 0;
+        } else {
+            return cmp >= 0;
+        }
+    }
+
+    /* 数值比较，L、R为两侧的C++类型，类型不同时（INT与FLOAT）都转换成float */
+    template <typename L, typename R>
+    struct NumCompare {
+        template <CompOp op, bool rhs_is_val>
+        static bool eval(const CompiledPredicate &pred, const char *data) {
+            using T = std::conditional_t<std::is_same_v<L, R>, L, float>;
+            T a = static_cast<T>(load<L>(data + pred.lhs_offset_));
+            T b = static_cast<T>(load<R>(rhs_is_val ? pred.num_val_ : data + pred.rhs_offset_));
+            return apply<op>((a < b) ? -1 : ((a > b) ? 1 : 0));
+        }
+    };
+
+    /* 定长字符串比较，长度取左侧字段的长度 */
+    struct StrCompare {
+        template <CompOp op, bool rhs_is_val>
+        static bool eval(const CompiledPredicate &pred, const char *data) {
+            const char *rhs = rhs_is_val ? pred.str_val_.data() : data + pred.rhs_offset_;
+            return apply<op>(memcmp(data + pred.lhs_offset_, rhs, pred.len_));
+        }
+    };
+
+    template <typename Cmp, bool rhs_is_val>
+    static EvalFunc select_op(CompOp op) {
+        switch (op) {
+            case OP_EQ: return &Cmp::template eval<OP_EQ, rhs_is_val>;
+            case OP_NE: return &Cmp::template eval<OP_NE, rhs_is_val>;
+            case OP_LT: return &Cmp::template eval<OP_LT, rhs_is_val>;
+            case OP_GT: return &Cmp::template eval<OP_GT, rhs_is_val>;
+            case OP_LE: return &Cmp::template eval<OP_LE, rhs_is_val>;
+            case OP_GE: return &Cmp::template eval<OP_GE, rhs_is_val>;
+            default: throw InternalError("Unexpected op type");
+        }
+    }
+
+    template <typename Cmp>
+    static EvalFunc select_op(CompOp op, bool rhs_is_val) {
+        return rhs_is_val ? select_op<Cmp, true>(op) : select_op<Cmp, false>(op);
+    }
+
+    static EvalFunc select(ColType lhs_type, ColType rhs_type, CompOp op, bool rhs_is_val) {
+        if (is_string_type(lhs_type) && is_string_type(rhs_type)) {
+            return select_op<StrCompare>(op, rhs_is_val);
+        }
+        if (lhs_type == TYPE_INT && rhs_type == TYPE_INT) {
+            return select_op<NumCompare<int, int>>(op, rhs_is_val);
+        }
+        if (lhs_type == TYPE_FLOAT && rhs_type == TYPE_FLOAT) {
+            return select_op<NumCompare<float, float>>(op, rhs_is_val);
+        }
+        if (lhs_type == TYPE_DATETIME && rhs_type == TYPE_DATETIME) {
+            return select_op<NumCompare<int64_t, int64_t>>(op, rhs_is_val);
+        }
+        if (lhs_type == TYPE_INT && rhs_type == TYPE_FLOAT) {
+            return select_op<NumCompare<int, float>>(op, rhs_is_val);
+        }
+        if (lhs_type == TYPE_FLOAT && rhs_type == TYPE_INT) {
+            return select_op<NumCompare<float, int>>(op, rhs_is_val);
+        }
+        throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(rhs_type));
+    }
+};
+
+/* 一组编译后的条件，全部满足时记录才满足 */
+class PredicateList {
+   public:
+    PredicateList() = default;
+
+    PredicateList(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds) { compile(rec_cols, conds); }
+
+    void compile(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds) {
+        preds_.clear();
+        preds_.reserve(conds.size());
+        for (auto &cond : conds) {
+            preds_.push_back(CompiledPredicate::compile(rec_cols, cond));
+        }
+    }
+
+    bool eval(const char *data) const {
+        for (auto &pred : preds_) {
+            if (!pred.eval(data)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::vector<CompiledPredicate> &preds() const { return preds_; }
+
+    bool empty() const { return preds_.empty(); }
+
+   private:
+    std::vector<CompiledPredicate> preds_;
+};
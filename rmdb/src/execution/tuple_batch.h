@@ -0,0 +1,64 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "defs.h"
+
+// 每批最多的记录条数
+constexpr size_t TUPLE_BATCH_SIZE = 1024;
+
+/* 向量化执行时算子之间传递的一批记录：定长记录连续存放在缓冲区中，缓冲区在多次NextBatch之间复用；
+ * sel中按升序存放有效记录的下标（选择向量），过滤时只改写选择向量，不移动记录 */
+struct TupleBatch {
+    size_t tuple_len = 0;
+    size_t num_rows = 0;            // 缓冲区中的记录条数
+    size_t num_sel = 0;             // 选择向量的长度，即有效记录的条数
+    std::vector<char> data;
+    std::vector<Rid> rids;
+    std::vector<uint16_t> sel;
+
+    /* 清空这一批，记录长度变化时重新分配缓冲区 */
+    void reset(size_t len) {
+        if (len != tuple_len || data.empty()) {
+            tuple_len = len;
+            data.resize(TUPLE_BATCH_SIZE * len);
+            rids.resize(TUPLE_BATCH_SIZE);
+            sel.resize(TUPLE_BATCH_SIZE);
+        }
+        num_rows = num_sel = 0;
+    }
+
+    bool full() const { return num_rows == TUPLE_BATCH_SIZE; }
+
+    /* 在缓冲区末尾追加一条有效记录，返回写入位置 */
+    char *append(const Rid &rid) {
+        rids[num_rows] = rid;
+        sel[num_sel++] = num_rows;
+        return row(num_rows++);
+    }
+
+    /* 缓冲区中的第i条记录 */
+    char *row(size_t i) { return data.data() + i * tuple_len; }
+
+    /* 第k条有效记录 */
+    char *selected(size_t k) { return row(sel[k]); }
+
+    /* 把缓冲区中的记录全部标记为有效 */
+    void select_all() {
+        for (size_t i = 0; i < num_rows; ++i) {
+            sel[i] = i;
+        }
+        num_sel = num_rows;
+    }
+};
@@ -0,0 +1,514 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_art.h"
+
+#include <algorithm>
+#include <mutex>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+IxArtIndex::IxArtIndex(const std::vector<ColType> &col_types, const std::vector<int> &col_lens) {
+    codec_.init(col_types, col_lens);
+    key_len_ = codec_.key_len();
+}
+
+/**
+ * @description: 查找key对应的rid
+ * @return 找到时返回true，rid追加到result中
+ * @param key 原始格式的key
+ */
+bool IxArtIndex::get_value(const char *key, std::vector<Rid> *result) {
+    IxEncodedKey encoded(codec_, key);
+    auto k = reinterpret_cast<const unsigned char *>(encoded.data());
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    Node *n = root_;
+    int depth = 0;
+    while (n != nullptr) {
+        if (is_leaf(n)) {
+            Leaf *l = as_leaf(n);
+            if (!leaf_matches(l, k)) {
+                return false;
+            }
+            result->push_back(l->rid);
+            return true;
+        }
+        // 只比较存下的压缩路径，没有存下的部分在叶结点处比较完整的key时检查
+        if (n->prefix_len > 0) {
+            if (check_prefix(n, k, depth) != std::min<int>(MAX_PREFIX_LEN, n->prefix_len)) {
+                return false;
+            }
+            depth += n->prefix_len;
+        }
+        Node **child = find_child(n, k[depth]);
+        n = child != nullptr ? *child : nullptr;
+        depth++;
+    }
+    return false;
+}
+
+/**
+ * @description: 插入键值对
+ * @return key已经存在时返回false
+ * @param key 原始格式的key
+ */
+bool IxArtIndex::insert_entry(const char *key, const Rid &value) {
+    IxEncodedKey encoded(codec_, key);
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    if (!insert(root_, &root_, reinterpret_cast<const unsigned char *>(encoded.data()), 0, value)) {
+        return false;
+    }
+    size_++;
+    return true;
+}
+
+/**
+ * @description: 删除key对应的键值对
+ * @return key不存在时返回false
+ * @param key 原始格式的key
+ */
+bool IxArtIndex::delete_entry(const char *key) {
+    IxEncodedKey encoded(codec_, key);
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    Leaf *l = remove(root_, &root_, reinterpret_cast<const unsigned char *>(encoded.data()), 0);
+    if (l == nullptr) {
+        return false;
+    }
+    ::operator delete(l);
+    size_--;
+    return true;
+}
+
+IxArtIndex::Node *IxArtIndex::make_leaf(const unsigned char *key, const Rid &rid) const {
+    auto l = static_cast<Leaf *>(::operator new(sizeof(Leaf) + key_len_));
+    l->rid = rid;
+    memcpy(l->key, key, key_len_);
+    return tag_leaf(l);
+}
+
+void IxArtIndex::free_node(Node *n) {
+    if (n == nullptr) {
+        return;
+    }
+    if (is_leaf(n)) {
+        ::operator delete(as_leaf(n));
+        return;
+    }
+    switch (n->type) {
+        case NODE4: {
+            auto p = static_cast<Node4 *>(n);
+            for (int i = 0; i < p->num_children; ++i) {
+                free_node(p->children[i]);
+            }
+            delete p;
+            break;
+        }
+        case NODE16: {
+            auto p = static_cast<Node16 *>(n);
+            for (int i = 0; i < p->num_children; ++i) {
+                free_node(p->children[i]);
+            }
+            delete p;
+            break;
+        }
+        case NODE48: {
+            auto p = static_cast<Node48 *>(n);
+            for (auto child : p->children) {
+                free_node(child);
+            }
+            delete p;
+            break;
+        }
+        case NODE256: {
+            auto p = static_cast<Node256 *>(n);
+            for (auto child : p->children) {
+                free_node(child);
+            }
+            delete p;
+            break;
+        }
+    }
+}
+
+/* 返回结点n中字节c对应的孩子指针所在的位置，没有时返回nullptr */
+IxArtIndex::Node **IxArtIndex::find_child(Node *n, unsigned char c) {
+    switch (n->type) {
+        case NODE4: {
+            auto p = static_cast<Node4 *>(n);
+            for (int i = 0; i < p->num_children; ++i) {
+                if (p->keys[i] == c) {
+                    return &p->children[i];
+                }
+            }
+            return nullptr;
+        }
+        case NODE16: {
+            auto p = static_cast<Node16 *>(n);
+#ifdef __SSE2__
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(c)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i *>(p->keys)));
+            int mask = _mm_movemask_epi8(cmp) & ((1 << p->num_children) - 1);
+            return mask != 0 ? &p->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for (int i = 0; i < p->num_children; ++i) {
+                if (p->keys[i] == c) {
+                    return &p->children[i];
+                }
+            }
+            return nullptr;
+#endif
+        }
+        case NODE48: {
+            auto p = static_cast<Node48 *>(n);
+            int idx = p->child_index[c];
+            return idx != 0 ? &p->children[idx - 1] : nullptr;
+        }
+        case NODE256: {
+            auto p = static_cast<Node256 *>(n);
+            return p->children[c] != nullptr ? &p->children[c] : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+/* 子树中key最小的叶结点，用于取得没有存下的压缩路径 */
+IxArtIndex::Leaf *IxArtIndex::minimum(const Node *n) {
+    while (!is_leaf(n)) {
+        switch (n->type) {
+            case NODE4:
+                n = static_cast<const Node4 *>(n)->children[0];
+                break;
+            case NODE16:
+                n = static_cast<const Node16 *>(n)->children[0];
+                break;
+            case NODE48: {
+                auto p = static_cast<const Node48 *>(n);
+                int c = 0;
+                while (p->child_index[c] == 0) {
+                    c++;
+                }
+                n = p->children[p->child_index[c] - 1];
+                break;
+            }
+            case NODE256: {
+                auto p = static_cast<const Node256 *>(n);
+                int c = 0;
+                while (p->children[c] == nullptr) {
+                    c++;
+                }
+                n = p->children[c];
+                break;
+            }
+        }
+    }
+    return as_leaf(n);
+}
+
+/* 存下的压缩路径与key从depth开始匹配的字节数 */
+int IxArtIndex::check_prefix(const Node *n, const unsigned char *key, int depth) {
+    int max_cmp = std::min<int>(MAX_PREFIX_LEN, n->prefix_len);
+    int idx = 0;
+    while (idx < max_cmp && n->prefix[idx] == key[depth + idx]) {
+        idx++;
+    }
+    return idx;
+}
+
+/* 完整的压缩路径与key从depth开始匹配的字节数，没有存下的部分从子树中任意一个叶结点取得 */
+int IxArtIndex::prefix_mismatch(const Node *n, const unsigned char *key, int depth) const {
+    int idx = check_prefix(n, key, depth);
+    if (idx < MAX_PREFIX_LEN || n->prefix_len <= static_cast<uint32_t>(MAX_PREFIX_LEN)) {
+        return idx;
+    }
+    const Leaf *l = minimum(n);
+    while (idx < static_cast<int>(n->prefix_len) && l->key[depth + idx] == key[depth + idx]) {
+        idx++;
+    }
+    return idx;
+}
+
+void IxArtIndex::copy_header(Node *dest, const Node *src) {
+    dest->num_children = src->num_children;
+    dest->prefix_len = src->prefix_len;
+    memcpy(dest->prefix, src->prefix, std::min<int>(MAX_PREFIX_LEN, src->prefix_len));
+}
+
+/* 在结点n中加入字节c对应的孩子，n满时换成更大的结点，*ref指向n的父结点中的孩子指针 */
+void IxArtIndex::add_child(Node *n, Node **ref, unsigned char c, Node *child) {
+    switch (n->type) {
+        case NODE4: {
+            auto p = static_cast<Node4 *>(n);
+            if (p->num_children < 4) {
+                int idx = 0;
+                while (idx < p->num_children && p->keys[idx] < c) {
+                    idx++;
+                }
+                memmove(p->keys + idx + 1, p->keys + idx, p->num_children - idx);
+                memmove(p->children + idx + 1, p->children + idx, (p->num_children - idx) * sizeof(Node *));
+                p->keys[idx] = c;
+                p->children[idx] = child;
+                p->num_children++;
+                return;
+            }
+            auto nn = new Node16();
+            copy_header(nn, p);
+            memcpy(nn->keys, p->keys, 4);
+            memcpy(nn->children, p->children, 4 * sizeof(Node *));
+            *ref = nn;
+            delete p;
+            add_child(nn, ref, c, child);
+            return;
+        }
+        case NODE16: {
+            auto p = static_cast<Node16 *>(n);
+            if (p->num_children < 16) {
+                int idx = std::lower_bound(p->keys, p->keys + p->num_children, c) - p->keys;
+                memmove(p->keys + idx + 1, p->keys + idx, p->num_children - idx);
+                memmove(p->children + idx + 1, p->children + idx, (p->num_children - idx) * sizeof(Node *));
+                p->keys[idx] = c;
+                p->children[idx] = child;
+                p->num_children++;
+                return;
+            }
+            auto nn = new Node48();
+            copy_header(nn, p);
+            memcpy(nn->children, p->children, 16 * sizeof(Node *));
+            for (int i = 0; i < 16; ++i) {
+                nn->child_index[p->keys[i]] = i + 1;
+            }
+            *ref = nn;
+            delete p;
+            add_child(nn, ref, c, child);
+            return;
+        }
+        case NODE48: {
+            auto p = static_cast<Node48 *>(n);
+            if (p->num_children < 48) {
+                // 删除后children中可能有空位
+                int pos = 0;
+                while (p->children[pos] != nullptr) {
+                    pos++;
+                }
+                p->children[pos] = child;
+                p->child_index[c] = pos + 1;
+                p->num_children++;
+                return;
+            }
+            auto nn = new Node256();
+            copy_header(nn, p);
+            for (int i = 0; i < 256; ++i) {
+                if (p->child_index[i] != 0) {
+                    nn->children[i] = p->children[p->child_index[i] - 1];
+                }
+            }
+            *ref = nn;
+            delete p;
+            add_child(nn, ref, c, child);
+            return;
+        }
+        case NODE256: {
+            auto p = static_cast<Node256 *>(n);
+            p->children[c] = child;
+            p->num_children++;
+            return;
+        }
+    }
+}
+
+/* 从结点n中删除字节c对应的孩子（child指向它），孩子过少时换成更小的结点，
+ * Node4只剩一个孩子时把它与孩子合并，压缩路径拼接为 n的压缩路径 + c' + 孩子的压缩路径 */
+void IxArtIndex::remove_child(Node *n, Node **ref, unsigned char c, Node **child) {
+    switch (n->type) {
+        case NODE4: {
+            auto p = static_cast<Node4 *>(n);
+            int pos = child - p->children;
+            memmove(p->keys + pos, p->keys + pos + 1, p->num_children - pos - 1);
+            memmove(p->children + pos, p->children + pos + 1, (p->num_children - pos - 1) * sizeof(Node *));
+            p->num_children--;
+            if (p->num_children == 1) {
+                Node *only = p->children[0];
+                if (!is_leaf(only)) {
+                    int prefix = p->prefix_len;
+                    if (prefix < MAX_PREFIX_LEN) {
+                        p->prefix[prefix++] = p->keys[0];
+                    }
+                    if (prefix < MAX_PREFIX_LEN) {
+                        int sub = std::min<int>(only->prefix_len, MAX_PREFIX_LEN - prefix);
+                        memcpy(p->prefix + prefix, only->prefix, sub);
+                        prefix += sub;
+                    }
+                    memcpy(only->prefix, p->prefix, std::min(prefix, MAX_PREFIX_LEN));
+                    only->prefix_len += p->prefix_len + 1;
+                }
+                *ref = only;
+                delete p;
+            }
+            return;
+        }
+        case NODE16: {
+            auto p = static_cast<Node16 *>(n);
+            int pos = child - p->children;
+            memmove(p->keys + pos, p->keys + pos + 1, p->num_children - pos - 1);
+            memmove(p->children + pos, p->children + pos + 1, (p->num_children - pos - 1) * sizeof(Node *));
+            p->num_children--;
+            if (p->num_children == 3) {
+                auto nn = new Node4();
+                copy_header(nn, p);
+                memcpy(nn->keys, p->keys, 3);
+                memcpy(nn->children, p->children, 3 * sizeof(Node *));
+                *ref = nn;
+                delete p;
+            }
+            return;
+        }
+        case NODE48: {
+            auto p = static_cast<Node48 *>(n);
+            int pos = p->child_index[c];
+            p->child_index[c] = 0;
+            p->children[pos - 1] = nullptr;
+            p->num_children--;
+            if (p->num_children == 12) {
+                auto nn = new Node16();
+                copy_header(nn, p);
+                int idx = 0;
+                for (int i = 0; i < 256; ++i) {
+                    if (p->child_index[i] != 0) {
+                        nn->keys[idx] = i;
+                        nn->children[idx] = p->children[p->child_index[i] - 1];
+                        idx++;
+                    }
+                }
+                *ref = nn;
+                delete p;
+            }
+            return;
+        }
+        case NODE256: {
+            auto p = static_cast<Node256 *>(n);
+            p->children[c] = nullptr;
+            p->num_children--;
+            if (p->num_children == 37) {
+                auto nn = new Node48();
+                copy_header(nn, p);
+                int pos = 0;
+                for (int i = 0; i < 256; ++i) {
+                    if (p->children[i] != nullptr) {
+                        nn->children[pos] = p->children[i];
+                        nn->child_index[i] = pos + 1;
+                        pos++;
+                    }
+                }
+                *ref = nn;
+                delete p;
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @description: 在以n为根的子树中插入编码后的key，*ref为指向n的指针，depth为n对应的key的字节位置
+ * 所有key等长且不重复，因此一个key不会是另一个key的前缀，内部结点处depth总小于key_len_
+ */
+bool IxArtIndex::insert(Node *n, Node **ref, const unsigned char *key, int depth, const Rid &rid) {
+    if (n == nullptr) {
+        *ref = make_leaf(key, rid);
+        return true;
+    }
+
+    // 遇到叶结点：用一个Node4替换它，Node4的压缩路径为两个key从depth开始的公共部分
+    if (is_leaf(n)) {
+        Leaf *l = as_leaf(n);
+        if (leaf_matches(l, key)) {
+            return false;
+        }
+        int common = 0;
+        while (l->key[depth + common] == key[depth + common]) {
+            common++;
+        }
+        auto nn = new Node4();
+        nn->prefix_len = common;
+        memcpy(nn->prefix, key + depth, std::min(common, MAX_PREFIX_LEN));
+        add_child(nn, ref, l->key[depth + common], n);
+        add_child(nn, ref, key[depth + common], make_leaf(key, rid));
+        *ref = nn;
+        return true;
+    }
+
+    // 压缩路径不匹配：在不匹配的位置分裂出一个Node4
+    if (n->prefix_len > 0) {
+        int diff = prefix_mismatch(n, key, depth);
+        if (diff < static_cast<int>(n->prefix_len)) {
+            auto nn = new Node4();
+            nn->prefix_len = diff;
+            memcpy(nn->prefix, n->prefix, std::min(diff, MAX_PREFIX_LEN));
+            if (n->prefix_len <= static_cast<uint32_t>(MAX_PREFIX_LEN)) {
+                add_child(nn, ref, n->prefix[diff], n);
+                n->prefix_len -= diff + 1;
+                memmove(n->prefix, n->prefix + diff + 1, std::min<int>(MAX_PREFIX_LEN, n->prefix_len));
+            } else {
+                n->prefix_len -= diff + 1;
+                const Leaf *l = minimum(n);
+                add_child(nn, ref, l->key[depth + diff], n);
+                memcpy(n->prefix, l->key + depth + diff + 1, std::min<int>(MAX_PREFIX_LEN, n->prefix_len));
+            }
+            add_child(nn, ref, key[depth + diff], make_leaf(key, rid));
+            *ref = nn;
+            return true;
+        }
+        depth += n->prefix_len;
+    }
+
+    Node **child = find_child(n, key[depth]);
+    if (child != nullptr) {
+        return insert(*child, child, key, depth + 1, rid);
+    }
+    add_child(n, ref, key[depth], make_leaf(key, rid));
+    return true;
+}
+
+/**
+ * @description: 在以n为根的子树中删除编码后的key
+ * @return 被摘下的叶结点，由调用者释放；key不存在时返回nullptr
+ */
+IxArtIndex::Leaf *IxArtIndex::remove(Node *n, Node **ref, const unsigned char *key, int depth) {
+    if (n == nullptr) {
+        return nullptr;
+    }
+    if (is_leaf(n)) {
+        Leaf *l = as_leaf(n);
+        if (!leaf_matches(l, key)) {
+            return nullptr;
+        }
+        *ref = nullptr;
+        return l;
+    }
+    if (n->prefix_len > 0) {
+        if (check_prefix(n, key, depth) != std::min<int>(MAX_PREFIX_LEN, n->prefix_len)) {
+            return nullptr;
+        }
+        depth += n->prefix_len;
+    }
+    Node **child = find_child(n, key[depth]);
+    if (child == nullptr) {
+        return nullptr;
+    }
+    if (is_leaf(*child)) {
+        Leaf *l = as_leaf(*child);
+        if (!leaf_matches(l, key)) {
+            return nullptr;
+        }
+        remove_child(n, ref, key[depth], child);
+        return l;
+    }
+    return remove(*child, child, key, depth + 1);
+}
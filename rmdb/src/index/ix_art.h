@@ -0,0 +1,122 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <shared_mutex>
+#include <vector>
+
+#include "ix_defs.h"
+
+/* 内存中的自适应基数树（ART）索引，key为IxKeyCodec编码后的定长串，key不重复
+ * 内部结点按孩子个数在Node4/16/48/256之间自适应转换，结点中保存压缩的公共路径（最多存MAX_PREFIX_LEN个字节，
+ * 更长时只比较存下的部分，到叶结点再比较完整的key）；叶结点保存完整的key和rid，用指针最低位标记
+ * 索引不写入磁盘，打开数据库时从表中重建。查找时加共享锁，插入删除时加排他锁 */
+class IxArtIndex {
+   private:
+    static constexpr int MAX_PREFIX_LEN = 8;
+
+    enum NodeType : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+    struct Node {
+        NodeType type;
+        uint16_t num_children = 0;
+        uint32_t prefix_len = 0;                // 压缩路径的完整长度
+        unsigned char prefix[MAX_PREFIX_LEN];   // 压缩路径的前MAX_PREFIX_LEN个字节
+
+        explicit Node(NodeType type_) : type(type_) {}
+    };
+
+    struct Node4 : Node {
+        unsigned char keys[4] = {};
+        Node *children[4] = {};
+        Node4() : Node(NODE4) {}
+    };
+
+    struct Node16 : Node {
+        unsigned char keys[16] = {};
+        Node *children[16] = {};
+        Node16() : Node(NODE16) {}
+    };
+
+    struct Node48 : Node {
+        unsigned char child_index[256] = {};    // 0表示没有孩子，否则为孩子在children中的下标加一
+        Node *children[48] = {};
+        Node48() : Node(NODE48) {}
+    };
+
+    struct Node256 : Node {
+        Node *children[256] = {};
+        Node256() : Node(NODE256) {}
+    };
+
+    struct Leaf {
+        Rid rid;
+        unsigned char key[];
+    };
+
+    IxKeyCodec codec_;
+    int key_len_;
+    Node *root_ = nullptr;
+    size_t size_ = 0;
+    std::shared_mutex latch_;
+
+   public:
+    IxArtIndex(const std::vector<ColType> &col_types, const std::vector<int> &col_lens);
+
+    ~IxArtIndex() { free_node(root_); }
+
+    IxArtIndex(const IxArtIndex &) = delete;
+    IxArtIndex &operator=(const IxArtIndex &) = delete;
+
+    // for search
+    bool get_value(const char *key, std::vector<Rid> *result);
+
+    // for insert，key已经存在时返回false
+    bool insert_entry(const char *key, const Rid &value);
+
+    // for delete
+    bool delete_entry(const char *key);
+
+    size_t size() const { return size_; }
+
+    const IxKeyCodec &get_key_codec() const { return codec_; }
+
+   private:
+    static bool is_leaf(const Node *n) { return reinterpret_cast<uintptr_t>(n) & 1; }
+
+    static Leaf *as_leaf(const Node *n) { return reinterpret_cast<Leaf *>(reinterpret_cast<uintptr_t>(n) & ~uintptr_t{1}); }
+
+    static Node *tag_leaf(Leaf *l) { return reinterpret_cast<Node *>(reinterpret_cast<uintptr_t>(l) | 1); }
+
+    Node *make_leaf(const unsigned char *key, const Rid &rid) const;
+
+    bool leaf_matches(const Leaf *l, const unsigned char *key) const { return memcmp(l->key, key, key_len_) == 0; }
+
+    static void free_node(Node *n);
+
+    static Node **find_child(Node *n, unsigned char c);
+
+    static Leaf *minimum(const Node *n);
+
+    static int check_prefix(const Node *n, const unsigned char *key, int depth);
+
+    int prefix_mismatch(const Node *n, const unsigned char *key, int depth) const;
+
+    static void copy_header(Node *dest, const Node *src);
+
+    static void add_child(Node *n, Node **ref, unsigned char c, Node *child);
+
+    static void remove_child(Node *n, Node **ref, unsigned char c, Node **child);
+
+    bool insert(Node *n, Node **ref, const unsigned char *key, int depth, const Rid &rid);
+
+    Leaf *remove(Node *n, Node **ref, const unsigned char *key, int depth);
+};
@@ -0,0 +1,126 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+// Bloom过滤器每个key占用的位数，批量构建时按它确定页面数，约1%的误判率
+constexpr int IX_BLOOM_BITS_PER_KEY = 10;
+// 过滤器最多占用的页面数，文件头中要存下所有页面号
+constexpr int IX_BLOOM_MAX_PAGES = 512;
+
+/* Bloom过滤器的统计信息 */
+struct IxBloomStats {
+    int num_pages = 0;
+    double fill_ratio = 0;          // 位图中1的比例
+    double estimated_fpr = 0;       // 按fill_ratio估计的误判率
+    uint64_t probes = 0;            // 查询次数
+    uint64_t negatives = 0;         // 被过滤器直接排除的次数
+    uint64_t false_positives = 0;   // 过滤器放行但B+树中不存在的次数
+};
+
+/* 分块Bloom过滤器：位图分成64字节（一个cache line）的块，key的哈希值高32位选块，
+ * 低32位乘以BLOCK_WORDS个不同的奇数，在块中每个64位字里各置一位，查询和插入都只访问一个块
+ * 位图按页面顺序存放在索引文件中，内存中保存一份副本供查询。删除key时不清除对应的位，过滤器只会多报不会漏报 */
+class IxBloomFilter {
+   public:
+    static constexpr int BLOCK_WORDS = 8;
+    static constexpr int WORDS_PER_PAGE = PAGE_SIZE / sizeof(uint64_t);
+    static constexpr int BLOCKS_PER_PAGE = WORDS_PER_PAGE / BLOCK_WORDS;
+
+   private:
+    std::vector<uint64_t> words_;
+    size_t num_blocks_ = 0;
+    mutable std::atomic<uint64_t> probes_{0};
+    mutable std::atomic<uint64_t> negatives_{0};
+    mutable std::atomic<uint64_t> false_positives_{0};
+
+   public:
+    /* 清空位图并设置页面数，为0时表示不使用过滤器 */
+    void init(int num_pages) {
+        words_.assign((size_t)num_pages * WORDS_PER_PAGE, 0);
+        num_blocks_ = (size_t)num_pages * BLOCKS_PER_PAGE;
+    }
+
+    bool enabled() const { return num_blocks_ > 0; }
+
+    /* 第i个页面在内存副本中的位图 */
+    uint64_t *page_words(int i) { return words_.data() + (size_t)i * WORDS_PER_PAGE; }
+
+    /* key落在第几个块，块号除以BLOCKS_PER_PAGE即为页面在过滤器中的序号 */
+    size_t block_of(uint64_t hash) const { return (size_t)(((hash >> 32) * num_blocks_) >> 32); }
+
+    /* 只在内存副本中置位，返回是否有新的位被置上 */
+    bool add(uint64_t hash) { return set_bits(words_.data() + block_of(hash) * BLOCK_WORDS, hash); }
+
+    /* 查询并计数：返回false时key一定不存在 */
+    bool may_contain(uint64_t hash) const {
+        probes_.fetch_add(1, std::memory_order_relaxed);
+        if (!test_bits(words_.data() + block_of(hash) * BLOCK_WORDS, hash)) {
+            negatives_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void record_false_positive() const { false_positives_.fetch_add(1, std::memory_order_relaxed); }
+
+    /* 在一个块中置位，block可以是内存副本也可以是页面中的数据，多个线程可以并发置位 */
+    static bool set_bits(uint64_t *block, uint64_t hash) {
+        bool changed = false;
+        for (int i = 0; i < BLOCK_WORDS; ++i) {
+            uint64_t mask = bit_mask(hash, i);
+            if ((__atomic_load_n(&block[i], __ATOMIC_RELAXED) & mask) == 0) {
+                __atomic_fetch_or(&block[i], mask, __ATOMIC_RELAXED);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    static bool test_bits(const uint64_t *block, uint64_t hash) {
+        uint64_t missing = 0;
+        for (int i = 0; i < BLOCK_WORDS; ++i) {
+            missing |= bit_mask(hash, i) & ~__atomic_load_n(&block[i], __ATOMIC_RELAXED);
+        }
+        return missing == 0;
+    }
+
+    IxBloomStats get_stats() const {
+        IxBloomStats stats;
+        stats.num_pages = num_blocks_ / BLOCKS_PER_PAGE;
+        if (enabled()) {
+            size_t ones = 0;
+            for (uint64_t w : words_) {
+                ones += __builtin_popcountll(w);
+            }
+            stats.fill_ratio = (double)ones / (words_.size() * 64);
+            // 每个字中各置一位，误判即BLOCK_WORDS个字中对应的位都恰好为1
+            stats.estimated_fpr = std::pow(stats.fill_ratio, BLOCK_WORDS);
+        }
+        stats.probes = probes_.load(std::memory_order_relaxed);
+        stats.negatives = negatives_.load(std::memory_order_relaxed);
+        stats.false_positives = false_positives_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+   private:
+    static uint64_t bit_mask(uint64_t hash, int i) {
+        static constexpr uint32_t SALT[BLOCK_WORDS] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                       0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return uint64_t{1} << ((static_cast<uint32_t>(hash) * SALT[i]) >> 26);
+    }
+};
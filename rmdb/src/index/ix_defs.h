@@ -13,6 +13,8 @@ See the Mulan PSL v2 for more details. */
 #include <vector>
 
 #include "defs.h"
+#include "ix_key_codec.h"
+#include "ix_search.h"
 #include "storage/buffer_pool_manager.h"
 
 constexpr int IX_NO_PAGE = -1;
@@ -21,22 +23,40 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+// 非唯一索引在key的末尾附加rid的page_no和slot_no两个隐藏的INT字段，使key重复的记录各自成为不同的键值对
+constexpr int IX_RID_KEY_LEN = 2 * sizeof(int);
+constexpr int IX_MAX_KEY_LEN = IX_MAX_COL_LEN + IX_RID_KEY_LEN;
+// 批量建索引的填充因子（百分比），低于50时结点刚建好就不足半满
+constexpr int IX_MIN_FILL_FACTOR = 50;
+constexpr int IX_MAX_FILL_FACTOR = 100;
+constexpr int IX_DEFAULT_FILL_FACTOR = 90;
 
 class IxFileHdr {
 public: 
     page_id_t first_free_page_no_;      // 文件中第一个空闲的磁盘页面的页面号
     int num_pages_;                     // 磁盘文件中页面的数量
     page_id_t root_page_;               // B+树根节点对应的页面号
-    int col_num_;                       // 索引包含的字段数量
+    int col_num_;                       // 索引包含的字段数量，非唯一索引包括末尾的两个rid字段
     std::vector<ColType> col_types_;    // 字段的类型
     std::vector<int> col_lens_;         // 字段的长度
     int col_tot_len_;                   // 索引包含的字段的总长度
+    bool unique_ = true;                // 为false时key的末尾附加了rid字段，见IX_RID_KEY_LEN
     int btree_order_;                   // # children per page 每个结点最多可插入的键值对数量
     int keys_size_;                     // keys_size = (btree_order + 1) * col_tot_len
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
+    std::vector<page_id_t> bloom_pages_;  // 按顺序存放Bloom过滤器位图的页面，为空时不使用过滤器
+    // 以下为统计信息：插入、删除和结构调整时增量维护，并发修改用原子操作
+    int64_t num_entries_ = 0;           // 键值对数量
+    int num_leaves_ = 1;                // 叶结点数量
+    int height_ = 1;                    // 树高，只有根叶子结点时为1
+    // 第i项为前i+1个字段组成的前缀的不同取值个数，只在批量构建和REINDEX时重新计算
+    std::vector<int64_t> distinct_prefixes_;
+    int64_t distinct_entries_ = 0;      // 计算distinct_prefixes_时的键值对数量，用来按比例估计当前的值
     int tot_len_;                       // 记录结构体的整体长度
+    IxKeyCodec key_codec_;              // key的规范化编码，打开索引时初始化，不写入磁盘
+    IxKeySearch key_search_;            // 结点内查找函数，打开索引时根据col_tot_len_选择，不写入磁盘
 
     IxFileHdr() {
         tot_len_ = col_num_ = 0;
@@ -51,8 +71,10 @@ public:
 
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 7;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
+        tot_len_ += sizeof(int) + sizeof(page_id_t) * bloom_pages_.size();
+        tot_len_ += sizeof(int64_t) * 2 + sizeof(int) * 2 + sizeof(int64_t) * col_num_;
     }
 
     void serialize(char* dest) {
@@ -77,6 +99,9 @@ public:
         }
         memcpy(dest + offset, &col_tot_len_, sizeof(int));
         offset += sizeof(int);
+        int unique = unique_;
+        memcpy(dest + offset, &unique, sizeof(int));
+        offset += sizeof(int);
         memcpy(dest + offset, &btree_order_, sizeof(int));
         offset += sizeof(int);
         memcpy(dest + offset, &keys_size_, sizeof(int));
@@ -85,6 +110,21 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        int num_bloom_pages = bloom_pages_.size();
+        memcpy(dest + offset, &num_bloom_pages, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, bloom_pages_.data(), sizeof(page_id_t) * num_bloom_pages);
+        offset += sizeof(page_id_t) * num_bloom_pages;
+        memcpy(dest + offset, &num_entries_, sizeof(int64_t));
+        offset += sizeof(int64_t);
+        memcpy(dest + offset, &num_leaves_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &height_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, distinct_prefixes_.data(), sizeof(int64_t) * col_num_);
+        offset += sizeof(int64_t) * col_num_;
+        memcpy(dest + offset, &distinct_entries_, sizeof(int64_t));
+        offset += sizeof(int64_t);
         assert(offset == tot_len_);
     }
 
@@ -100,7 +140,6 @@ public:
         offset += sizeof(page_id_t);
         col_num_ = *reinterpret_cast<const int*>(src + offset);
         offset += sizeof(int);
-        std::cout << col_num_ << "\n";
         for(int i = 0; i < col_num_; ++i) {
             // col_types_[i] = *reinterpret_cast<const ColType*>(src + offset);
             ColType type = *reinterpret_cast<const ColType*>(src + offset);
@@ -115,6 +154,8 @@ public:
         }
         col_tot_len_ = *reinterpret_cast<const int*>(src + offset);
         offset += sizeof(int);
+        unique_ = *reinterpret_cast<const int*>(src + offset) != 0;
+        offset += sizeof(int);
         btree_order_ = *reinterpret_cast<const int*>(src + offset);
         offset += sizeof(int);
         keys_size_ = *reinterpret_cast<const int*>(src + offset);
@@ -123,6 +164,22 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        int num_bloom_pages = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        bloom_pages_.resize(num_bloom_pages);
+        memcpy(bloom_pages_.data(), src + offset, sizeof(page_id_t) * num_bloom_pages);
+        offset += sizeof(page_id_t) * num_bloom_pages;
+        num_entries_ = *reinterpret_cast<const int64_t*>(src + offset);
+        offset += sizeof(int64_t);
+        num_leaves_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        height_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        distinct_prefixes_.resize(col_num_);
+        memcpy(distinct_prefixes_.data(), src + offset, sizeof(int64_t) * col_num_);
+        offset += sizeof(int64_t) * col_num_;
+        distinct_entries_ = *reinterpret_cast<const int64_t*>(src + offset);
+        offset += sizeof(int64_t);
         assert(offset == tot_len_);
     }
 };
@@ -133,8 +190,18 @@ public:
     page_id_t parent;               // 父亲节点所在页面的叶号
     int num_key;                    // # current keys (always equals to #child - 1) 已插入的keys数量，key_idx∈[0,num_key)
     bool is_leaf;                   // 是否为叶节点
+    bool has_high_key;              // 是否有high key，每一层最右边的结点没有high key（即正无穷）
     page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
-    page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
+    page_id_t next_leaf;            // 右兄弟结点的page_no：叶结点为叶子链表的后继，内部结点为同一层的右兄弟（B-link），没有时为IX_NO_PAGE
+    int prefix_len;                 // 内部结点：所有key的公共前缀长度
+    int heap_size;                  // 内部结点：页面末尾存放公共前缀和各个key后缀的总字节数
+};
+
+/* 内部结点的槽：孩子结点的页号，以及key去掉公共前缀、截掉末尾的0之后剩下的后缀在页面中的位置和长度 */
+struct IxInnerSlot {
+    page_id_t child;
+    uint16_t offset;
+    uint16_t len;
 };
 
 class Iid {
@@ -0,0 +1,224 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_hash_index.h"
+
+#include <algorithm>
+
+IxHashIndexHandle::IxHashIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
+    : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+    char buf[PAGE_SIZE];
+    disk_manager_->read_page(fd, IX_HASH_FILE_HDR_PAGE, buf, PAGE_SIZE);
+    file_hdr_.deserialize(buf);
+    file_hdr_.key_codec_.init(file_hdr_.col_types_, file_hdr_.col_lens_);
+    disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages_);
+
+    // 把目录读入内存
+    size_t dir_size = size_t{1} << file_hdr_.global_depth_;
+    dir_.resize(dir_size);
+    for (size_t i = 0; i < file_hdr_.dir_pages_.size(); ++i) {
+        size_t begin = i * IX_HASH_DIR_ENTRIES_PER_PAGE;
+        size_t n = std::min<size_t>(IX_HASH_DIR_ENTRIES_PER_PAGE, dir_size - begin);
+        Page *page = fetch_page(file_hdr_.dir_pages_[i]);
+        memcpy(dir_.data() + begin, page->get_data(), n * sizeof(page_id_t));
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
+}
+
+/* 在桶中查找编码后的key，返回其下标，不存在时返回-1 */
+int IxHashIndexHandle::find_in_bucket(Page *page, const char *encoded_key) const {
+    int n = bucket_hdr(page)->num_entries;
+    for (int i = 0; i < n; ++i) {
+        if (memcmp(bucket_key(page, i), encoded_key, file_hdr_.col_tot_len_) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @description: 查找key对应的rid
+ * @return 找到时返回true，rid追加到result中
+ * @param key 原始格式的key
+ */
+bool IxHashIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
+    IxEncodedKey encoded(file_hdr_.key_codec_, key);
+    uint64_t hash = IxKeyCodec::hash(encoded.data(), file_hdr_.col_tot_len_);
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    Page *page = fetch_page(dir_[hash & (dir_.size() - 1)]);
+    int pos = find_in_bucket(page, encoded.data());
+    if (pos >= 0) {
+        result->push_back(*bucket_rid(page, pos));
+    }
+    buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    return pos >= 0;
+}
+
+/**
+ * @description: 插入键值对，桶满时分裂后重试
+ * @return key已经存在时返回false
+ * @param key 原始格式的key
+ */
+bool IxHashIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
+    IxEncodedKey encoded(file_hdr_.key_codec_, key);
+    uint64_t hash = IxKeyCodec::hash(encoded.data(), file_hdr_.col_tot_len_);
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    while (true) {
+        Page *page = fetch_page(dir_[hash & (dir_.size() - 1)]);
+        IxHashBucketHdr *hdr = bucket_hdr(page);
+        if (find_in_bucket(page, encoded.data()) >= 0) {
+            buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+            return false;
+        }
+        if (hdr->num_entries < file_hdr_.bucket_capacity_) {
+            memcpy(bucket_key(page, hdr->num_entries), encoded.data(), file_hdr_.col_tot_len_);
+            *bucket_rid(page, hdr->num_entries) = value;
+            hdr->num_entries++;
+            buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+            return true;
+        }
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+        split_bucket(hash);
+    }
+}
+
+/**
+ * @description: 删除key对应的键值对，用桶中最后一个键值对填补空位
+ * @return key不存在时返回false
+ * @param key 原始格式的key
+ */
+bool IxHashIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+    IxEncodedKey encoded(file_hdr_.key_codec_, key);
+    uint64_t hash = IxKeyCodec::hash(encoded.data(), file_hdr_.col_tot_len_);
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    Page *page = fetch_page(dir_[hash & (dir_.size() - 1)]);
+    int pos = find_in_bucket(page, encoded.data());
+    if (pos < 0) {
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+        return false;
+    }
+    IxHashBucketHdr *hdr = bucket_hdr(page);
+    int last = --hdr->num_entries;
+    if (pos != last) {
+        memcpy(bucket_key(page, pos), bucket_key(page, last), file_hdr_.col_tot_len_);
+        *bucket_rid(page, pos) = *bucket_rid(page, last);
+    }
+    buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+    return true;
+}
+
+Page *IxHashIndexHandle::new_page() {
+    file_hdr_.num_pages_++;
+    PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+    Page *page = buffer_pool_manager_->new_page(&page_id);
+    memset(page->get_data(), 0, PAGE_SIZE);
+    return page;
+}
+
+/**
+ * @description: 分裂哈希值为hash的key所在的桶，调用者持有排他锁
+ * 局部深度等于全局深度时先把目录加倍；分裂后局部深度加一，哈希值第local_depth位为1的键值对移到新桶，
+ * 原来指向该桶的目录项中，对应位为1的改为指向新桶
+ */
+void IxHashIndexHandle::split_bucket(uint64_t hash) {
+    page_id_t old_page_no = dir_[hash & (dir_.size() - 1)];
+    Page *old_page = fetch_page(old_page_no);
+    IxHashBucketHdr *old_hdr = bucket_hdr(old_page);
+    int local_depth = old_hdr->local_depth;
+
+    std::vector<int> changed;
+    if (local_depth == file_hdr_.global_depth_) {
+        if (file_hdr_.global_depth_ == IX_HASH_MAX_GLOBAL_DEPTH) {
+            buffer_pool_manager_->unpin_page(old_page->get_page_id(), false);
+            throw InternalError("IxHashIndexHandle::split_bucket: directory is full");
+        }
+        // 目录加倍，新的一半与旧的一半相同
+        size_t old_size = dir_.size();
+        dir_.resize(old_size * 2);
+        std::copy(dir_.begin(), dir_.begin() + old_size, dir_.begin() + old_size);
+        file_hdr_.global_depth_++;
+        while (file_hdr_.dir_pages_.size() * IX_HASH_DIR_ENTRIES_PER_PAGE < dir_.size()) {
+            Page *dir_page = new_page();
+            file_hdr_.dir_pages_.push_back(dir_page->get_page_id().page_no);
+            buffer_pool_manager_->unpin_page(dir_page->get_page_id(), true);
+        }
+        for (size_t i = old_size; i < dir_.size(); ++i) {
+            changed.push_back(i);
+        }
+    }
+
+    Page *new_bucket = new_page();
+    IxHashBucketHdr *new_hdr = bucket_hdr(new_bucket);
+    old_hdr->local_depth = new_hdr->local_depth = local_depth + 1;
+
+    // 重新分配键值对
+    int n = old_hdr->num_entries;
+    int kept = 0;
+    new_hdr->num_entries = 0;
+    for (int i = 0; i < n; ++i) {
+        const char *key = bucket_key(old_page, i);
+        if ((IxKeyCodec::hash(key, file_hdr_.col_tot_len_) >> local_depth) & 1) {
+            memcpy(bucket_key(new_bucket, new_hdr->num_entries), key, file_hdr_.col_tot_len_);
+            *bucket_rid(new_bucket, new_hdr->num_entries) = *bucket_rid(old_page, i);
+            new_hdr->num_entries++;
+        } else {
+            if (kept != i) {
+                memcpy(bucket_key(old_page, kept), key, file_hdr_.col_tot_len_);
+                *bucket_rid(old_page, kept) = *bucket_rid(old_page, i);
+            }
+            kept++;
+        }
+    }
+    old_hdr->num_entries = kept;
+
+    // 指向旧桶的目录项的低local_depth位都相同，其中第local_depth位为1的改为指向新桶
+    page_id_t new_page_no = new_bucket->get_page_id().page_no;
+    size_t low = hash & ((size_t{1} << local_depth) - 1);
+    for (size_t i = low | (size_t{1} << local_depth); i < dir_.size(); i += size_t{1} << (local_depth + 1)) {
+        assert(dir_[i] == old_page_no);
+        dir_[i] = new_page_no;
+        changed.push_back(i);
+    }
+    buffer_pool_manager_->unpin_page(old_page->get_page_id(), true);
+    buffer_pool_manager_->unpin_page(new_bucket->get_page_id(), true);
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    write_dir_entries(changed);
+    write_file_hdr();
+}
+
+/* 把内存中目录的指定项写入目录页，dir_idxs升序排列，同一个目录页只fetch一次 */
+void IxHashIndexHandle::write_dir_entries(const std::vector<int> &dir_idxs) {
+    Page *page = nullptr;
+    int cur = -1;
+    for (int idx : dir_idxs) {
+        int dir_page_idx = idx / IX_HASH_DIR_ENTRIES_PER_PAGE;
+        if (dir_page_idx != cur) {
+            if (page != nullptr) {
+                buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+            }
+            page = fetch_page(file_hdr_.dir_pages_[dir_page_idx]);
+            cur = dir_page_idx;
+        }
+        memcpy(page->get_data() + (idx % IX_HASH_DIR_ENTRIES_PER_PAGE) * sizeof(page_id_t), &dir_[idx],
+               sizeof(page_id_t));
+    }
+    if (page != nullptr) {
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+    }
+}
+
+/* 文件头也通过缓冲池写回，与桶和目录页一起刷盘 */
+void IxHashIndexHandle::write_file_hdr() {
+    Page *page = fetch_page(IX_HASH_FILE_HDR_PAGE);
+    file_hdr_.serialize(page->get_data());
+    buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+}
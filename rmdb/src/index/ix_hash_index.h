@@ -0,0 +1,145 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <shared_mutex>
+#include <vector>
+
+#include "ix_defs.h"
+#include "transaction/transaction.h"
+
+constexpr int IX_HASH_FILE_HDR_PAGE = 0;
+constexpr int IX_HASH_INIT_DIR_PAGE = 1;
+constexpr int IX_HASH_INIT_BUCKET_PAGE = 2;
+constexpr int IX_HASH_INIT_NUM_PAGES = 3;
+// 每个目录页存放的目录项个数
+constexpr int IX_HASH_DIR_ENTRIES_PER_PAGE = PAGE_SIZE / sizeof(page_id_t);
+// 全局深度的上限，目录页的页号都存放在文件头页中，2^19个目录项需要512个目录页
+constexpr int IX_HASH_MAX_GLOBAL_DEPTH = 19;
+
+/* 哈希索引的文件头，存放在第0页 */
+class IxHashFileHdr {
+public:
+    int num_pages_;                     // 磁盘文件中页面的数量
+    int global_depth_;                  // 目录的全局深度，目录共有2^global_depth_项
+    int bucket_capacity_;               // 每个桶最多存放的键值对数量
+    int col_num_;                       // 索引包含的字段数量
+    std::vector<ColType> col_types_;    // 字段的类型
+    std::vector<int> col_lens_;         // 字段的长度
+    int col_tot_len_;                   // 索引包含的字段的总长度
+    std::vector<page_id_t> dir_pages_;  // 按顺序存放目录的页面
+    IxKeyCodec key_codec_;              // key的规范化编码，打开索引时初始化，不写入磁盘
+
+    int tot_len() const {
+        return sizeof(int) * 6 + (sizeof(ColType) + sizeof(int)) * col_num_ + sizeof(page_id_t) * dir_pages_.size();
+    }
+
+    void serialize(char *dest) const {
+        int header[5] = {num_pages_, global_depth_, bucket_capacity_, col_num_, col_tot_len_};
+        memcpy(dest, header, sizeof(header));
+        int offset = sizeof(header);
+        memcpy(dest + offset, col_types_.data(), sizeof(ColType) * col_num_);
+        offset += sizeof(ColType) * col_num_;
+        memcpy(dest + offset, col_lens_.data(), sizeof(int) * col_num_);
+        offset += sizeof(int) * col_num_;
+        int num_dir_pages = dir_pages_.size();
+        memcpy(dest + offset, &num_dir_pages, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, dir_pages_.data(), sizeof(page_id_t) * num_dir_pages);
+        offset += sizeof(page_id_t) * num_dir_pages;
+        assert(offset == tot_len() && offset <= PAGE_SIZE);
+    }
+
+    void deserialize(const char *src) {
+        int header[5];
+        memcpy(header, src, sizeof(header));
+        num_pages_ = header[0];
+        global_depth_ = header[1];
+        bucket_capacity_ = header[2];
+        col_num_ = header[3];
+        col_tot_len_ = header[4];
+        int offset = sizeof(header);
+        col_types_.resize(col_num_);
+        memcpy(col_types_.data(), src + offset, sizeof(ColType) * col_num_);
+        offset += sizeof(ColType) * col_num_;
+        col_lens_.resize(col_num_);
+        memcpy(col_lens_.data(), src + offset, sizeof(int) * col_num_);
+        offset += sizeof(int) * col_num_;
+        int num_dir_pages;
+        memcpy(&num_dir_pages, src + offset, sizeof(int));
+        offset += sizeof(int);
+        dir_pages_.resize(num_dir_pages);
+        memcpy(dir_pages_.data(), src + offset, sizeof(page_id_t) * num_dir_pages);
+    }
+};
+
+/* 桶页面的页头，之后依次存放bucket_capacity_个编码后的key和bucket_capacity_个rid */
+struct IxHashBucketHdr {
+    int local_depth;                    // 桶的局部深度
+    int num_entries;                    // 桶中的键值对数量
+};
+
+/* 可扩展哈希索引，只支持等值查找，key不重复
+ * 目录常驻内存，修改时同步写入目录页；桶是一个页面，查找时根据key的哈希值的低global_depth_位找到桶，只访问一个页面
+ * 桶满时分裂：局部深度等于全局深度时先把目录加倍，然后把桶中的键值对按哈希值的第local_depth位分到两个桶中
+ * 删除时不合并桶 */
+class IxHashIndexHandle {
+    friend class IxManager;
+
+   private:
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;                            // 存储哈希索引的文件
+    IxHashFileHdr file_hdr_;
+    std::vector<page_id_t> dir_;        // 目录：第i项为哈希值低位等于i的key所在的桶
+    std::shared_mutex latch_;           // 查找时加共享锁，插入删除时加排他锁
+
+   public:
+    IxHashIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
+
+    // for search
+    bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
+
+    // for insert，key已经存在时返回false
+    bool insert_entry(const char *key, const Rid &value, Transaction *transaction);
+
+    // for delete
+    bool delete_entry(const char *key, Transaction *transaction);
+
+    const IxKeyCodec &get_key_codec() const { return file_hdr_.key_codec_; }
+
+    int get_global_depth() const { return file_hdr_.global_depth_; }
+
+   private:
+    /* 桶页面中第i个key和第i个rid */
+    char *bucket_key(Page *page, int i) const {
+        return page->get_data() + sizeof(IxHashBucketHdr) + (size_t)i * file_hdr_.col_tot_len_;
+    }
+
+    Rid *bucket_rid(Page *page, int i) const {
+        return reinterpret_cast<Rid *>(page->get_data() + sizeof(IxHashBucketHdr) +
+                                       (size_t)file_hdr_.bucket_capacity_ * file_hdr_.col_tot_len_) + i;
+    }
+
+    static IxHashBucketHdr *bucket_hdr(Page *page) { return reinterpret_cast<IxHashBucketHdr *>(page->get_data()); }
+
+    int find_in_bucket(Page *page, const char *encoded_key) const;
+
+    Page *fetch_page(page_id_t page_no) const { return buffer_pool_manager_->fetch_page(PageId{fd_, page_no}); }
+
+    Page *new_page();
+
+    void split_bucket(uint64_t hash);
+
+    void write_dir_entries(const std::vector<int> &dir_idxs);
+
+    void write_file_hdr();
+};
@@ -10,8 +10,43 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_index_handle.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "ix_scan.h"
 
+namespace {
+
+/* a和b的公共前缀长度，不超过len */
+int common_prefix_len(const char *a, const char *b, int len) {
+    int i = 0;
+    while (i < len && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+/* 去掉末尾的0之后key的长度 */
+int significant_len(const char *key, int len) {
+    while (len > 0 && key[len - 1] == 0) {
+        --len;
+    }
+    return len;
+}
+
+/**
+ * @brief 后缀截断：生成满足 left < separator <= right 的分隔key，只保留right中区分left所需的最短前缀，其余字节置0
+ * 编码后的key按memcmp比较，因此末尾补0的前缀不大于right，而在第一个不同的字节上大于left
+ */
+void make_separator(const char *left, const char *right, int key_len, char *separator) {
+    int len = common_prefix_len(left, right, key_len) + 1;
+    assert(len <= key_len);
+    memcpy(separator, right, len);
+    memset(separator + len, 0, key_len - len);
+}
+
+}  // namespace
+
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
  *
@@ -19,25 +54,138 @@ See the Mulan PSL v2 for more details. */
  * @note 返回key index（同时也是rid index），作为slot no
  */
 int IxNodeHandle::lower_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
-
-    return -1;
+    return file_hdr->key_search_.lower_bound(keys, 0, page_hdr->num_key, target);
 }
 
 /**
- * @brief 在当前node中查找第一个>target的key_idx
+ * @brief 在当前内部结点中查找第一个>target的key_idx
  *
  * @return key_idx，范围为[1,num_key)，如果返回的key_idx=num_key，则表示target大于等于最后一个key
- * @note 注意此处的范围从1开始
+ * @note 注意此处的范围从1开始。先和公共前缀比较，相同时再在各个key的后缀上二分查找，
+ * 后缀之后被截掉的字节都是0，因此target的对应部分与后缀相同时，target一定不小于这个key
  */
 int IxNodeHandle::upper_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
+    int n = page_hdr->num_key;
+    int prefix_len = page_hdr->prefix_len;
+    int res = memcmp(target, get_prefix(), prefix_len);
+    if (res < 0 || n <= 1) {
+        return 1;
+    }
+    if (res > 0) {
+        return n;
+    }
+    const char *tail = target + prefix_len;
+    const char *data = page->get_data();
+    int first = 1;
+    int len = n - 1;
+    while (len > 0) {
+        int half = len / 2;
+        int mid = first + half;
+        const IxInnerSlot *slot = get_slot(mid);
+        bool go_right = memcmp(data + slot->offset, tail, slot->len) <= 0;
+        first = go_right ? mid + 1 : first;
+        len = go_right ? len - half - 1 : half;
+    }
+    return first;
+}
 
-    return -1;
+/**
+ * @brief 把第key_idx个完整的key复制到dest中
+ */
+void IxNodeHandle::copy_key(int key_idx, char *dest) const {
+    int key_len = file_hdr->col_tot_len_;
+    if (page_hdr->is_leaf) {
+        memcpy(dest, get_key(key_idx), key_len);
+        return;
+    }
+    int prefix_len = page_hdr->prefix_len;
+    const IxInnerSlot *slot = get_slot(key_idx);
+    memcpy(dest, get_prefix(), prefix_len);
+    memcpy(dest + prefix_len, page->get_data() + slot->offset, slot->len);
+    memset(dest + prefix_len + slot->len, 0, key_len - prefix_len - slot->len);
+}
+
+/**
+ * @brief 解码内部结点中的所有键值对
+ */
+void IxNodeHandle::load_entries(IxInnerEntries *entries) const {
+    assert(!page_hdr->is_leaf);
+    std::vector<char> key(file_hdr->col_tot_len_);
+    entries->clear();
+    for (int i = 0; i < page_hdr->num_key; ++i) {
+        copy_key(i, key.data());
+        entries->insert(i, key.data(), get_slot(i)->child);
+    }
+}
+
+/**
+ * @brief 计算把entries中[from, to)的键值对编码成一个内部结点需要的页面字节数，不超过PAGE_SIZE时才放得下
+ */
+int IxNodeHandle::entries_page_size(const IxFileHdr *file_hdr, const IxInnerEntries &entries, int from, int to) {
+    int key_len = file_hdr->col_tot_len_;
+    int prefix_len = to > from ? key_len : 0;
+    for (int i = from + 1; i < to; ++i) {
+        prefix_len = common_prefix_len(entries.key(from), entries.key(i), prefix_len);
+    }
+    int heap_size = prefix_len;
+    for (int i = from; i < to; ++i) {
+        heap_size += std::max(0, significant_len(entries.key(i), key_len) - prefix_len);
+    }
+    return sizeof(IxPageHdr) + key_len + (to - from) * sizeof(IxInnerSlot) + heap_size;
+}
+
+/**
+ * @brief 把entries中[from, to)的键值对编码到内部结点中，覆盖结点原来的内容，不修改page_hdr中的其他字段
+ * @return 放不下时返回false，结点保持不变
+ */
+bool IxNodeHandle::store_entries(const IxInnerEntries &entries, int from, int to) {
+    if (entries_page_size(file_hdr, entries, from, to) > PAGE_SIZE) {
+        return false;
+    }
+    int key_len = file_hdr->col_tot_len_;
+    int prefix_len = to > from ? key_len : 0;
+    for (int i = from + 1; i < to; ++i) {
+        prefix_len = common_prefix_len(entries.key(from), entries.key(i), prefix_len);
+    }
+    char *data = page->get_data();
+    int offset = PAGE_SIZE - prefix_len;
+    if (to > from) {
+        memcpy(data + offset, entries.key(from), prefix_len);
+    }
+    for (int i = from; i < to; ++i) {
+        int len = std::max(0, significant_len(entries.key(i), key_len) - prefix_len);
+        offset -= len;
+        memcpy(data + offset, entries.key(i) + prefix_len, len);
+        *get_slot(i - from) = {.child = entries.child(i),
+                               .offset = static_cast<uint16_t>(offset),
+                               .len = static_cast<uint16_t>(len)};
+    }
+    page_hdr->num_key = to - from;
+    page_hdr->prefix_len = prefix_len;
+    page_hdr->heap_size = PAGE_SIZE - offset;
+    return true;
+}
+
+/**
+ * @brief 在内部结点的pos位置插入一个分隔key和孩子结点
+ * @return 放不下时返回false，调用者需要分裂结点
+ */
+bool IxNodeHandle::insert_child(int pos, const char *key, page_id_t child) {
+    IxInnerEntries entries(file_hdr->col_tot_len_);
+    load_entries(&entries);
+    entries.insert(pos, key, child);
+    return store_entries(entries, 0, entries.size());
+}
+
+/**
+ * @brief 修改内部结点第pos个分隔key
+ * @return 放不下时返回false，结点保持不变
+ */
+bool IxNodeHandle::set_child_key(int pos, const char *key) {
+    IxInnerEntries entries(file_hdr->col_tot_len_);
+    load_entries(&entries);
+    entries.set_key(pos, key);
+    return store_entries(entries, 0, entries.size());
 }
 
 /**
@@ -49,13 +197,12 @@ int IxNodeHandle::upper_bound(const char *target) const {
  * @return 目标key是否存在
  */
 bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
-    // Todo:
-    // 1. 在叶子节点中获取目标key所在位置
-    // 2. 判断目标key是否存在
-    // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
-    // 提示：可以调用lower_bound()和get_rid()函数。
-
-    return false;
+    int pos = lower_bound(key);
+    if (pos == get_size() || file_hdr->key_search_.compare(get_key(pos), key) != 0) {
+        return false;
+    }
+    *value = get_rid(pos);
+    return true;
 }
 
 /**
@@ -64,12 +211,8 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
  * @return page_id_t 目标key所在的孩子节点（子树）的存储页面编号
  */
 page_id_t IxNodeHandle::internal_lookup(const char *key) {
-    // Todo:
-    // 1. 查找当前非叶子节点中目标key所在孩子节点（子树）的位置
-    // 2. 获取该孩子节点（子树）所在页面的编号
-    // 3. 返回页面编号
-
-    return -1;
+    // 第i个key是第i个孩子子树中key的下界，第0个孩子同时接收所有更小的key
+    return value_at(upper_bound(key) - 1);
 }
 
 /**
@@ -87,12 +230,14 @@ page_id_t IxNodeHandle::internal_lookup(const char *key) {
  *                      key           key_slot
  */
 void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n) {
-    // Todo:
-    // 1. 判断pos的合法性
-    // 2. 通过key获取n个连续键值对的key值，并把n个key值插入到pos位置
-    // 3. 通过rid获取n个连续键值对的rid值，并把n个rid值插入到pos位置
-    // 4. 更新当前节点的键数量
-
+    int size = get_size();
+    assert(pos >= 0 && pos <= size && size + n <= get_max_size());
+    int key_len = file_hdr->col_tot_len_;
+    memmove(get_key(pos + n), get_key(pos), (size_t)(size - pos) * key_len);
+    memcpy(get_key(pos), key, (size_t)n * key_len);
+    memmove(get_rid(pos + n), get_rid(pos), (size - pos) * sizeof(Rid));
+    memcpy(get_rid(pos), rid, n * sizeof(Rid));
+    set_size(size + n);
 }
 
 /**
@@ -103,13 +248,12 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
  * @return int 键值对数量
  */
 int IxNodeHandle::insert(const char *key, const Rid &value) {
-    // Todo:
-    // 1. 查找要插入的键值对应该插入到当前节点的哪个位置
-    // 2. 如果key重复则不插入
-    // 3. 如果key不重复则插入键值对
-    // 4. 返回完成插入操作之后的键值对数量
-
-    return -1;
+    int pos = lower_bound(key);
+    if (pos < get_size() && file_hdr->key_search_.compare(get_key(pos), key) == 0) {
+        return get_size();
+    }
+    insert_pair(pos, key, value);
+    return get_size();
 }
 
 /**
@@ -118,11 +262,20 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
  * @param pos 要删除键值对的位置
  */
 void IxNodeHandle::erase_pair(int pos) {
-    // Todo:
-    // 1. 删除该位置的key
-    // 2. 删除该位置的rid
-    // 3. 更新结点的键值对数量
-
+    if (!page_hdr->is_leaf) {
+        // 删除一个key不会使公共前缀变短，一定放得下
+        IxInnerEntries entries(file_hdr->col_tot_len_);
+        load_entries(&entries);
+        entries.erase(pos);
+        store_entries(entries, 0, entries.size());
+        return;
+    }
+    int size = get_size();
+    assert(pos >= 0 && pos < size);
+    int key_len = file_hdr->col_tot_len_;
+    memmove(get_key(pos), get_key(pos + 1), (size_t)(size - pos - 1) * key_len);
+    memmove(get_rid(pos), get_rid(pos + 1), (size - pos - 1) * sizeof(Rid));
+    set_size(size - 1);
 }
 
 /**
@@ -132,27 +285,37 @@ void IxNodeHandle::erase_pair(int pos) {
  * @return 完成删除操作后的键值对数量
  */
 int IxNodeHandle::remove(const char *key) {
-    // Todo:
-    // 1. 查找要删除键值对的位置
-    // 2. 如果要删除的键值对存在，删除键值对
-    // 3. 返回完成删除操作后的键值对数量
-
-    return -1;
+    int pos = lower_bound(key);
+    if (pos < get_size() && file_hdr->key_search_.compare(get_key(pos), key) == 0) {
+        erase_pair(pos);
+    }
+    return get_size();
 }
 
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
     // init file_hdr_
-    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
     char* buf = new char[PAGE_SIZE];
     memset(buf, 0, PAGE_SIZE);
     disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
+    file_hdr_->key_codec_.init(file_hdr_->col_types_, file_hdr_->col_lens_);
+    file_hdr_->key_search_.init(file_hdr_->col_tot_len_);
+    root_page_no_ = file_hdr_->root_page_;
     
+    delete[] buf;
+
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
+
+    // 把Bloom过滤器的位图读入内存
+    bloom_.init(file_hdr_->bloom_pages_.size());
+    for (size_t i = 0; i < file_hdr_->bloom_pages_.size(); ++i) {
+        Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, file_hdr_->bloom_pages_[i]});
+        memcpy(bloom_.page_words(i), page->get_data(), PAGE_SIZE);
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
 }
 
 /**
@@ -166,16 +329,148 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
  */
 std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
                                                             Transaction *transaction, bool find_first) {
-    // Todo:
-    // 1. 获取根节点
-    // 2. 从根节点开始不断向下查找目标key
-    // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
+    if (operation == Operation::FIND) {
+        // 结点合并会回收页面，删除操作合并结点时独占structure_latch_，因此下降过程中共享持有它
+        std::shared_lock<std::shared_mutex> structure_lock(structure_latch_);
+        return std::make_pair(find_leaf_page_read(key, find_first), false);
+    }
+
+    root_latch_.lock();
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+
+    // 写操作：加写锁自上而下crabbing，所有加锁的结点放进事务的index_latch_page_set_
+    // 遇到安全结点（本次修改不会导致其分裂或合并）时，释放它的所有祖先结点，以及根结点的锁
+    bool root_is_latched = true;
+    node->page->wlatch();
+    if (is_safe(node, operation)) {
+        root_latch_.unlock();
+        root_is_latched = false;
+    }
+    transaction->append_index_latch_page_set(node->page);
+    while (!node->is_leaf_page()) {
+        IxNodeHandle *child = fetch_node(find_first ? node->value_at(0) : node->internal_lookup(key));
+        child->page->wlatch();
+        if (is_safe(child, operation)) {
+            release_latches(transaction, &root_is_latched);
+        }
+        transaction->append_index_latch_page_set(child->page);
+        delete node;
+        node = child;
+    }
+    return std::make_pair(node, root_is_latched);
+}
 
-    return std::make_pair(nullptr, false);
+/**
+ * @brief 读操作查找叶子结点（B-link）：任何时刻只持有一个结点的读锁，不加root_latch_，也不做latch coupling
+ * 释放父结点后孩子结点可能已经分裂，此时key不小于孩子结点的high key，沿右兄弟指针向右即可找到
+ * @return 加了读锁的叶子结点
+ * @note 调用者共享持有structure_latch_
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_page_read(const char *key, bool find_first) {
+    IxNodeHandle *node = fetch_node(root_page_no_);
+    node->page->rlatch();
+    while (true) {
+        page_id_t next_page_no;
+        if (!find_first && node->need_move_right(key)) {
+            next_page_no = node->get_right_sibling();
+        } else if (node->is_leaf_page()) {
+            break;
+        } else {
+            next_page_no = find_first ? node->value_at(0) : node->internal_lookup(key);
+        }
+        node->page->runlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        node = fetch_node(next_page_no);
+        node->page->rlatch();
+    }
+    return node;
+}
+
+/**
+ * @brief 乐观地查找叶子结点：内部结点只加读锁，只对叶子结点加写锁
+ * 大多数插入和删除只修改叶子结点，这样不会在根结点附近互相阻塞
+ *
+ * @return 加了写锁的叶子结点；如果叶子结点对本次操作不安全，返回nullptr，调用者需改用find_leaf_page()悲观地重试
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_page_optimistic(const char *key, Operation operation) {
+    root_latch_.lock();
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    // 持有父结点的读锁时，孩子结点不会被删除，读取is_leaf是安全的
+    if (node->is_leaf_page()) {
+        node->page->wlatch();
+    } else {
+        node->page->rlatch();
+    }
+    root_latch_.unlock();
+    while (!node->is_leaf_page()) {
+        IxNodeHandle *child = fetch_node(node->internal_lookup(key));
+        if (child->is_leaf_page()) {
+            child->page->wlatch();
+        } else {
+            child->page->rlatch();
+        }
+        node->page->runlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        node = child;
+    }
+    if (!is_safe(node, operation)) {
+        node->page->wunlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        return nullptr;
+    }
+    return node;
+}
+
+/**
+ * @brief 判断对node执行operation之后，是否可能引起node的分裂或合并（进而修改其父结点）
+ */
+bool IxIndexHandle::is_safe(IxNodeHandle *node, Operation operation) {
+    switch (operation) {
+        case Operation::INSERT:
+            if (!node->is_leaf_page()) {
+                return node->can_insert_child();
+            }
+            return node->get_size() + 1 < node->get_max_size();
+        case Operation::DELETE:
+            if (node->is_root_page()) {
+                // 根叶子结点删空也保留，根内部结点只剩一个孩子时需要换根
+                return node->is_leaf_page() || node->get_size() > 2;
+            }
+            return node->get_size() > node->get_min_size();
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief 释放事务在写操作中持有的所有结点写锁（以及根结点锁），并回收本次操作删除的结点
+ * 结点都是在加了写锁之后才被修改的，因此统一按脏页unpin
+ */
+void IxIndexHandle::release_latches(Transaction *transaction, bool *root_is_latched) {
+    if (*root_is_latched) {
+        root_latch_.unlock();
+        *root_is_latched = false;
+    }
+    auto latch_set = transaction->get_index_latch_page_set();
+    auto deleted_set = transaction->get_index_deleted_page_set();
+    for (Page *page : *latch_set) {
+        if (std::find(deleted_set->begin(), deleted_set->end(), page) != deleted_set->end()) {
+            IxNodeHandle node(file_hdr_, page);
+            release_node_handle(node);
+        }
+        page->wunlatch();
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+    }
+    latch_set->clear();
+    deleted_set->clear();
 }
 
 /**
  * @brief 用于查找指定键在叶子结点中的对应的值result
+ * 非唯一索引中key相同的键值对按rid排列在一起，用rid字段填全0和全0xff的两个key确定范围后扫描
  *
  * @param key 查找的目标key值
  * @param result 用于存放结果的容器
@@ -183,38 +478,136 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
  * @return bool 返回目标键值对是否存在
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
-    // Todo:
-    // 1. 获取目标key值所在的叶子结点
-    // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
-    // 3. 把rid存入result参数中
-    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
-
-    return false;
+    char encoded_key[IX_MAX_KEY_LEN];
+    encode_bound(key, 0, encoded_key);
+    key = encoded_key;
+    // Bloom过滤器排除的key不需要从根结点下降
+    if (bloom_.enabled() && !bloom_.may_contain(IxKeyCodec::hash(key, user_key_len()))) {
+        return false;
+    }
+    if (!is_unique()) {
+        char upper_key[IX_MAX_KEY_LEN];
+        memcpy(upper_key, key, user_key_len());
+        memset(upper_key + user_key_len(), 0xff, IX_RID_KEY_LEN);
+        size_t old_size = result->size();
+        for (IxScan scan(this, key, false, upper_key, false, buffer_pool_manager_); !scan.is_end(); scan.next()) {
+            result->push_back(scan.rid());
+        }
+        bool found = result->size() > old_size;
+        if (!found && bloom_.enabled()) {
+            bloom_.record_false_positive();
+        }
+        return found;
+    }
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, transaction).first;
+    Rid *rid;
+    bool found = leaf->leaf_lookup(key, &rid);
+    if (found) {
+        result->push_back(*rid);
+    } else if (bloom_.enabled()) {
+        bloom_.record_false_positive();
+    }
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return found;
 }
 
 /**
- * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
- * @param node 需要拆分的结点
+ * @brief  将传入的叶结点node拆分(Split)成两个结点，在node的右边生成一个新结点new node
+ * @param node 需要拆分的叶结点
+ * @param[out] separator 插入父结点的分隔key，经过后缀截断，长度为col_tot_len_
  * @return 拆分得到的new_node
  * @note need to unpin the new node outside
  * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
  */
-IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
-    // Todo:
-    // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
-    //    需要初始化新节点的page_hdr内容
-    // 2. 如果新的右兄弟结点是叶子结点，更新新旧节点的prev_leaf和next_leaf指针
-    //    为新节点分配键值对，更新旧节点的键值对数记录
-    // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
+IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node, char *separator) {
+    assert(node->is_leaf_page());
+    IxNodeHandle *new_node = create_node();
+    __atomic_fetch_add(&file_hdr_->num_leaves_, 1, __ATOMIC_RELAXED);
+    int pos = node->get_size() / 2;
+    int num_moved = node->get_size() - pos;
+    make_separator(node->get_key(pos - 1), node->get_key(pos), file_hdr_->col_tot_len_, separator);
+    *new_node->page_hdr = {.next_free_page_no = IX_NO_PAGE,
+                           .parent = node->get_parent_page_no(),
+                           .num_key = 0,
+                           .is_leaf = true,
+                           .has_high_key = false,
+                           .prev_leaf = IX_NO_PAGE,
+                           .next_leaf = IX_NO_PAGE};
+    new_node->insert_pairs(0, node->get_key(pos), node->get_rid(pos), num_moved);
+    // new_node继承node原来的high key，node的high key变为分隔key
+    // 先填好new_node再缩小node，无锁下降的读者在node上看到的范围始终能通过右兄弟指针到达
+    new_node->copy_high_key(node);
+    node->set_high_key(separator);
+    node->set_size(pos);
 
-    return nullptr;
+    // 叶子链表中new_node的后继结点可能属于另一棵子树，它的prev_leaf只会被持有其前驱结点写锁的线程修改
+    new_node->set_prev_leaf(node->get_page_no());
+    new_node->set_next_leaf(node->get_next_leaf());
+    IxNodeHandle *next = fetch_node(node->get_next_leaf());
+    next->set_prev_leaf(new_node->get_page_no());
+    buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    delete next;
+    node->set_next_leaf(new_node->get_page_no());
+    if (new_node->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+        std::lock_guard<std::mutex> lock(file_hdr_latch_);
+        file_hdr_->last_leaf_ = new_node->get_page_no();
+    }
+    return new_node;
+}
+
+/**
+ * @brief 把放不下的内部结点拆分成两个结点，在node的右边生成一个新结点new node
+ * @param node 需要拆分的内部结点
+ * @param entries node中原有的键值对加上新插入的键值对，整体放不下node
+ * @param[out] separator 插入父结点的分隔key，即new node的第一个key
+ * @return 拆分得到的new_node
+ * @note key的后缀长短不一，按照字节数而不是个数选择分裂点，使两个结点都放得下
+ */
+IxNodeHandle *IxIndexHandle::split_internal(IxNodeHandle *node, const IxInnerEntries &entries, char *separator) {
+    int n = entries.size();
+    int pos = -1;
+    for (int d = 0; pos == -1 && d < n; ++d) {
+        for (int candidate : {n / 2 - d, n / 2 + d}) {
+            if (candidate >= 1 && candidate < n &&
+                IxNodeHandle::entries_page_size(file_hdr_, entries, 0, candidate) <= PAGE_SIZE &&
+                IxNodeHandle::entries_page_size(file_hdr_, entries, candidate, n) <= PAGE_SIZE) {
+                pos = candidate;
+                break;
+            }
+        }
+    }
+    assert(pos != -1);
+
+    IxNodeHandle *new_node = create_node();
+    *new_node->page_hdr = {.next_free_page_no = IX_NO_PAGE,
+                           .parent = node->get_parent_page_no(),
+                           .num_key = 0,
+                           .is_leaf = false,
+                           .has_high_key = false,
+                           .prev_leaf = IX_NO_PAGE,
+                           .next_leaf = IX_NO_PAGE};
+    new_node->store_entries(entries, pos, n);
+    memcpy(separator, entries.key(pos), file_hdr_->col_tot_len_);
+    // 与叶结点的分裂相同，先填好new_node再缩小node
+    new_node->copy_high_key(node);
+    node->set_high_key(separator);
+    node->store_entries(entries, 0, pos);
+
+    new_node->set_right_sibling(node->get_right_sibling());
+    node->set_right_sibling(new_node->get_page_no());
+    for (int i = 0; i < new_node->get_size(); ++i) {
+        maintain_child(new_node, i);
+    }
+    return new_node;
 }
 
 /**
  * @brief Insert key & value pair into internal page after split
  * 拆分(Split)后，向上找到old_node的父结点
- * 将new_node的第一个key插入到父结点，其位置在 父结点指向old_node的孩子指针 之后
- * 如果插入后>=maxsize，则必须继续拆分父结点，然后在其父结点的父结点再插入，即需要递归
+ * 将分隔key插入到父结点，其位置在 父结点指向old_node的孩子指针 之后
+ * 如果插入后父结点放不下，则必须继续拆分父结点，然后在其父结点的父结点再插入，即需要递归
  * 直到找到的old_node为根结点时，结束递归（此时将会新建一个根R，关键字为key，old_node和new_node为其孩子）
  *
  * @param (old_node, new_node) 原结点为old_node，old_node被分裂之后产生了新的右兄弟结点new_node
@@ -225,43 +618,172 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
                                      Transaction *transaction) {
-    // Todo:
-    // 1. 分裂前的结点（原结点, old_node）是否为根结点，如果为根结点需要分配新的root
-    // 2. 获取原结点（old_node）的父亲结点
-    // 3. 获取key对应的rid，并将(key, rid)插入到父亲结点
-    // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
-    // 提示：记得unpin page
+    int key_len = file_hdr_->col_tot_len_;
+    if (old_node->is_root_page()) {
+        // 根结点分裂时调用者一定持有root_latch_
+        IxNodeHandle *new_root = create_node();
+        *new_root->page_hdr = {.next_free_page_no = IX_NO_PAGE,
+                               .parent = IX_NO_PAGE,
+                               .num_key = 0,
+                               .is_leaf = false,
+                               .has_high_key = false,
+                               .prev_leaf = IX_NO_PAGE,
+                               .next_leaf = IX_NO_PAGE};
+        IxInnerEntries entries(key_len);
+        std::vector<char> first_key(key_len);
+        old_node->copy_key(0, first_key.data());
+        entries.insert(0, first_key.data(), old_node->get_page_no());
+        entries.insert(1, key, new_node->get_page_no());
+        new_root->store_entries(entries, 0, entries.size());
+        old_node->set_parent_page_no(new_root->get_page_no());
+        new_node->set_parent_page_no(new_root->get_page_no());
+        update_root_page_no(new_root->get_page_no());
+        file_hdr_->height_++;
+        buffer_pool_manager_->unpin_page(new_root->get_page_id(), true);
+        delete new_root;
+        return;
+    }
+
+    // 父结点不安全，已经在悲观下降时加了写锁，这里只是再pin一次
+    IxNodeHandle *parent = fetch_node(old_node->get_parent_page_no());
+    int rank = parent->find_child(old_node);
+    new_node->set_parent_page_no(parent->get_page_no());
+    IxInnerEntries entries(key_len);
+    parent->load_entries(&entries);
+    entries.insert(rank + 1, key, new_node->get_page_no());
+    if (!parent->store_entries(entries, 0, entries.size())) {
+        std::vector<char> separator(key_len);
+        IxNodeHandle *new_parent = split_internal(parent, entries, separator.data());
+        insert_into_parent(parent, separator.data(), new_parent, transaction);
+        buffer_pool_manager_->unpin_page(new_parent->get_page_id(), true);
+        delete new_parent;
+    }
+    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+    delete parent;
 }
 
 /**
  * @brief 将指定键值对插入到B+树中
  * @param (key, value) 要插入的键值对
  * @param transaction 事务指针
- * @return page_id_t 插入到的叶结点的page_no
+ * @return page_id_t 插入到的叶结点的page_no，key已经存在（非唯一索引中为key和rid都相同）时返回IX_NO_PAGE
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
-    // Todo:
-    // 1. 查找key值应该插入到哪个叶子节点
-    // 2. 在该叶子节点中插入键值对
-    // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
+    char encoded_key[IX_MAX_KEY_LEN];
+    encode_key(key, value, encoded_key);
+    key = encoded_key;
+    // 先写Bloom过滤器再插入B+树，并发的查找在B+树中看到key时过滤器一定已经包含它
+    if (bloom_.enabled()) {
+        bloom_add(key);
+    }
+    // 1. 乐观插入：叶子结点插入后不会分裂时，只需要叶子结点的写锁
+    IxNodeHandle *leaf = find_leaf_page_optimistic(key, Operation::INSERT);
+    if (leaf != nullptr) {
+        int old_size = leaf->get_size();
+        bool inserted = leaf->insert(key, value) != old_size;
+        if (inserted) {
+            __atomic_fetch_add(&file_hdr_->num_entries_, 1, __ATOMIC_RELAXED);
+        }
+        page_id_t page_no = inserted ? leaf->get_page_no() : IX_NO_PAGE;
+        leaf->page->wunlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), inserted);
+        delete leaf;
+        return page_no;
+    }
 
-    return -1;
+    // 2. 悲观插入：从根结点开始加写锁，可能分裂的结点一直持有写锁直到插入完成
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    auto [node, root_is_latched] = find_leaf_page(key, Operation::INSERT, transaction);
+    int old_size = node->get_size();
+    page_id_t page_no = IX_NO_PAGE;
+    if (node->insert(key, value) != old_size) {
+        __atomic_fetch_add(&file_hdr_->num_entries_, 1, __ATOMIC_RELAXED);
+        page_no = node->get_page_no();
+        if (node->get_size() == node->get_max_size()) {
+            std::vector<char> separator(file_hdr_->col_tot_len_);
+            IxNodeHandle *new_node = split(node, separator.data());
+            insert_into_parent(node, separator.data(), new_node, transaction);
+            if (file_hdr_->key_search_.compare(key, new_node->get_key(0)) >= 0) {
+                page_no = new_node->get_page_no();
+            }
+            buffer_pool_manager_->unpin_page(new_node->get_page_id(), true);
+            delete new_node;
+        }
+    }
+    release_latches(transaction, &root_is_latched);
+    delete node;
+    return page_no;
 }
 
 /**
- * @brief 用于删除B+树中含有指定key的键值对
+ * @brief 用于删除B+树中含有指定key的键值对，非唯一索引中key不能确定键值对，要用带rid的重载
  * @param key 要删除的key值
  * @param transaction 事务指针
  */
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
-    // Todo:
-    // 1. 获取该键值对所在的叶子结点
-    // 2. 在该叶子结点中删除键值对
-    // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
-    // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
+    if (!is_unique()) {
+        throw InternalError("IxIndexHandle::delete_entry: a non-unique index needs the rid of the entry");
+    }
+    char encoded_key[IX_MAX_KEY_LEN];
+    encode_key(key, Rid{}, encoded_key);
+    return delete_encoded(encoded_key, transaction);
+}
 
-    return false;
+/**
+ * @brief 删除key指向rid的键值对：非唯一索引中直接删除(key, rid)，唯一索引中只有key指向的正是rid时才删除
+ * @param key 要删除的key值
+ * @param rid 键值对中的rid
+ * @param transaction 事务指针
+ */
+bool IxIndexHandle::delete_entry(const char *key, const Rid &rid, Transaction *transaction) {
+    if (is_unique()) {
+        std::vector<Rid> found;
+        return get_value(key, &found, transaction) && found[0] == rid && delete_entry(key, transaction);
+    }
+    char encoded_key[IX_MAX_KEY_LEN];
+    encode_key(key, rid, encoded_key);
+    return delete_encoded(encoded_key, transaction);
+}
+
+/**
+ * @brief 删除编码后的key对应的键值对
+ */
+bool IxIndexHandle::delete_encoded(const char *key, Transaction *transaction) {
+    // 1. 乐观删除：叶子结点删除后不会低于半满时，只需要叶子结点的写锁
+    IxNodeHandle *leaf = find_leaf_page_optimistic(key, Operation::DELETE);
+    if (leaf != nullptr) {
+        int old_size = leaf->get_size();
+        bool deleted = leaf->remove(key) != old_size;
+        if (deleted) {
+            __atomic_fetch_sub(&file_hdr_->num_entries_, 1, __ATOMIC_RELAXED);
+        }
+        leaf->page->wunlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), deleted);
+        delete leaf;
+        return deleted;
+    }
+
+    // 2. 悲观删除，被合并掉的结点记录在事务的index_deleted_page_set_中，释放写锁时回收
+    // 合并会回收页面，先等待正在无锁下降的读操作结束
+    std::unique_lock<std::shared_mutex> structure_lock(structure_latch_);
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    auto [node, root_is_latched] = find_leaf_page(key, Operation::DELETE, transaction);
+    int old_size = node->get_size();
+    bool deleted = node->remove(key) != old_size;
+    if (deleted) {
+        __atomic_fetch_sub(&file_hdr_->num_entries_, 1, __ATOMIC_RELAXED);
+        coalesce_or_redistribute(node, transaction, &root_is_latched);
+    }
+    structure_version_++;
+    release_latches(transaction, &root_is_latched);
+    delete node;
+    return deleted;
 }
 
 /**
@@ -276,17 +798,36 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
  * Otherwise, merge(Coalesce).
  */
 bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 判断node结点是否为根节点
-    //    1.1 如果是根节点，需要调用AdjustRoot() 函数来进行处理，返回根节点是否需要被删除
-    //    1.2 如果不是根节点，并且不需要执行合并或重分配操作，则直接返回false，否则执行2
-    // 2. 获取node结点的父亲结点
-    // 3. 寻找node结点的兄弟结点（优先选取前驱结点）
-    // 4. 如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点（即node.size+neighbor.size >=
-    // NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
-    // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
+    if (node->is_root_page()) {
+        bool root_deleted = adjust_root(node);
+        if (root_deleted) {
+            transaction->append_index_deleted_page(node->page);
+        }
+        return root_deleted;
+    }
+    if (node->get_size() >= node->get_min_size()) {
+        return false;
+    }
 
-    return false;
+    // 父结点已经在悲观下降时加了写锁；兄弟结点只能经由父结点到达，此时加写锁不会死锁
+    IxNodeHandle *parent = fetch_node(node->get_parent_page_no());
+    int index = parent->find_child(node);
+    IxNodeHandle *neighbor = fetch_node(parent->value_at(index == 0 ? 1 : index - 1));
+    IxNodeHandle *neighbor_handle = neighbor;
+    neighbor->page->wlatch();
+    transaction->append_index_latch_page_set(neighbor->page);
+
+    bool node_deleted = false;
+    if (node->get_size() + neighbor->get_size() >= node->get_min_size() * 2) {
+        redistribute(neighbor, node, parent, index);
+    } else {
+        coalesce(&neighbor, &node, &parent, index, transaction, root_is_latched);
+        node_deleted = true;
+    }
+    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+    delete parent;
+    delete neighbor_handle;
+    return node_deleted;
 }
 
 /**
@@ -296,11 +837,16 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
  * @note size of root page can be less than min size and this method is only called within coalesce_or_redistribute()
  */
 bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
-    // Todo:
-    // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
-    // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
-    // 3. 除了上述两种情况，不需要进行操作
-
+    if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {
+        IxNodeHandle *child = fetch_node(old_root_node->value_at(0));
+        child->set_parent_page_no(IX_NO_PAGE);
+        update_root_page_no(child->get_page_no());
+        file_hdr_->height_--;
+        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
+        return true;
+    }
+    // 根结点是叶结点时，即使删空也保留，空树始终是一个空的根叶子结点
     return false;
 }
 
@@ -319,11 +865,43 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
  * 注意更新parent结点的相关kv对
  */
 void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index) {
-    // Todo:
-    // 1. 通过index判断neighbor_node是否为node的前驱结点
-    // 2. 从neighbor_node中移动一个键值对到node结点中
-    // 3. 更新父节点中的相关信息，并且修改移动键值对对应孩字结点的父结点信息（maintain_child函数）
-    // 注意：neighbor_node的位置不同，需要移动的键值对不同，需要分类讨论
+    // 移动之后右边结点的第一个key成为新的分隔key：index>0时为neighbor的最后一个key，否则为neighbor的第二个key
+    // 内部结点的key是压缩存放的，新的分隔key可能使父结点放不下，此时不做调整，node暂时保持不足半满
+    std::vector<char> separator(file_hdr_->col_tot_len_);
+    neighbor_node->copy_key(index > 0 ? neighbor_node->get_size() - 1 : 1, separator.data());
+    if (!parent->set_child_key(index > 0 ? index : 1, separator.data())) {
+        return;
+    }
+    if (node->is_leaf_page()) {
+        if (index > 0) {
+            // neighbor(left) node(right)：把neighbor的最后一个键值对移到node的开头
+            int last = neighbor_node->get_size() - 1;
+            node->insert_pair(0, neighbor_node->get_key(last), *neighbor_node->get_rid(last));
+            neighbor_node->erase_pair(last);
+        } else {
+            // node(left) neighbor(right)：把neighbor的第一个键值对移到node的末尾
+            node->insert_pair(node->get_size(), neighbor_node->get_key(0), *neighbor_node->get_rid(0));
+            neighbor_node->erase_pair(0);
+        }
+    } else {
+        // 移动一个键值对后，node不足btree_order_个键值对，neighbor的key只会减少，两个结点都一定放得下
+        IxInnerEntries node_entries(file_hdr_->col_tot_len_);
+        IxInnerEntries neighbor_entries(file_hdr_->col_tot_len_);
+        node->load_entries(&node_entries);
+        neighbor_node->load_entries(&neighbor_entries);
+        int from = index > 0 ? neighbor_entries.size() - 1 : 0;
+        node_entries.insert(index > 0 ? 0 : node_entries.size(), neighbor_entries.key(from),
+                            neighbor_entries.child(from));
+        neighbor_entries.erase(from);
+        node->store_entries(node_entries, 0, node_entries.size());
+        neighbor_node->store_entries(neighbor_entries, 0, neighbor_entries.size());
+        maintain_child(node, index > 0 ? 0 : node->get_size() - 1);
+    }
+    if (index > 0) {
+        neighbor_node->set_high_key(separator.data());
+    } else {
+        node->set_high_key(separator.data());
+    }
 }
 
 /**
@@ -342,13 +920,292 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
  */
 bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                              Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 用index判断neighbor_node是否为node的前驱结点，若不是则交换两个结点，让neighbor_node作为左结点，node作为右结点
-    // 2. 把node结点的键值对移动到neighbor_node中，并更新node结点孩子结点的父节点信息（调用maintain_child函数）
-    // 3. 释放和删除node结点，并删除parent中node结点的信息，返回parent是否需要被删除
-    // 提示：如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
+    if (index == 0) {
+        std::swap(*neighbor_node, *node);
+        index = 1;
+    }
+    IxNodeHandle *left = *neighbor_node;
+    IxNodeHandle *right = *node;
 
-    return false;
+    int pos = left->get_size();
+    if (left->is_leaf_page()) {
+        left->insert_pairs(pos, right->get_key(0), right->get_rid(0), right->get_size());
+    } else {
+        // 两个结点合起来不足btree_order_个键值对，即使不压缩也放得下
+        IxInnerEntries left_entries(file_hdr_->col_tot_len_);
+        IxInnerEntries right_entries(file_hdr_->col_tot_len_);
+        left->load_entries(&left_entries);
+        right->load_entries(&right_entries);
+        left_entries.append(right_entries);
+        bool stored = left->store_entries(left_entries, 0, left_entries.size());
+        assert(stored);
+        (void)stored;
+    }
+    for (int i = pos; i < left->get_size(); ++i) {
+        maintain_child(left, i);
+    }
+    left->copy_high_key(right);
+    if (!right->is_leaf_page()) {
+        left->set_right_sibling(right->get_right_sibling());
+    } else {
+        if (right->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+            std::lock_guard<std::mutex> lock(file_hdr_latch_);
+            file_hdr_->last_leaf_ = left->get_page_no();
+        }
+        erase_leaf(right);
+        __atomic_fetch_sub(&file_hdr_->num_leaves_, 1, __ATOMIC_RELAXED);
+    }
+    // right已经在事务的index_latch_page_set_中，释放写锁时再回收
+    transaction->append_index_deleted_page(right->page);
+
+    (*parent)->erase_pair(index);
+    return coalesce_or_redistribute(*parent, transaction, root_is_latched);
+}
+
+/**
+ * @brief 自底向上批量构建B+树，用于向空索引中批量导入已排好序的键值对，由IxBulkBuilder完成
+ *
+ * @param keys 连续存放的num_keys个key，每个key长度为user_key_len()，必须按ix_compare升序排列，
+ * 非唯一索引中key相同的键值对按rid升序排列
+ * @param rids 与keys一一对应的rid
+ * @param num_keys 键值对数量
+ * @param fill_factor 填充因子（百分比）
+ * @note 如果索引非空，则退化为逐条调用insert_entry()
+ */
+void IxIndexHandle::bulk_load(const char *keys, const Rid *rids, int num_keys, int fill_factor) {
+    if (num_keys == 0) {
+        return;
+    }
+    int key_len = user_key_len();
+
+    IxNodeHandle *root = fetch_node(file_hdr_->root_page_);
+    bool is_empty_tree = root->is_leaf_page() && root->get_size() == 0;
+    buffer_pool_manager_->unpin_page(root->get_page_id(), false);
+    delete root;
+    if (!is_empty_tree) {
+        for (int i = 0; i < num_keys; ++i) {
+            insert_entry(keys + (size_t)i * key_len, rids[i], nullptr);
+        }
+        return;
+    }
+
+    IxBulkBuilder builder(this, fill_factor);
+    char encoded_key[IX_MAX_KEY_LEN];
+    for (int i = 0; i < num_keys; ++i) {
+        encode_key(keys + (size_t)i * key_len, rids[i], encoded_key);
+        builder.append(encoded_key, rids[i]);
+    }
+    builder.finish();
+}
+
+IxBulkBuilder::IxBulkBuilder(IxIndexHandle *ih, int fill_factor)
+    : ih_(ih), key_len_(ih->file_hdr_->col_tot_len_), root_guard_(ih->root_latch_), last_key_(key_len_),
+      distinct_prefixes_(ih->file_hdr_->col_num_, 0) {
+    int btree_order = ih_->file_hdr_->btree_order_;
+    int min_size = (btree_order + 1) / 2;
+    leaf_capacity_ = std::max(min_size, btree_order * fill_factor / 100);
+    inner_page_limit_ = PAGE_SIZE * fill_factor / 100;
+}
+
+IxBulkBuilder::~IxBulkBuilder() {
+    if (prev_leaf_ != nullptr) {
+        ih_->buffer_pool_manager_->unpin_page(prev_leaf_->get_page_id(), true);
+        delete prev_leaf_;
+    }
+}
+
+bool IxBulkBuilder::append(const char *key, const Rid &rid) {
+    if (has_last_key_) {
+        int res = memcmp(key, last_key_.data(), key_len_);
+        assert(res >= 0);
+        if (res == 0) {
+            return false;
+        }
+    }
+    // 与上一个key第一个不同的字节之后结束的前缀都是新的取值
+    int diff = 0;
+    if (has_last_key_) {
+        while (key[diff] == last_key_[diff]) {
+            ++diff;
+        }
+    }
+    int prefix_end = 0;
+    for (int i = 0; i < ih_->file_hdr_->col_num_; ++i) {
+        prefix_end += ih_->file_hdr_->col_lens_[i];
+        if (diff < prefix_end) {
+            distinct_prefixes_[i]++;
+        }
+    }
+    memcpy(last_key_.data(), key, key_len_);
+    has_last_key_ = true;
+    // 过滤器中只放不含rid字段的key，非唯一索引中重复的key只加一次
+    int user_key_len = ih_->user_key_len();
+    if (ih_->bloom_.enabled() && diff < user_key_len) {
+        bloom_hashes_.push_back(IxKeyCodec::hash(key, user_key_len));
+    }
+    pending_keys_.insert(pending_keys_.end(), key, key + key_len_);
+    pending_rids_.push_back(rid);
+    num_entries_++;
+    // 至少攒够两个叶结点的键值对才写出一个，使最后剩下的键值对足够分成不小于min_size的一到两个叶结点
+    if ((int)pending_rids_.size() == 2 * leaf_capacity_) {
+        write_leaf(leaf_capacity_);
+    }
+    return true;
+}
+
+/**
+ * @description: 把pending_keys_中前size个键值对写成一个新的叶结点，第一个叶结点复用初始的根结点页面
+ */
+void IxBulkBuilder::write_leaf(int size) {
+    bool is_first = prev_leaf_ == nullptr;
+    IxNodeHandle *leaf = is_first ? ih_->fetch_node(ih_->file_hdr_->root_page_) : ih_->create_node();
+    *leaf->page_hdr = {.next_free_page_no = IX_NO_PAGE,
+                       .parent = IX_NO_PAGE,
+                       .num_key = size,
+                       .is_leaf = true,
+                       .has_high_key = false,
+                       .prev_leaf = is_first ? IX_LEAF_HEADER_PAGE : prev_leaf_->get_page_no(),
+                       .next_leaf = IX_LEAF_HEADER_PAGE};
+    memcpy(leaf->keys, pending_keys_.data(), (size_t)size * key_len_);
+    memcpy(leaf->rids, pending_rids_.data(), size * sizeof(Rid));
+    pending_keys_.erase(pending_keys_.begin(), pending_keys_.begin() + (size_t)size * key_len_);
+    pending_rids_.erase(pending_rids_.begin(), pending_rids_.begin() + size);
+
+    size_t offset = level_keys_.size();
+    level_keys_.resize(offset + key_len_);
+    char *separator = level_keys_.data() + offset;
+    if (is_first) {
+        memcpy(separator, leaf->get_key(0), key_len_);
+        ih_->file_hdr_->first_leaf_ = leaf->get_page_no();
+    } else {
+        make_separator(prev_leaf_->get_key(prev_leaf_->get_size() - 1), leaf->get_key(0), key_len_, separator);
+        prev_leaf_->set_next_leaf(leaf->get_page_no());
+        prev_leaf_->set_high_key(separator);
+        ih_->buffer_pool_manager_->unpin_page(prev_leaf_->get_page_id(), true);
+        delete prev_leaf_;
+    }
+    level_pages_.push_back(leaf->get_page_no());
+    prev_leaf_ = leaf;
+    num_leaves_++;
+}
+
+/**
+ * @description: 剩下的键值对超过一个叶结点的容量时平均分成两个叶结点，否则写成一个，然后构建内部结点
+ */
+void IxBulkBuilder::finish() {
+    if (ih_->bloom_.enabled()) {
+        ih_->rebuild_bloom(bloom_hashes_);
+    }
+    int size = pending_rids_.size();
+    if (size > 0) {
+        int btree_order = ih_->file_hdr_->btree_order_;
+        int min_size = (btree_order + 1) / 2;
+        if (size <= leaf_capacity_ || (size <= btree_order && size / 2 < min_size)) {
+            write_leaf(size);
+        } else {
+            write_leaf(size / 2);
+            write_leaf(size - size / 2);
+        }
+    }
+    if (prev_leaf_ == nullptr) {
+        return;
+    }
+    IxFileHdr *file_hdr = ih_->file_hdr_;
+    file_hdr->last_leaf_ = prev_leaf_->get_page_no();
+    ih_->buffer_pool_manager_->unpin_page(prev_leaf_->get_page_id(), true);
+    delete prev_leaf_;
+    prev_leaf_ = nullptr;
+
+    IxNodeHandle *leaf_header = ih_->fetch_node(IX_LEAF_HEADER_PAGE);
+    leaf_header->set_next_leaf(file_hdr->first_leaf_);
+    leaf_header->set_prev_leaf(file_hdr->last_leaf_);
+    ih_->buffer_pool_manager_->unpin_page(leaf_header->get_page_id(), true);
+    delete leaf_header;
+
+    file_hdr->height_ = build_inner_levels();
+    file_hdr->num_entries_ = num_entries_;
+    file_hdr->num_leaves_ = num_leaves_;
+    file_hdr->distinct_prefixes_ = distinct_prefixes_;
+    file_hdr->distinct_entries_ = num_entries_;
+}
+
+/**
+ * @description: 逐层向上构建内部结点，直到只剩一个结点作为根结点
+ * 每个结点贪心地装入孩子，直到占用的字节数超过inner_page_limit_；一层中最后一个结点的孩子太少时，和前一个结点平分
+ * @return 树高
+ */
+int IxBulkBuilder::build_inner_levels() {
+    const IxFileHdr *file_hdr = ih_->file_hdr_;
+    int min_size = (file_hdr->btree_order_ + 1) / 2;
+    int height = 1;
+    IxInnerEntries level(key_len_);
+    while (level_pages_.size() > 1) {
+        height++;
+        level.clear();
+        for (size_t i = 0; i < level_pages_.size(); ++i) {
+            level.insert(level.size(), level_keys_.data() + i * key_len_, level_pages_[i]);
+        }
+        int num_children = level.size();
+
+        // 1. 划分每个结点的孩子范围[bounds[i], bounds[i+1])
+        std::vector<int> bounds{0};
+        while (bounds.back() < num_children) {
+            int begin = bounds.back();
+            int end = begin + 1;
+            while (end < num_children &&
+                   (end - begin < 2 ||
+                    IxNodeHandle::entries_page_size(file_hdr, level, begin, end + 1) <= inner_page_limit_)) {
+                ++end;
+            }
+            bounds.push_back(end);
+        }
+        size_t num_nodes = bounds.size() - 1;
+        if (num_nodes > 1 && bounds[num_nodes] - bounds[num_nodes - 1] < min_size) {
+            int begin = bounds[num_nodes - 2], end = bounds[num_nodes];
+            int mid = (begin + end) / 2;
+            if (IxNodeHandle::entries_page_size(file_hdr, level, begin, mid) <= PAGE_SIZE &&
+                IxNodeHandle::entries_page_size(file_hdr, level, mid, end) <= PAGE_SIZE) {
+                bounds[num_nodes - 1] = mid;
+            }
+        }
+
+        // 2. 写出这一层的结点
+        std::vector<page_id_t> upper_pages;
+        std::vector<char> upper_keys;
+        IxNodeHandle *prev_node = nullptr;
+        for (size_t i = 0; i < num_nodes; ++i) {
+            IxNodeHandle *node = ih_->create_node();
+            *node->page_hdr = {.next_free_page_no = IX_NO_PAGE,
+                               .parent = IX_NO_PAGE,
+                               .num_key = 0,
+                               .is_leaf = false,
+                               .has_high_key = false,
+                               .prev_leaf = IX_NO_PAGE,
+                               .next_leaf = IX_NO_PAGE};
+            bool stored = node->store_entries(level, bounds[i], bounds[i + 1]);
+            assert(stored);
+            (void)stored;
+            for (int j = 0; j < node->get_size(); ++j) {
+                ih_->maintain_child(node, j);
+            }
+            const char *low_key = level.key(bounds[i]);
+            if (prev_node != nullptr) {
+                prev_node->set_right_sibling(node->get_page_no());
+                prev_node->set_high_key(low_key);
+                ih_->buffer_pool_manager_->unpin_page(prev_node->get_page_id(), true);
+                delete prev_node;
+            }
+            upper_pages.push_back(node->get_page_no());
+            upper_keys.insert(upper_keys.end(), low_key, low_key + key_len_);
+            prev_node = node;
+        }
+        ih_->buffer_pool_manager_->unpin_page(prev_node->get_page_id(), true);
+        delete prev_node;
+        level_pages_.swap(upper_pages);
+        level_keys_.swap(upper_keys);
+    }
+    ih_->update_root_page_no(level_pages_.front());
+    return height;
 }
 
 /**
@@ -363,10 +1220,33 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
     IxNodeHandle *node = fetch_node(iid.page_no);
     if (iid.slot_no >= node->get_size()) {
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
         throw IndexEntryNotFoundError();
     }
+    Rid rid = *node->get_rid(iid.slot_no);
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    delete node;
+    return rid;
+}
+
+/**
+ * @brief 取出iid处的rid和解码后的key
+ *
+ * @param key 用于存放原始格式的key，长度为user_key_len()
+ */
+Rid IxIndexHandle::get_entry(const Iid &iid, char *key) const {
+    IxNodeHandle *node = fetch_node(iid.page_no);
+    if (iid.slot_no >= node->get_size()) {
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        throw IndexEntryNotFoundError();
+    }
+    file_hdr_->key_codec_.decode(node->get_key(iid.slot_no), key, user_col_num());
+    Rid rid = *node->get_rid(iid.slot_no);
+    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    delete node;
+    return rid;
 }
 
 /**
@@ -378,8 +1258,26 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
+    char encoded_key[IX_MAX_KEY_LEN];
+    encode_bound(key, 0, encoded_key);
+    return lower_bound_encoded(encoded_key);
+}
 
-    return Iid{-1, -1};
+/**
+ * @brief 同lower_bound()，key是编码后的
+ */
+Iid IxIndexHandle::lower_bound_encoded(const char *key) {
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    int pos = leaf->lower_bound(key);
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = pos};
+    if (pos == leaf->get_size() && leaf->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        // 叶子结点中的key都小于目标key，下一个叶子结点的第一个key就是所求
+        iid = {.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return iid;
 }
 
 /**
@@ -389,8 +1287,30 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    
-    return Iid{-1, -1};
+    char encoded_key[IX_MAX_KEY_LEN];
+    encode_bound(key, static_cast<char>(0xff), encoded_key);
+    return upper_bound_encoded(encoded_key);
+}
+
+/**
+ * @brief 同upper_bound()，key是编码后的
+ */
+Iid IxIndexHandle::upper_bound_encoded(const char *key) {
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    // 索引中的key不重复，跳过与目标key相等的那一项即可
+    int pos = leaf->lower_bound(key);
+    if (pos < leaf->get_size() &&
+        file_hdr_->key_search_.compare(leaf->get_key(pos), key) == 0) {
+        ++pos;
+    }
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = pos};
+    if (pos == leaf->get_size() && leaf->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        iid = {.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return iid;
 }
 
 /**
@@ -403,6 +1323,7 @@ Iid IxIndexHandle::leaf_end() const {
     IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
     Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
+    delete node;
     return iid;
 }
 
@@ -417,6 +1338,104 @@ Iid IxIndexHandle::leaf_begin() const {
     return iid;
 }
 
+/**
+ * @description: 返回索引的统计信息。键值对数量、叶结点数量和树高是增量维护的准确值；
+ * 各前缀的不同取值个数按上次计算时与当前的键值对数量之比缩放，完整的key不重复，其取值个数就是键值对数量
+ */
+IxIndexStats IxIndexHandle::get_stats() const {
+    IxIndexStats stats;
+    stats.num_entries = __atomic_load_n(&file_hdr_->num_entries_, __ATOMIC_RELAXED);
+    stats.num_leaves = __atomic_load_n(&file_hdr_->num_leaves_, __ATOMIC_RELAXED);
+    stats.height = file_hdr_->height_;
+    stats.num_pages = file_hdr_->num_pages_;
+    if (stats.num_leaves > 0) {
+        stats.avg_fill = (double)stats.num_entries / ((double)stats.num_leaves * file_hdr_->btree_order_);
+    }
+    int64_t n = stats.num_entries;
+    // 非唯一索引附加的rid字段不对外报告
+    for (int i = 0; i < user_col_num(); ++i) {
+        int64_t distinct = file_hdr_->distinct_prefixes_[i];
+        if (file_hdr_->distinct_entries_ > 0 && file_hdr_->distinct_entries_ != n) {
+            distinct = std::llround((double)distinct * n / file_hdr_->distinct_entries_);
+        }
+        if (i == file_hdr_->col_num_ - 1) {
+            distinct = n;
+        }
+        stats.distinct_prefixes.push_back(std::min(std::max<int64_t>(distinct, n > 0 ? 1 : 0), n));
+    }
+    return stats;
+}
+
+/**
+ * @description: 顺着叶结点链表扫描整棵树，重新计算所有统计信息，纠正增量维护中前缀取值个数的误差
+ * 扫描期间共享持有structure_latch_，叶结点不会被回收，同时会阻塞需要合并结点的删除，只在REINDEX中调用
+ */
+void IxIndexHandle::refresh_stats() {
+    std::shared_lock<std::shared_mutex> structure_lock(structure_latch_);
+    int key_len = file_hdr_->col_tot_len_;
+    std::vector<int64_t> distinct(file_hdr_->col_num_, 0);
+    std::vector<char> last_key(key_len);
+    bool has_last_key = false;
+    int64_t num_entries = 0;
+    int num_leaves = 0;
+
+    IxNodeHandle *leaf_header = fetch_node(IX_LEAF_HEADER_PAGE);
+    page_id_t page_no = leaf_header->get_next_leaf();
+    buffer_pool_manager_->unpin_page(leaf_header->get_page_id(), false);
+    delete leaf_header;
+    while (page_no != IX_LEAF_HEADER_PAGE) {
+        IxNodeHandle *leaf = fetch_node(page_no);
+        leaf->page->rlatch();
+        for (int i = 0; i < leaf->get_size(); ++i) {
+            const char *key = leaf->get_key(i);
+            int diff = 0;
+            if (has_last_key) {
+                while (diff < key_len && key[diff] == last_key[diff]) {
+                    ++diff;
+                }
+            }
+            int prefix_end = 0;
+            for (int j = 0; j < file_hdr_->col_num_; ++j) {
+                prefix_end += file_hdr_->col_lens_[j];
+                if (diff < prefix_end) {
+                    distinct[j]++;
+                }
+            }
+            memcpy(last_key.data(), key, key_len);
+            has_last_key = true;
+        }
+        num_entries += leaf->get_size();
+        num_leaves++;
+        page_no = leaf->get_next_leaf();
+        leaf->page->runlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
+
+    // 沿最左边的路径下降得到树高
+    int height = 1;
+    IxNodeHandle *node = fetch_node(root_page_no_);
+    while (true) {
+        node->page->rlatch();
+        bool is_leaf = node->is_leaf_page();
+        page_id_t child = is_leaf ? IX_NO_PAGE : node->value_at(0);
+        node->page->runlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        if (is_leaf) {
+            break;
+        }
+        node = fetch_node(child);
+        height++;
+    }
+
+    __atomic_store_n(&file_hdr_->num_entries_, num_entries, __ATOMIC_RELAXED);
+    __atomic_store_n(&file_hdr_->num_leaves_, num_leaves, __ATOMIC_RELAXED);
+    file_hdr_->height_ = height;
+    file_hdr_->distinct_prefixes_ = distinct;
+    file_hdr_->distinct_entries_ = num_entries;
+}
+
 /**
  * @brief 获取一个指定结点
  *
@@ -443,6 +1462,13 @@ IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
  */
 IxNodeHandle *IxIndexHandle::create_node() {
     IxNodeHandle *node;
+    std::lock_guard<std::mutex> lock(file_hdr_latch_);
+    if (file_hdr_->first_free_page_no_ != IX_NO_PAGE) {
+        // 优先复用被删除的页面
+        node = fetch_node(file_hdr_->first_free_page_no_);
+        file_hdr_->first_free_page_no_ = node->page_hdr->next_free_page_no;
+        return node;
+    }
     file_hdr_->num_pages_++;
 
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
@@ -453,26 +1479,67 @@ IxNodeHandle *IxIndexHandle::create_node() {
 }
 
 /**
- * @brief 从node开始更新其父节点的第一个key，一直向上更新直到根节点
- *
- * @param node
+ * @description: 非唯一索引先把key和rid拼成完整的原始key再编码，编码按字段进行，编码后的前user_key_len()个字节就是key本身的编码
  */
-void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
-    IxNodeHandle *curr = node;
-    while (curr->get_parent_page_no() != IX_NO_PAGE) {
-        // Load its parent
-        IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
-        int rank = parent->find_child(curr);
-        char *parent_key = parent->get_key(rank);
-        char *child_first_key = curr->get_key(0);
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-            break;
-        }
-        memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
-        curr = parent;
+void IxIndexHandle::encode_key(const char *key, const Rid &rid, char *dest) const {
+    if (is_unique()) {
+        file_hdr_->key_codec_.encode(key, dest);
+        return;
+    }
+    char raw_key[IX_MAX_KEY_LEN];
+    int key_len = user_key_len();
+    memcpy(raw_key, key, key_len);
+    memcpy(raw_key + key_len, &rid.page_no, sizeof(int));
+    memcpy(raw_key + key_len + sizeof(int), &rid.slot_no, sizeof(int));
+    file_hdr_->key_codec_.encode(raw_key, dest);
+}
 
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+void IxIndexHandle::encode_bound(const char *key, char fill, char *dest) const {
+    encode_key(key, Rid{}, dest);
+    memset(dest + user_key_len(), fill, file_hdr_->col_tot_len_ - user_key_len());
+}
+
+/**
+ * @description: 把编码后的key加入Bloom过滤器，内存副本中已经包含它时不访问页面
+ */
+void IxIndexHandle::bloom_add(const char *key) {
+    uint64_t hash = IxKeyCodec::hash(key, user_key_len());
+    if (!bloom_.add(hash)) {
+        return;
+    }
+    size_t block = bloom_.block_of(hash);
+    Page *page = buffer_pool_manager_->fetch_page(
+        PageId{fd_, file_hdr_->bloom_pages_[block / IxBloomFilter::BLOCKS_PER_PAGE]});
+    uint64_t *words = reinterpret_cast<uint64_t *>(page->get_data());
+    IxBloomFilter::set_bits(words + (block % IxBloomFilter::BLOCKS_PER_PAGE) * IxBloomFilter::BLOCK_WORDS, hash);
+    buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+}
+
+/**
+ * @description: 批量构建时按key的个数重新确定过滤器大小（每个key IX_BLOOM_BITS_PER_KEY位），
+ * 页面不够时追加新页面，已有的页面不回收；重建后的位图整页写回
+ * @param hashes 索引中所有key的哈希值
+ */
+void IxIndexHandle::rebuild_bloom(const std::vector<uint64_t> &hashes) {
+    size_t bits = hashes.size() * IX_BLOOM_BITS_PER_KEY;
+    size_t num_pages = (bits + PAGE_SIZE * 8 - 1) / (PAGE_SIZE * 8);
+    num_pages = std::min<size_t>(std::max<size_t>(num_pages, 1), IX_BLOOM_MAX_PAGES);
+    while (file_hdr_->bloom_pages_.size() < num_pages) {
+        IxNodeHandle *node = create_node();
+        file_hdr_->bloom_pages_.push_back(node->get_page_no());
+        buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+        delete node;
+    }
+    file_hdr_->update_tot_len();
+
+    bloom_.init(file_hdr_->bloom_pages_.size());
+    for (uint64_t hash : hashes) {
+        bloom_.add(hash);
+    }
+    for (size_t i = 0; i < file_hdr_->bloom_pages_.size(); ++i) {
+        Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, file_hdr_->bloom_pages_[i]});
+        memcpy(page->get_data(), bloom_.page_words(i), PAGE_SIZE);
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
     }
 }
 
@@ -487,19 +1554,24 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
     prev->set_next_leaf(leaf->get_next_leaf());
     buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    delete prev;
 
     IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
     next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
     buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    delete next;
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除node时，把node所在的页面放入空闲页面链表，供create_node()复用
+ * 页面号不会回收，因此file_hdr_.num_pages保持不变
  *
  * @param node
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
-    file_hdr_->num_pages_--;
+    std::lock_guard<std::mutex> lock(file_hdr_latch_);
+    node.page_hdr->next_free_page_no = file_hdr_->first_free_page_no_;
+    file_hdr_->first_free_page_no_ = node.get_page_no();
 }
 
 /**
@@ -512,5 +1584,6 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
         IxNodeHandle *child = fetch_node(child_page_no);
         child->set_parent_page_no(node->get_page_no());
         buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
     }
 }
\ No newline at end of file
@@ -10,67 +10,79 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <shared_mutex>
+
+#include "ix_bloom.h"
 #include "ix_defs.h"
 #include "transaction/transaction.h"
 
 enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
 
-static const bool binary_search = false;
+/* 解码后的内部结点，保存完整的key。修改内部结点时先解码、修改，再整体编码回页面；内部结点的修改只发生在分裂和合并时，代价可以接受 */
+class IxInnerEntries {
+   private:
+    int key_len_;
+    std::vector<char> keys_;
+    std::vector<page_id_t> children_;
 
-inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
-    switch (type) {
-        case TYPE_INT: {
-            int ia = *(int *)a;
-            int ib = *(int *)b;
-            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
-        }
-        case TYPE_FLOAT: {
-            float fa = *(float *)a;
-            float fb = *(float *)b;
-            return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
-        }
-        case TYPE_STRING: {
-            return memcmp(a, b, col_len);
-        }
-        case TYPE_DATETIME: {
-            int64_t ia = *(int64_t *)a;
-            int64_t ib = *(int64_t *)b;
-            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
-            break;
-        }
-        default:
-            throw InternalError("Unexpected data type");
+   public:
+    explicit IxInnerEntries(int key_len) : key_len_(key_len) {}
+
+    int size() const { return static_cast<int>(children_.size()); }
+
+    const char *key(int i) const { return keys_.data() + (size_t)i * key_len_; }
+
+    page_id_t child(int i) const { return children_[i]; }
+
+    void insert(int pos, const char *key, page_id_t child) {
+        keys_.insert(keys_.begin() + (size_t)pos * key_len_, key, key + key_len_);
+        children_.insert(children_.begin() + pos, child);
     }
-}
-
-inline int ix_compare(const char* a, const char* b, const std::vector<ColType>& col_types, const std::vector<int>& col_lens) {
-    int offset = 0;
-    for(size_t i = 0; i < col_types.size(); ++i) {
-        int res = ix_compare(a + offset, b + offset, col_types[i], col_lens[i]);
-        if(res != 0) return res;
-        offset += col_lens[i];
+
+    void erase(int pos) {
+        keys_.erase(keys_.begin() + (size_t)pos * key_len_, keys_.begin() + (size_t)(pos + 1) * key_len_);
+        children_.erase(children_.begin() + pos);
+    }
+
+    void set_key(int pos, const char *key) { memcpy(keys_.data() + (size_t)pos * key_len_, key, key_len_); }
+
+    void append(const IxInnerEntries &other) {
+        keys_.insert(keys_.end(), other.keys_.begin(), other.keys_.end());
+        children_.insert(children_.end(), other.children_.begin(), other.children_.end());
+    }
+
+    void clear() {
+        keys_.clear();
+        children_.clear();
     }
-    return 0;
-}
+};
 
-/* 管理B+树中的每个节点 */
+/* 管理B+树中的每个节点
+ * 叶结点：|page_hdr|high_key|keys|rids|，key定长存放
+ * 内部结点：|page_hdr|high_key|slots ...    ... key后缀|公共前缀|，key采用前缀压缩和后缀截断：
+ * 结点中所有key的公共前缀只存一份，每个key只存放去掉前缀、再截掉末尾的0之后的后缀；
+ * 叶结点分裂时推到父结点的分隔key只保留区分左右两个结点所需的最短前缀，其余字节置0，因此内部结点的key后缀通常很短 */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
+    friend class IxBulkBuilder;
 
    private:
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
     Page *page;                     // 存储节点的页面
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
-    char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
-    Rid *rids;                      // page->data的第三部分，指针指向首地址
+    char *high_key;                 // page->data的第二部分，结点中所有key的上界（不含），右兄弟结点中的key都不小于它
+    char *keys;                     // 叶结点page->data的第三部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len；内部结点从这里开始存放槽
+    Rid *rids;                      // 叶结点page->data的第四部分，指针指向首地址，长度为(btree_order + 1) * sizeof(Rid)
 
    public:
     IxNodeHandle() = default;
 
     IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
+        high_key = page->get_data() + sizeof(IxPageHdr);
+        keys = high_key + file_hdr->col_tot_len_;
         rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
     }
 
@@ -80,12 +92,13 @@ class IxNodeHandle {
 
     int get_max_size() { return file_hdr->btree_order_ + 1; }
 
+    /* 叶结点和内部结点都按键值对个数判断是否不足半满；个数不超过btree_order_时，内部结点不压缩也一定能放下，因此合并总能成功 */
     int get_min_size() { return get_max_size() / 2; }
 
     int key_at(int i) { return *(int *)get_key(i); }
 
     /* 得到第i个孩子结点的page_no */
-    page_id_t value_at(int i) { return get_rid(i)->page_no; }
+    page_id_t value_at(int i) { return get_slot(i)->child; }
 
     page_id_t get_page_no() { return page->get_page_id().page_no; }
 
@@ -107,13 +120,49 @@ class IxNodeHandle {
 
     void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    /* 内部结点复用next_leaf作为右兄弟指针 */
+    page_id_t get_right_sibling() { return page_hdr->next_leaf; }
+
+    void set_right_sibling(page_id_t page_no) { page_hdr->next_leaf = page_no; }
+
+    bool has_high_key() { return page_hdr->has_high_key; }
+
+    char *get_high_key() { return high_key; }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    void set_high_key(const char *key) {
+        memcpy(high_key, key, file_hdr->col_tot_len_);
+        page_hdr->has_high_key = true;
+    }
+
+    /* 从另一个结点复制high key，用于结点分裂和合并 */
+    void copy_high_key(IxNodeHandle *other) {
+        memcpy(high_key, other->high_key, file_hdr->col_tot_len_);
+        page_hdr->has_high_key = other->page_hdr->has_high_key;
+    }
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    /* key是否超出了本结点的范围，需要沿右兄弟指针向右查找 */
+    bool need_move_right(const char *key) {
+        return has_high_key() && file_hdr->key_search_.compare(key, high_key) >= 0;
+    }
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    /* 叶结点的第key_idx个key，内部结点的key是压缩存放的，需要用copy_key()取出 */
+    char *get_key(int key_idx) const {
+        assert(page_hdr->is_leaf);
+        return keys + key_idx * file_hdr->col_tot_len_;
+    }
+
+    /* 叶结点的第rid_idx个rid */
+    Rid *get_rid(int rid_idx) const {
+        assert(page_hdr->is_leaf);
+        return &rids[rid_idx];
+    }
+
+    void set_key(int key_idx, const char *key) { memcpy(get_key(key_idx), key, file_hdr->col_tot_len_); }
+
+    void set_rid(int rid_idx, const Rid &rid) { *get_rid(rid_idx) = rid; }
+
+    /* 把第key_idx个完整的key复制到dest中，叶结点和内部结点都适用 */
+    void copy_key(int key_idx, char *dest) const;
 
     int lower_bound(const char *target) const;
 
@@ -134,6 +183,25 @@ class IxNodeHandle {
 
     int remove(const char *key);
 
+    // 内部结点的读写，修改内部结点时放不下则返回false，结点保持不变
+    void load_entries(IxInnerEntries *entries) const;
+
+    bool store_entries(const IxInnerEntries &entries, int from, int to);
+
+    static int entries_page_size(const IxFileHdr *file_hdr, const IxInnerEntries &entries, int from, int to);
+
+    bool insert_child(int pos, const char *key, page_id_t child);
+
+    bool set_child_key(int pos, const char *key);
+
+    /* 插入任意一个新的分隔key后内部结点一定放得下（最坏情况下公共前缀变为空），用于并发控制判断结点是否安全 */
+    bool can_insert_child() {
+        int key_len = file_hdr->col_tot_len_;
+        int n = page_hdr->num_key;
+        int worst_heap = page_hdr->heap_size - page_hdr->prefix_len + n * page_hdr->prefix_len + key_len;
+        return (int)(sizeof(IxPageHdr) + key_len + (n + 1) * sizeof(IxInnerSlot)) + worst_heap <= PAGE_SIZE;
+    }
+
     /**
      * @brief used in internal node to remove the last key in root node, and return the last child
      *
@@ -155,31 +223,56 @@ class IxNodeHandle {
     int find_child(IxNodeHandle *child) {
         int rid_idx;
         for (rid_idx = 0; rid_idx < page_hdr->num_key; rid_idx++) {
-            if (get_rid(rid_idx)->page_no == child->get_page_no()) {
+            if (value_at(rid_idx) == child->get_page_no()) {
                 break;
             }
         }
         assert(rid_idx < page_hdr->num_key);
         return rid_idx;
     }
+
+   private:
+    IxInnerSlot *get_slot(int i) const { return reinterpret_cast<IxInnerSlot *>(keys) + i; }
+
+    const char *get_prefix() const { return page->get_data() + PAGE_SIZE - page_hdr->prefix_len; }
+};
+
+/* B+树索引的统计信息，供SHOW INDEX STATS和基于代价的索引选择使用 */
+struct IxIndexStats {
+    int64_t num_entries = 0;
+    int num_leaves = 0;
+    int height = 0;
+    int num_pages = 0;
+    double avg_fill = 0;                        // 叶结点的平均填充率
+    std::vector<int64_t> distinct_prefixes;     // 各前缀的不同取值个数，按上次计算时与当前的键值对数量之比估计
 };
 
-/* B+树 */
 class IxIndexHandle {
     friend class IxScan;
     friend class IxManager;
+    friend class IxBulkBuilder;
 
    private:
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    std::mutex root_latch_;                     // 保护root_page_，修改根结点的线程从查找开始一直持有
+    std::atomic<page_id_t> root_page_no_;       // root_page_的副本，读操作不加root_latch_，直接读取它
+    // 读操作下降时、IxScan转到下一个叶结点时共享持有；合并结点的删除操作独占持有，避免读到被回收的页面
+    std::shared_mutex structure_latch_;
+    std::atomic<uint64_t> structure_version_{0};  // 独占structure_latch_的删除操作每次加一，IxScan据此判断记下的叶结点是否仍然有效
+    std::mutex file_hdr_latch_;                 // 保护file_hdr_中的空闲页面链表、num_pages_和last_leaf_
+    IxBloomFilter bloom_;                       // file_hdr_->bloom_pages_在内存中的副本，等值查找前先查它
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
 
-    // for search
+    // 以下接口中的key都是原始格式，即各字段值按索引字段顺序拼接而成，接口内部用file_hdr_->key_codec_编码
+    // 只有find_leaf_page()、split()等内部使用的函数直接接受编码后的key
+    // 非唯一索引的接口中key也只含索引字段，长度为user_key_len()，附加的rid字段由接口内部填写
+
+    // for search，非唯一索引中返回key对应的所有rid
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
     std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
@@ -188,13 +281,18 @@ class IxIndexHandle {
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
-    IxNodeHandle *split(IxNodeHandle *node);
+    IxNodeHandle *split(IxNodeHandle *node, char *separator);
+
+    IxNodeHandle *split_internal(IxNodeHandle *node, const IxInnerEntries &entries, char *separator);
 
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
 
-    // for delete
+    // for delete，只用于唯一索引
     bool delete_entry(const char *key, Transaction *transaction);
 
+    // 删除key指向rid的键值对，唯一索引中key指向其他记录时不删除
+    bool delete_entry(const char *key, const Rid &rid, Transaction *transaction);
+
     bool coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction = nullptr,
                                 bool *root_is_latched = nullptr);
     bool adjust_root(IxNodeHandle *old_root_node);
@@ -204,28 +302,77 @@ class IxIndexHandle {
     bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                   Transaction *transaction, bool *root_is_latched);
 
+    // for bulk load
+    void bulk_load(const char *keys, const Rid *rids, int num_keys, int fill_factor = IX_MAX_FILL_FACTOR);
+
     Iid lower_bound(const char *key);
 
     Iid upper_bound(const char *key);
 
+    // 范围扫描时按编码后的key定位，调用者可以把key中不受限制的后几个字段填成全0或全0xff
+    Iid lower_bound_encoded(const char *key);
+
+    Iid upper_bound_encoded(const char *key);
+
     Iid leaf_end() const;
 
     Iid leaf_begin() const;
 
+    const IxKeyCodec &get_key_codec() const { return file_hdr_->key_codec_; }
+
+    bool is_unique() const { return file_hdr_->unique_; }
+
+    /* 调用者传入的key的长度和字段数量，不含非唯一索引附加的rid字段 */
+    int user_key_len() const { return file_hdr_->col_tot_len_ - (is_unique() ? 0 : IX_RID_KEY_LEN); }
+
+    int user_col_num() const { return file_hdr_->col_num_ - (is_unique() ? 0 : 2); }
+
+    /* 把原始格式的key编码到dest中，非唯一索引在末尾附加rid，dest长度为get_key_codec().key_len() */
+    void encode_key(const char *key, const Rid &rid, char *dest) const;
+
+    bool has_bloom() const { return bloom_.enabled(); }
+
+    IxBloomStats get_bloom_stats() const { return bloom_.get_stats(); }
+
+    // for statistics
+    IxIndexStats get_stats() const;
+
+    void refresh_stats();
+
    private:
     // 辅助函数
-    void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
+    void update_root_page_no(page_id_t root) {
+        file_hdr_->root_page_ = root;
+        root_page_no_ = root;
+    }
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    /* 编码只含索引字段的key，非唯一索引的rid字段填成fill：0表示最小的rid，0xff表示最大的rid */
+    void encode_bound(const char *key, char fill, char *dest) const;
+
+    bool delete_encoded(const char *key, Transaction *transaction);
+
+    // for concurrency control
+    bool is_safe(IxNodeHandle *node, Operation operation);
+
+    IxNodeHandle *find_leaf_page_optimistic(const char *key, Operation operation);
+
+    IxNodeHandle *find_leaf_page_read(const char *key, bool find_first);
+
+    void release_latches(Transaction *transaction, bool *root_is_latched);
+
     // for get/create node
     IxNodeHandle *fetch_node(int page_no) const;
 
     IxNodeHandle *create_node();
 
-    // for maintain data structure
-    void maintain_parent(IxNodeHandle *node);
+    // for bloom filter
+    void bloom_add(const char *key);
 
+    void rebuild_bloom(const std::vector<uint64_t> &hashes);
+
+    // for maintain data structure
     void erase_leaf(IxNodeHandle *leaf);
 
     void release_node_handle(IxNodeHandle &node);
@@ -234,4 +381,51 @@ class IxIndexHandle {
 
     // for index test
     Rid get_rid(const Iid &iid) const;
-};
\ No newline at end of file
+
+    // 同get_rid()，同时把iid处解码后的key写入key，用于只访问索引的扫描
+    Rid get_entry(const Iid &iid, char *key) const;
+};
+/* 自底向上构建B+树：调用者按key升序逐条追加编码后的键值对，叶结点按填充因子装满后依次写出，
+ * 叶子层写完后再逐层向上构建内部结点。只能用于空树，构建期间持有root_latch_ */
+class IxBulkBuilder {
+   private:
+    IxIndexHandle *ih_;
+    int key_len_;
+    int leaf_capacity_;                 // 每个叶结点装入的键值对个数
+    int inner_page_limit_;              // 每个内部结点最多占用的字节数
+    std::unique_lock<std::mutex> root_guard_;
+
+    std::vector<char> pending_keys_;    // 还没有写入叶结点的键值对
+    std::vector<Rid> pending_rids_;
+    bool has_last_key_ = false;
+    std::vector<char> last_key_;        // 上一个追加的key，用于去重
+    std::vector<uint64_t> bloom_hashes_;  // 追加的key的哈希值，finish()时用来重建Bloom过滤器
+    std::vector<int64_t> distinct_prefixes_;  // 与上一个key比较得到的各前缀的不同取值个数
+    int num_leaves_ = 0;
+    size_t num_entries_ = 0;
+
+    IxNodeHandle *prev_leaf_ = nullptr; // 最后写出的叶结点，下一个叶结点确定后才能设置它的high key和后继
+    std::vector<page_id_t> level_pages_;
+    std::vector<char> level_keys_;      // level_pages_中每个结点在父结点中的分隔key
+
+   public:
+    /**
+     * @param fill_factor 填充因子（百分比），叶结点装入btree_order的这一比例个键值对，内部结点占用页面的这一比例
+     */
+    IxBulkBuilder(IxIndexHandle *ih, int fill_factor);
+
+    ~IxBulkBuilder();
+
+    /* 追加一个编码后的键值对，key不能小于上一个key；与上一个key相同时丢弃并返回false，与insert_entry()一致 */
+    bool append(const char *key, const Rid &rid);
+
+    /* 写出剩余的叶结点并构建内部结点 */
+    void finish();
+
+    size_t num_entries() const { return num_entries_; }
+
+   private:
+    void write_leaf(int size);
+
+    int build_inner_levels();
+};
@@ -0,0 +1,180 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "defs.h"
+#include "errors.h"
+
+/* key的规范化编码：把由各字段原始值拼接成的key编码成按字节比较（memcmp）即可得到ix_compare顺序的定长串
+ * INT：符号位取反后按大端存放；FLOAT：非负数符号位取反、负数所有位取反后按大端存放；
+ * DATETIME：同INT，按64位大端存放；STRING/VARCHAR：原样保留定长的字节串
+ * B+树中只存放编码后的key，调用者传入和取回的都是原始格式的key，编码和解码只发生在IxIndexHandle的接口处 */
+class IxKeyCodec {
+   private:
+    std::vector<ColType> col_types_;
+    std::vector<int> col_lens_;
+    int key_len_ = 0;
+
+   public:
+    void init(const std::vector<ColType> &col_types, const std::vector<int> &col_lens) {
+        col_types_ = col_types;
+        col_lens_ = col_lens;
+        key_len_ = 0;
+        for (int len : col_lens) {
+            key_len_ += len;
+        }
+    }
+
+    int key_len() const { return key_len_; }
+
+    /* 把原始格式的key编码到dest中，dest长度为key_len() */
+    void encode(const char *key, char *dest) const {
+        for (size_t i = 0; i < col_types_.size(); ++i) {
+            switch (col_types_[i]) {
+                case TYPE_INT: {
+                    uint32_t v;
+                    memcpy(&v, key, sizeof(v));
+                    store_be32(dest, v ^ 0x80000000u);
+                    break;
+                }
+                case TYPE_FLOAT: {
+                    float f;
+                    uint32_t v;
+                    memcpy(&f, key, sizeof(f));
+                    memcpy(&v, &f, sizeof(v));
+                    if (f == 0) {
+                        v = 0;  // -0.0和0.0相等，编码也必须相同
+                    }
+                    store_be32(dest, (v & 0x80000000u) ? ~v : v | 0x80000000u);
+                    break;
+                }
+                case TYPE_DATETIME: {
+                    uint64_t v;
+                    memcpy(&v, key, sizeof(v));
+                    store_be64(dest, v ^ 0x8000000000000000ull);
+                    break;
+                }
+                case TYPE_STRING:
+                case TYPE_VARCHAR:
+                    memcpy(dest, key, col_lens_[i]);
+                    break;
+                default:
+                    throw InternalError("Unexpected data type");
+            }
+            key += col_lens_[i];
+            dest += col_lens_[i];
+        }
+    }
+
+    /* encode()的逆过程，-0.0会被解码为0.0 */
+    void decode(const char *src, char *key) const { decode(src, key, col_types_.size()); }
+
+    /* 只解码前num_cols个字段 */
+    void decode(const char *src, char *key, size_t num_cols) const {
+        for (size_t i = 0; i < num_cols; ++i) {
+            switch (col_types_[i]) {
+                case TYPE_INT: {
+                    uint32_t v = load_be32(src) ^ 0x80000000u;
+                    memcpy(key, &v, sizeof(v));
+                    break;
+                }
+                case TYPE_FLOAT: {
+                    uint32_t v = load_be32(src);
+                    v = (v & 0x80000000u) ? v & 0x7fffffffu : ~v;
+                    memcpy(key, &v, sizeof(v));
+                    break;
+                }
+                case TYPE_DATETIME: {
+                    uint64_t v = load_be64(src) ^ 0x8000000000000000ull;
+                    memcpy(key, &v, sizeof(v));
+                    break;
+                }
+                case TYPE_STRING:
+                case TYPE_VARCHAR:
+                    memcpy(key, src, col_lens_[i]);
+                    break;
+                default:
+                    throw InternalError("Unexpected data type");
+            }
+            src += col_lens_[i];
+            key += col_lens_[i];
+        }
+    }
+
+    /* 编码后的key的哈希值（FNV-1a后再做一次混合），哈希索引的目录和Bloom过滤器都会写入磁盘，不能依赖标准库的实现 */
+    static uint64_t hash(const char *src, int len) {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (int i = 0; i < len; ++i) {
+            h ^= static_cast<unsigned char>(src[i]);
+            h *= 0x100000001b3ull;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static uint32_t load_be32(const char *src) {
+        uint32_t v;
+        memcpy(&v, src, sizeof(v));
+        return __builtin_bswap32(v);
+    }
+
+    static uint64_t load_be64(const char *src) {
+        uint64_t v;
+        memcpy(&v, src, sizeof(v));
+        return __builtin_bswap64(v);
+    }
+
+   private:
+    static void store_be32(char *dest, uint32_t v) {
+        v = __builtin_bswap32(v);
+        memcpy(dest, &v, sizeof(v));
+    }
+
+    static void store_be64(char *dest, uint64_t v) {
+        v = __builtin_bswap64(v);
+        memcpy(dest, &v, sizeof(v));
+    }
+};
+
+/* 接口处临时存放编码后的key，较短的key直接放在栈上 */
+class IxEncodedKey {
+   private:
+    static constexpr int INLINE_SIZE = 64;
+
+    char inline_buf_[INLINE_SIZE];
+    std::unique_ptr<char[]> heap_buf_;
+    char *data_;
+
+   public:
+    IxEncodedKey(const IxKeyCodec &codec, const char *key) {
+        if (codec.key_len() <= INLINE_SIZE) {
+            data_ = inline_buf_;
+        } else {
+            heap_buf_ = std::make_unique<char[]>(codec.key_len());
+            data_ = heap_buf_.get();
+        }
+        codec.encode(key, data_);
+    }
+
+    IxEncodedKey(const IxEncodedKey &) = delete;
+    IxEncodedKey &operator=(const IxEncodedKey &) = delete;
+
+    const char *data() const { return data_; }
+};
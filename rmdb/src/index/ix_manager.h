@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "system/sm_meta.h"
 #include "ix_defs.h"
+#include "ix_hash_index.h"
 #include "ix_index_handle.h"
 
 class IxManager {
@@ -54,7 +55,12 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
-    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    /**
+     * @param bloom 是否为索引维护Bloom过滤器，初始时占一页，批量构建时按key的个数扩大
+     * @param unique 为false时key可以重复，文件中的key末尾附加rid字段，调用者传入和取回的key仍然只含index_cols
+     */
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, bool bloom = false,
+                      bool unique = true) {
         std::string ix_name = get_index_name(filename, index_cols);
         // Create index file
         disk_manager_->create_file(ix_name);
@@ -73,18 +79,36 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
-        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
-        // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
+        std::vector<ColType> col_types;
+        std::vector<int> col_lens;
+        for (auto &col : index_cols) {
+            col_types.push_back(col.type);
+            col_lens.push_back(col.len);
+        }
+        if (!unique) {
+            col_types.insert(col_types.end(), 2, TYPE_INT);
+            col_lens.insert(col_lens.end(), 2, sizeof(int));
+            col_num += 2;
+            col_tot_len += IX_RID_KEY_LEN;
+        }
+        // 每个结点在page_hdr之后还存放一个high key（B-link），即 |page_hdr| + |attr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE
+        // btree_order是叶结点的容量；内部结点的key是压缩存放的，按字节数而不是个数决定是否分裂
+        // 求得n的最大值btree_order，即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
+        int btree_order =
+            static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr) - col_tot_len) / (col_tot_len + sizeof(Rid)) - 1);
         assert(btree_order > 2);
 
         // Create file header and write to file
-        IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE,
+        int num_pages = bloom ? IX_INIT_NUM_PAGES + 1 : IX_INIT_NUM_PAGES;
+        IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, num_pages, IX_INIT_ROOT_PAGE,
                                 col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len,
                                 IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
-        for(int i = 0; i < col_num; ++i) {
-            fhdr->col_types_.push_back(index_cols[i].type);
-            fhdr->col_lens_.push_back(index_cols[i].len);
+        fhdr->col_types_ = col_types;
+        fhdr->col_lens_ = col_lens;
+        fhdr->unique_ = unique;
+        fhdr->distinct_prefixes_.assign(col_num, 0);
+        if (bloom) {
+            fhdr->bloom_pages_.push_back(IX_INIT_NUM_PAGES);
         }
         fhdr->update_tot_len();
         
@@ -105,6 +129,7 @@ class IxManager {
                 .parent = IX_NO_PAGE,
                 .num_key = 0,
                 .is_leaf = true,
+                .has_high_key = false,
                 .prev_leaf = IX_INIT_ROOT_PAGE,
                 .next_leaf = IX_INIT_ROOT_PAGE,
             };
@@ -120,12 +145,18 @@ class IxManager {
                 .parent = IX_NO_PAGE,
                 .num_key = 0,
                 .is_leaf = true,
+                .has_high_key = false,
                 .prev_leaf = IX_LEAF_HEADER_PAGE,
                 .next_leaf = IX_LEAF_HEADER_PAGE,
             };
             // Must write PAGE_SIZE here in case of future fetch_node()
             disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, PAGE_SIZE);
         }
+        // Bloom过滤器的位图紧跟在根结点之后，初始为全0
+        if (bloom) {
+            memset(page_buf, 0, PAGE_SIZE);
+            disk_manager_->write_page(fd, IX_INIT_NUM_PAGES, page_buf, PAGE_SIZE);
+        }
 
         disk_manager_->set_fd2pageno(fd, IX_INIT_NUM_PAGES - 1);  // DEBUG
 
@@ -133,6 +164,52 @@ class IxManager {
         disk_manager_->close_file(fd);
     }
 
+    /**
+     * @description: 创建可扩展哈希索引文件：第0页为文件头，第1页为目录页，第2页为唯一的桶，全局深度为0
+     * 与B+树索引使用相同的文件名，同一组字段上只能建一个索引
+     */
+    void create_hash_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        disk_manager_->create_file(ix_name);
+        int fd = disk_manager_->open_file(ix_name);
+
+        IxHashFileHdr fhdr;
+        fhdr.num_pages_ = IX_HASH_INIT_NUM_PAGES;
+        fhdr.global_depth_ = 0;
+        fhdr.col_num_ = index_cols.size();
+        fhdr.col_tot_len_ = 0;
+        for(auto& col: index_cols) {
+            fhdr.col_types_.push_back(col.type);
+            fhdr.col_lens_.push_back(col.len);
+            fhdr.col_tot_len_ += col.len;
+        }
+        if (fhdr.col_tot_len_ > IX_MAX_COL_LEN) {
+            disk_manager_->close_file(fd);
+            disk_manager_->destroy_file(ix_name);
+            throw InvalidColLengthError(fhdr.col_tot_len_);
+        }
+        // 桶的容量取BUCKET_SIZE，key太长放不下时按页面大小取
+        fhdr.bucket_capacity_ = std::min<int>(
+            BUCKET_SIZE, (PAGE_SIZE - sizeof(IxHashBucketHdr)) / (fhdr.col_tot_len_ + sizeof(Rid)));
+        fhdr.dir_pages_.push_back(IX_HASH_INIT_DIR_PAGE);
+
+        char page_buf[PAGE_SIZE];
+        memset(page_buf, 0, PAGE_SIZE);
+        fhdr.serialize(page_buf);
+        disk_manager_->write_page(fd, IX_HASH_FILE_HDR_PAGE, page_buf, PAGE_SIZE);
+
+        memset(page_buf, 0, PAGE_SIZE);
+        page_id_t bucket = IX_HASH_INIT_BUCKET_PAGE;
+        memcpy(page_buf, &bucket, sizeof(page_id_t));
+        disk_manager_->write_page(fd, IX_HASH_INIT_DIR_PAGE, page_buf, PAGE_SIZE);
+
+        memset(page_buf, 0, PAGE_SIZE);
+        *reinterpret_cast<IxHashBucketHdr *>(page_buf) = {.local_depth = 0, .num_entries = 0};
+        disk_manager_->write_page(fd, IX_HASH_INIT_BUCKET_PAGE, page_buf, PAGE_SIZE);
+
+        disk_manager_->close_file(fd);
+    }
+
     void destroy_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
         std::string ix_name = get_index_name(filename, index_cols);
         disk_manager_->destroy_file(ix_name);
@@ -156,12 +233,32 @@ class IxManager {
         return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
 
+    std::unique_ptr<IxHashIndexHandle> open_hash_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        int fd = disk_manager_->open_file(ix_name);
+        return std::make_unique<IxHashIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+    }
+
     void close_index(const IxIndexHandle *ih) {
         char* data = new char[ih->file_hdr_->tot_len_];
         ih->file_hdr_->serialize(data);
         disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(ih->fd_);
+        // fd关闭后可能被重新分配给其他文件，必须把该索引的页面逐出缓冲区
+        for (int page_no = 0; page_no < ih->file_hdr_->num_pages_; ++page_no) {
+            buffer_pool_manager_->delete_page(PageId{ih->fd_, page_no});
+        }
+        disk_manager_->close_file(ih->fd_);
+    }
+
+    void close_hash_index(IxHashIndexHandle *ih) {
+        // 文件头、目录和桶都在缓冲区中，一起刷到磁盘
+        ih->write_file_hdr();
+        buffer_pool_manager_->flush_all_pages(ih->fd_);
+        for (int page_no = 0; page_no < ih->file_hdr_.num_pages_; ++page_no) {
+            buffer_pool_manager_->delete_page(PageId{ih->fd_, page_no});
+        }
         disk_manager_->close_file(ih->fd_);
     }
-};
\ No newline at end of file
+};
@@ -10,24 +10,93 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_scan.h"
 
+IxScan::IxScan(IxIndexHandle *ih, const char *lower_key, bool lower_strict, const char *upper_key, bool upper_strict,
+               BufferPoolManager *bpm)
+    : ih_(ih), bpm_(bpm), cursor_strict_(lower_strict), upper_strict_(upper_strict) {
+    int key_len = ih_->file_hdr_->col_tot_len_;
+    if (lower_key != nullptr) {
+        cursor_key_.assign(lower_key, lower_key + key_len);
+        has_cursor_ = true;
+    }
+    if (upper_key != nullptr) {
+        upper_key_.assign(upper_key, upper_key + key_len);
+        has_upper_ = true;
+    }
+    if (has_cursor_ && has_upper_) {
+        int cmp = ih_->file_hdr_->key_search_.compare(cursor_key_.data(), upper_key_.data());
+        done_ = cmp > 0 || (cmp == 0 && (cursor_strict_ || upper_strict_));
+    }
+    load_batch();
+}
+
+/**
+ * @brief 从cursor_key_之后开始，把下一个含有范围内键值对的叶结点中的键值对拷贝到缓冲区
+ * 转到下一个叶结点期间共享持有structure_latch_，合并结点的删除操作不会回收它。两次拷贝之间不持有任何锁，
+ * 索引的结构版本变化说明期间有页面被回收，上次记下的右兄弟可能已经不是叶结点，此时按cursor_key_重新下降
+ */
+void IxScan::load_batch() {
+    batch_rids_.clear();
+    batch_keys_.clear();
+    batch_pos_ = 0;
+    if (done_) {
+        return;
+    }
+    std::shared_lock<std::shared_mutex> structure_lock(ih_->structure_latch_);
+    IxNodeHandle *leaf;
+    uint64_t version = ih_->structure_version_.load();
+    if (next_leaf_ == IX_NO_PAGE || version != structure_version_) {
+        leaf = ih_->find_leaf_page_read(has_cursor_ ? cursor_key_.data() : nullptr, !has_cursor_);
+    } else {
+        leaf = ih_->fetch_node(next_leaf_);
+        leaf->page->rlatch();
+    }
+    structure_version_ = version;
+    const IxKeySearch &search = ih_->file_hdr_->key_search_;
+    int key_len = ih_->file_hdr_->col_tot_len_;
+    while (true) {
+        assert(leaf->is_leaf_page());
+        int size = leaf->get_size();
+        int start = 0;
+        if (has_cursor_) {
+            start = cursor_strict_ ? search.upper_bound(leaf->keys, 0, size, cursor_key_.data())
+                                   : search.lower_bound(leaf->keys, 0, size, cursor_key_.data());
+        }
+        int stop = size;
+        if (has_upper_) {
+            stop = upper_strict_ ? search.lower_bound(leaf->keys, 0, size, upper_key_.data())
+                                 : search.upper_bound(leaf->keys, 0, size, upper_key_.data());
+            done_ = stop < size;
+        }
+        next_leaf_ = leaf->get_next_leaf();
+        done_ = done_ || next_leaf_ == IX_LEAF_HEADER_PAGE;
+        if (start < stop) {
+            batch_rids_.assign(leaf->get_rid(start), leaf->get_rid(start) + (stop - start));
+            batch_keys_.assign(leaf->get_key(start), leaf->get_key(start) + (size_t)(stop - start) * key_len);
+        }
+        leaf->page->runlatch();
+        bpm_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+        if (!batch_rids_.empty() || done_) {
+            break;
+        }
+        // 这个叶结点中没有范围内的键值对（例如扫描期间被删除），继续看下一个叶结点
+        leaf = ih_->fetch_node(next_leaf_);
+        leaf->page->rlatch();
+    }
+    if (!batch_rids_.empty()) {
+        cursor_key_.assign(batch_keys_.end() - key_len, batch_keys_.end());
+        cursor_strict_ = true;
+        has_cursor_ = true;
+    }
+}
+
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移到下一个键值对，当前叶结点的缓冲区取完时转到下一个叶结点
  */
 void IxScan::next() {
     assert(!is_end());
-    IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
-    assert(node->is_leaf_page());
-    assert(iid_.slot_no < node->get_size());
-    // increment slot no
-    iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
-        // go to next leaf
-        iid_.slot_no = 0;
-        iid_.page_no = node->get_next_leaf();
+    if (++batch_pos_ < batch_rids_.size()) {
+        return;
     }
+    load_batch();
 }
-
-Rid IxScan::rid() const {
-    return ih_->get_rid(iid_);
-}
\ No newline at end of file
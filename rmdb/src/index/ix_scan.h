@@ -13,26 +13,50 @@ See the Mulan PSL v2 for more details. */
 #include "ix_defs.h"
 #include "ix_index_handle.h"
 
-// class IxIndexHandle;
-
 // 用于遍历叶子结点
 // 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
-// TODO：对page遍历时，要加上读锁
+// 每个叶结点只fetch一次：在读锁保护下把落在[lower, upper]内的键值对一次性拷贝到缓冲区，之后逐条从缓冲区中取，
+// 缓冲区取完后再转到下一个叶结点。扫描的位置用key而不是Iid表示：每个叶结点中的起点和终点都在拷贝时按key查找，
+// 并发的插入和分裂移动了键值对也不会越过上界或者漏掉、重复键值对；到达上界或者最后一个叶结点时结束
 class IxScan : public RecScan {
-    const IxIndexHandle *ih_;
-    Iid iid_;  // 初始为lower（用于遍历的指针）
-    Iid end_;  // 初始为upper
+    IxIndexHandle *ih_;
     BufferPoolManager *bpm_;
+    std::vector<char> cursor_key_;  // 下一个叶结点从大于（首次扫描时按下界是否严格，大于或不小于）这个key的位置开始
+    bool cursor_strict_ = false;
+    bool has_cursor_ = false;       // 没有下界时从第一个叶结点开始
+    std::vector<char> upper_key_;
+    bool upper_strict_ = false;
+    bool has_upper_ = false;
+
+    std::vector<Rid> batch_rids_;   // 当前叶结点中待扫描的rid
+    std::vector<char> batch_keys_;  // 与batch_rids_对应的编码后的key，连续存放
+    size_t batch_pos_ = 0;          // 当前键值对在缓冲区中的下标
+    bool done_ = false;             // 已经到达上界或者最后一个叶结点，缓冲区取完即结束
+    page_id_t next_leaf_ = IX_NO_PAGE;  // 拷贝时当前叶结点的右兄弟
+    uint64_t structure_version_ = 0;    // 拷贝时索引的结构版本，没有变化时next_leaf_仍是有效的叶结点
 
    public:
-    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
-        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {}
+    /* 扫描编码后的key在lower_key和upper_key之间的键值对，strict表示不含该端点，key为nullptr表示该侧不设界；
+     * 下界大于上界时扫描结果为空 */
+    IxScan(IxIndexHandle *ih, const char *lower_key, bool lower_strict, const char *upper_key, bool upper_strict,
+           BufferPoolManager *bpm);
+
+    /* 扫描整个索引 */
+    IxScan(IxIndexHandle *ih, BufferPoolManager *bpm) : IxScan(ih, nullptr, false, nullptr, false, bpm) {}
 
     void next() override;
 
-    bool is_end() const override { return iid_ == end_; }
+    bool is_end() const override { return batch_pos_ >= batch_rids_.size(); }
+
+    Rid rid() const override { return batch_rids_[batch_pos_]; }
 
-    Rid rid() const override;
+    /* 当前位置的rid，同时把解码后的key写入key，非唯一索引附加的rid字段不写入 */
+    Rid entry(char *key) const {
+        int key_len = ih_->file_hdr_->col_tot_len_;
+        ih_->get_key_codec().decode(batch_keys_.data() + batch_pos_ * key_len, key, ih_->user_col_num());
+        return batch_rids_[batch_pos_];
+    }
 
-    const Iid &iid() const { return iid_; }
-};
\ No newline at end of file
+   private:
+    void load_batch();
+};
@@ -0,0 +1,229 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include "defs.h"
+#include "errors.h"
+
+inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
+    switch (type) {
+        case TYPE_INT: {
+            int ia = *(int *)a;
+            int ib = *(int *)b;
+            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
+        }
+        case TYPE_FLOAT: {
+            float fa = *(float *)a;
+            float fb = *(float *)b;
+            return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
+        }
+        case TYPE_STRING:
+        case TYPE_VARCHAR: {
+            return memcmp(a, b, col_len);
+        }
+        case TYPE_DATETIME: {
+            int64_t ia = *(int64_t *)a;
+            int64_t ib = *(int64_t *)b;
+            return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
+            break;
+        }
+        default:
+            throw InternalError("Unexpected data type");
+    }
+}
+
+inline int ix_compare(const char* a, const char* b, const std::vector<ColType>& col_types, const std::vector<int>& col_lens) {
+    int offset = 0;
+    for(size_t i = 0; i < col_types.size(); ++i) {
+        int res = ix_compare(a + offset, b + offset, col_types[i], col_lens[i]);
+        if(res != 0) return res;
+        offset += col_lens[i];
+    }
+    return 0;
+}
+
+/* 结点内查找：B+树中的key都是IxKeyCodec编码后的串，按memcmp比较即可。根据key长度选择专门的查找函数，在打开索引时选择一次
+ * 4/8字节的key（单列INT/FLOAT/DATETIME）：当作大端无符号整数，无分支二分查找把范围缩小到一个cache line后，用SIMD数出小于目标的key个数
+ * 12/16字节的key（如TPC-C中多个INT组成的复合key）：无分支二分查找，按大端的64/32位整数逐段比较，代替memcmp调用
+ * 其余长度：无分支二分查找，每次比较调用memcmp */
+class IxKeySearch {
+   public:
+    using SearchFunc = int (*)(const IxKeySearch &ks, const char *keys, int lo, int n, const char *target);
+
+    void init(int key_len) {
+        key_len_ = key_len;
+        if (key_len == sizeof(uint32_t)) {
+            set(search_scalar<uint32_t, false>, search_scalar<uint32_t, true>);
+        } else if (key_len == sizeof(uint64_t)) {
+            set(search_scalar<uint64_t, false>, search_scalar<uint64_t, true>);
+        } else if (key_len == 12) {
+            set(search_by<false, WordCompare<12>>, search_by<true, WordCompare<12>>);
+        } else if (key_len == 16) {
+            set(search_by<false, WordCompare<16>>, search_by<true, WordCompare<16>>);
+        } else {
+            set_generic();
+        }
+    }
+
+    /* 对任意长度的key都适用的查找函数 */
+    void set_generic() { set(search_by<false, MemcmpCompare>, search_by<true, MemcmpCompare>); }
+
+    int compare(const char *a, const char *b) const { return memcmp(a, b, key_len_); }
+
+    /* 在keys[lo, n)中查找第一个>=target的位置，不存在时返回n */
+    int lower_bound(const char *keys, int lo, int n, const char *target) const {
+        return lower_(*this, keys, lo, n, target);
+    }
+
+    /* 在keys[lo, n)中查找第一个>target的位置，不存在时返回n */
+    int upper_bound(const char *keys, int lo, int n, const char *target) const {
+        return upper_(*this, keys, lo, n, target);
+    }
+
+   private:
+    int key_len_ = 0;
+    SearchFunc lower_ = nullptr;
+    SearchFunc upper_ = nullptr;
+
+    void set(SearchFunc lower, SearchFunc upper) {
+        lower_ = lower;
+        upper_ = upper;
+    }
+
+    struct MemcmpCompare {
+        static int compare(const IxKeySearch &ks, const char *a, const char *b) { return memcmp(a, b, ks.key_len_); }
+    };
+
+    /* 长度为Len的key按大端整数逐段比较，结果与memcmp相同 */
+    template <int Len>
+    struct WordCompare {
+        static int compare(const IxKeySearch &, const char *a, const char *b) {
+            int i = 0;
+            for (; i + 8 <= Len; i += 8) {
+                uint64_t x = load<uint64_t>(a + i), y = load<uint64_t>(b + i);
+                if (x != y) {
+                    return x < y ? -1 : 1;
+                }
+            }
+            if constexpr (Len % 8 == 4) {
+                uint32_t x = load<uint32_t>(a + i), y = load<uint32_t>(b + i);
+                return x < y ? -1 : (x > y ? 1 : 0);
+            }
+            return 0;
+        }
+    };
+
+    /* 以条件传送代替分支的二分查找，Cmp在编译期确定 */
+    template <bool Upper, typename Cmp>
+    static int search_by(const IxKeySearch &ks, const char *keys, int lo, int n, const char *target) {
+        int first = lo;
+        int len = n - lo;
+        while (len > 0) {
+            int half = len / 2;
+            int mid = first + half;
+            int res = Cmp::compare(ks, keys + (size_t)mid * ks.key_len_, target);
+            bool go_right = Upper ? res <= 0 : res < 0;
+            first = go_right ? mid + 1 : first;
+            len = go_right ? len - half - 1 : half;
+        }
+        return first;
+    }
+
+    template <typename T>
+    static T load(const char *src) {
+        T v;
+        memcpy(&v, src, sizeof(T));
+        if constexpr (sizeof(T) == sizeof(uint32_t)) {
+            return __builtin_bswap32(v);
+        } else {
+            return __builtin_bswap64(v);
+        }
+    }
+
+    /**
+     * @description: 定长整数key的查找：无分支地把范围缩小到一个cache line以内，然后统计其中小于（Upper时为小于等于）目标的key个数
+     * 范围内的key有序，因此这个个数就是结果相对范围起点的偏移
+     */
+    template <typename T, bool Upper>
+    static int search_scalar(const IxKeySearch &, const char *keys, int lo, int n, const char *target) {
+        constexpr int line_size = 64 / sizeof(T);
+        T x = load<T>(target);
+        const char *base = keys + (size_t)lo * sizeof(T);
+        int len = n - lo;
+        while (len > line_size) {
+            int half = len / 2;
+            T v = load<T>(base + (size_t)(half - 1) * sizeof(T));
+            base += (Upper ? v <= x : v < x) ? (size_t)half * sizeof(T) : 0;
+            len -= half;
+        }
+        return static_cast<int>((base - keys) / sizeof(T)) + count_less<T, Upper>(base, len, x);
+    }
+
+#ifdef __SSE2__
+    /* 把每个32位整数从大端转换为本机字节序，只用到SSE2 */
+    static __m128i bswap32_epi32(__m128i v) {
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+        return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+#endif
+
+    template <typename T, bool Upper>
+    static int count_less(const char *base, int len, T x) {
+        int count = 0;
+        int i = 0;
+#ifdef __SSE2__
+        if constexpr (std::is_same_v<T, uint32_t>) {
+            // SSE只有有符号比较，两边都把符号位取反
+            const __m128i sign = _mm_set1_epi32(INT32_MIN);
+            __m128i vx = _mm_set1_epi32(static_cast<int32_t>(x ^ 0x80000000u));
+            for (; i + 4 <= len; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(base + i * sizeof(T)));
+                v = _mm_xor_si128(bswap32_epi32(v), sign);
+                __m128i lt = _mm_cmplt_epi32(v, vx);
+                if constexpr (Upper) {
+                    lt = _mm_or_si128(lt, _mm_cmpeq_epi32(v, vx));
+                }
+                count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(lt)));
+            }
+        }
+#endif
+#ifdef __SSE4_2__
+        if constexpr (std::is_same_v<T, uint64_t>) {
+            const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+            __m128i vx = _mm_set1_epi64x(static_cast<int64_t>(x ^ 0x8000000000000000ull));
+            for (; i + 2 <= len; i += 2) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(base + i * sizeof(T)));
+                v = _mm_xor_si128(bswap32_epi32(_mm_shuffle_epi32(v, 0xB1)), sign);
+                // v < x 即 x > v；v <= x 即 !(v > x)
+                int mask = _mm_movemask_pd(_mm_castsi128_pd(Upper ? _mm_cmpgt_epi64(v, vx) : _mm_cmpgt_epi64(vx, v)));
+                count += Upper ? 2 - __builtin_popcount(mask) : __builtin_popcount(mask);
+            }
+        }
+#endif
+        for (; i < len; ++i) {
+            T v = load<T>(base + i * sizeof(T));
+            count += Upper ? v <= x : v < x;
+        }
+        return count;
+    }
+};
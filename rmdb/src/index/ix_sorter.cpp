@@ -0,0 +1,200 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_sorter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "errors.h"
+
+// 归并时每次从临时文件读入的字节数
+static constexpr size_t RUN_READ_SIZE = 1 << 20;
+
+IxExternalSorter::IxExternalSorter(std::string tmp_prefix, int key_len, size_t mem_budget, size_t num_writers)
+    : tmp_prefix_(std::move(tmp_prefix)), key_len_(key_len), entry_size_(key_len + sizeof(Rid)) {
+    writer_budget_ = std::max<size_t>(mem_budget / std::max<size_t>(num_writers, 1), entry_size_);
+}
+
+IxExternalSorter::~IxExternalSorter() {
+    for (auto &run : runs_) {
+        if (run->file != nullptr) {
+            fclose(run->file);
+            remove(run->file_name.c_str());
+        }
+    }
+}
+
+/**
+ * @description: 加入一个排好序的有序段，spill为true时写入临时文件，否则留在内存中
+ */
+void IxExternalSorter::add_run(std::vector<char> &&sorted, bool spill) {
+    auto run = std::make_unique<Run>();
+    if (spill) {
+        {
+            std::lock_guard<std::mutex> lock(runs_latch_);
+            run->file_name = tmp_prefix_ + ".run" + std::to_string(next_file_id_++);
+        }
+        run->file = fopen(run->file_name.c_str(), "wb+");
+        if (run->file == nullptr) {
+            throw UnixError();
+        }
+        if (fwrite(sorted.data(), 1, sorted.size(), run->file) != sorted.size() || fflush(run->file) != 0) {
+            fclose(run->file);
+            remove(run->file_name.c_str());
+            throw UnixError();
+        }
+        rewind(run->file);
+        run->remaining = sorted.size();
+    } else {
+        run->data = std::move(sorted);
+    }
+    std::lock_guard<std::mutex> lock(runs_latch_);
+    runs_.push_back(std::move(run));
+}
+
+void IxExternalSorter::refill(Run *run) {
+    size_t size = std::min(run->remaining, RUN_READ_SIZE / entry_size_ * entry_size_);
+    run->data.resize(size);
+    if (fread(run->data.data(), 1, size, run->file) != size) {
+        throw UnixError();
+    }
+    run->remaining -= size;
+    run->pos = 0;
+}
+
+/* key相同时按有序段的下标排序，使结果是确定的 */
+bool IxExternalSorter::run_less(int a, int b) const {
+    int res = memcmp(run_key(a), run_key(b), key_len_);
+    return res != 0 ? res < 0 : a < b;
+}
+
+void IxExternalSorter::sift_down(size_t i) {
+    size_t n = heap_.size();
+    while (true) {
+        size_t smallest = i;
+        for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < n; ++child) {
+            if (run_less(heap_[child], heap_[smallest])) {
+                smallest = child;
+            }
+        }
+        if (smallest == i) {
+            return;
+        }
+        std::swap(heap_[i], heap_[smallest]);
+        i = smallest;
+    }
+}
+
+void IxExternalSorter::start_merge() {
+    heap_.clear();
+    for (size_t i = 0; i < runs_.size(); ++i) {
+        Run *run = runs_[i].get();
+        if (run->file != nullptr) {
+            refill(run);
+        }
+        if (!run->data.empty()) {
+            heap_.push_back(static_cast<int>(i));
+        }
+    }
+    for (size_t i = heap_.size() / 2; i-- > 0;) {
+        sift_down(i);
+    }
+    merging_ = false;
+}
+
+/**
+ * @description: 多路归并，取出当前最小的键值对。上一次返回的键值对在这次调用时才从它的有序段中移走，保证返回的key指针在下一次调用前有效
+ */
+bool IxExternalSorter::next(const char **key, Rid *rid) {
+    if (merging_ && !heap_.empty()) {
+        Run *top = runs_[heap_[0]].get();
+        top->pos += entry_size_;
+        if (top->pos == top->data.size()) {
+            if (top->remaining > 0) {
+                refill(top);
+            } else {
+                heap_[0] = heap_.back();
+                heap_.pop_back();
+            }
+        }
+        if (!heap_.empty()) {
+            sift_down(0);
+        }
+    }
+    merging_ = true;
+    if (heap_.empty()) {
+        return false;
+    }
+    *key = run_key(heap_[0]);
+    memcpy(rid, *key + key_len_, sizeof(Rid));
+    return true;
+}
+
+void IxSortWriter::add(const char *key, const Rid &rid) {
+    int key_len = sorter_->key_len_;
+    if (buffer_.size() + sorter_->entry_size_ > sorter_->writer_budget_) {
+        sorter_->add_run(sort_buffer(), true);
+        buffer_.clear();
+    }
+    size_t offset = buffer_.size();
+    buffer_.resize(offset + sorter_->entry_size_);
+    memcpy(buffer_.data() + offset, key, key_len);
+    memcpy(buffer_.data() + offset + key_len, &rid, sizeof(Rid));
+}
+
+void IxSortWriter::finish() {
+    if (!buffer_.empty()) {
+        sorter_->add_run(sort_buffer(), false);
+    }
+    std::vector<char>().swap(buffer_);
+}
+
+/**
+ * @description: 对缓冲区中的键值对排序，返回排好序的副本
+ * 编码后的key按memcmp比较，先把前8个字节作为大端整数取出来和下标一起排序，大部分比较不需要访问key本身；
+ * 前8个字节相同时再比较剩余部分，仍相同时按加入的先后排序
+ */
+std::vector<char> IxSortWriter::sort_buffer() {
+    int key_len = sorter_->key_len_;
+    int entry_size = sorter_->entry_size_;
+    size_t n = buffer_.size() / entry_size;
+    struct SortItem {
+        uint64_t prefix;
+        uint32_t idx;
+    };
+    std::vector<SortItem> items(n);
+    int prefix_len = std::min(key_len, 8);
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char bytes[8] = {0};
+        memcpy(bytes, buffer_.data() + i * entry_size, prefix_len);
+        uint64_t prefix;
+        memcpy(&prefix, bytes, sizeof(prefix));
+        items[i] = {__builtin_bswap64(prefix), static_cast<uint32_t>(i)};
+    }
+    const char *base = buffer_.data();
+    std::sort(items.begin(), items.end(), [&](const SortItem &a, const SortItem &b) {
+        if (a.prefix != b.prefix) {
+            return a.prefix < b.prefix;
+        }
+        if (key_len > 8) {
+            int res = memcmp(base + (size_t)a.idx * entry_size + 8, base + (size_t)b.idx * entry_size + 8, key_len - 8);
+            if (res != 0) {
+                return res < 0;
+            }
+        }
+        return a.idx < b.idx;
+    });
+    std::vector<char> sorted(buffer_.size());
+    for (size_t i = 0; i < n; ++i) {
+        memcpy(sorted.data() + i * entry_size, base + (size_t)items[i].idx * entry_size, entry_size);
+    }
+    return sorted;
+}
@@ -0,0 +1,99 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "defs.h"
+
+/* 批量建索引用的外部排序，对(编码后的key, rid)按key的memcmp顺序排序
+ * 每个生产者线程使用各自的IxSortWriter，在内存中攒满一批后排好序，作为一个有序段（run）写入临时文件；
+ * 所有生产者结束后，对各个有序段做多路归并，按key升序逐条输出。key相同的键值对都会输出，由调用者决定如何处理 */
+class IxExternalSorter {
+   private:
+    /* 一个有序段：内存中的有序段直接放在data中，写入临时文件的有序段每次读入一块到data中 */
+    struct Run {
+        std::vector<char> data;
+        size_t pos = 0;             // 下一个键值对在data中的偏移
+        FILE *file = nullptr;
+        std::string file_name;
+        size_t remaining = 0;       // 文件中还没有读入的字节数
+    };
+
+    std::string tmp_prefix_;
+    int key_len_;
+    int entry_size_;
+    size_t writer_budget_;          // 每个IxSortWriter在内存中最多攒的字节数
+    std::mutex runs_latch_;         // 保护runs_和next_file_id_
+    std::vector<std::unique_ptr<Run>> runs_;
+    int next_file_id_ = 0;
+
+    std::vector<int> heap_;         // 归并时的小根堆，保存有序段的下标
+    bool merging_ = false;
+
+   public:
+    /**
+     * @param tmp_prefix 临时文件名前缀，临时文件名为tmp_prefix.run<i>
+     * @param key_len 编码后的key长度
+     * @param mem_budget 所有生产者在内存中缓存的键值对的总字节数上限
+     * @param num_writers 生产者个数
+     */
+    IxExternalSorter(std::string tmp_prefix, int key_len, size_t mem_budget, size_t num_writers);
+
+    ~IxExternalSorter();
+
+    IxExternalSorter(const IxExternalSorter &) = delete;
+    IxExternalSorter &operator=(const IxExternalSorter &) = delete;
+
+    int key_len() const { return key_len_; }
+
+    /* 所有IxSortWriter都调用了finish()之后开始归并 */
+    void start_merge();
+
+    /* 取出下一个键值对，全部取完后返回false；key指向排序器内部的缓冲区，下一次调用前有效 */
+    bool next(const char **key, Rid *rid);
+
+   private:
+    friend class IxSortWriter;
+
+    void add_run(std::vector<char> &&sorted, bool spill);
+
+    bool run_less(int a, int b) const;
+
+    void refill(Run *run);
+
+    void sift_down(size_t i);
+
+    const char *run_key(int i) const { return runs_[i]->data.data() + runs_[i]->pos; }
+};
+
+/* 一个生产者线程的排序缓冲区 */
+class IxSortWriter {
+   private:
+    IxExternalSorter *sorter_;
+    std::vector<char> buffer_;      // 连续存放的(key, rid)
+
+   public:
+    explicit IxSortWriter(IxExternalSorter *sorter) : sorter_(sorter) {}
+
+    /* 追加一个编码后的key及其rid，缓冲区满时排序后写成临时文件中的一个有序段 */
+    void add(const char *key, const Rid &rid);
+
+    /* 把缓冲区中剩余的键值对排序后留在内存中，作为最后一个有序段 */
+    void finish();
+
+   private:
+    std::vector<char> sort_buffer();
+};
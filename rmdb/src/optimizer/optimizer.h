@@ -41,6 +41,9 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowIndexStats>(query->parse)) {
+            // show index stats table;
+            return std::make_shared<OtherPlan>(T_ShowIndexStats, x->tab_name);
         } else if (auto x = std::dynamic_pointer_cast<ast::TxnBegin>(query->parse)) {
             // begin;
             return std::make_shared<OtherPlan>(T_Transaction_begin, std::string());
@@ -53,6 +56,9 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::TxnRollback>(query->parse)) {
             // rollback;
             return std::make_shared<OtherPlan>(T_Transaction_rollback, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::LoadData>(query->parse)) {
+            // load data infile 'file' into table t;
+            return std::make_shared<LoadDataPlan>(T_LoadData, x->tab_name, x->file_name);
         } else {
             return planner_->do_planner(query, context);
         }
@@ -24,10 +24,12 @@ typedef enum PlanTag{
     T_Help,
     T_ShowTable,
     T_DescTable,
+    T_ShowIndexStats,
     T_CreateTable,
     T_DropTable,
     T_CreateIndex,
     T_DropIndex,
+    T_Reindex,
     T_Insert,
     T_Update,
     T_Delete,
@@ -36,9 +38,13 @@ typedef enum PlanTag{
     T_Transaction_commit,
     T_Transaction_abort,
     T_Transaction_rollback,
+    T_LoadData,
     T_SeqScan,
     T_IndexScan,
+    T_IndexOnlyScan,
+    T_PointIndexScan,
     T_NestLoop,
+    T_IndexNestLoop,
     T_Sort,
     T_Projection
 } PlanTag;
@@ -97,6 +103,8 @@ class JoinPlan : public Plan
         std::vector<Condition> conds_;
         // future TODO: 后续可以支持的连接类型
         JoinType type;
+        // T_IndexNestLoop时右节点的表上用于探测的索引
+        std::vector<std::string> index_col_names_;
         
 };
 
@@ -159,17 +167,24 @@ class DMLPlan : public Plan
 class DDLPlan : public Plan
 {
     public:
-        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols)
+        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols,
+                std::string storage = "")
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
             cols_ = std::move(cols);
             tab_col_names_ = std::move(col_names);
+            storage_ = std::move(storage);
         }
         ~DDLPlan(){}
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        std::string storage_;       // create table时指定的存储格式
+        int fill_factor_ = IX_DEFAULT_FILL_FACTOR;  // create index时批量构建索引的填充因子
+        IndexType index_type_ = INDEX_BTREE;        // create index时的索引类型
+        bool unique_ = false;                       // create index时是否为唯一索引
+        bool bloom_ = false;                        // create index时是否为B+树索引维护Bloom过滤器
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
@@ -185,6 +200,19 @@ class OtherPlan : public Plan
         std::string tab_name_;
 };
 
+// load data infile语句对应的plan，tab_name_为目标表
+class LoadDataPlan : public OtherPlan
+{
+    public:
+        LoadDataPlan(PlanTag tag, std::string tab_name, std::string file_name)
+            : OtherPlan(tag, std::move(tab_name))
+        {
+            file_name_ = std::move(file_name);
+        }
+        ~LoadDataPlan(){}
+        std::string file_name_;
+};
+
 class plannerInfo{
     public:
     std::shared_ptr<ast::SelectStmt> parse;
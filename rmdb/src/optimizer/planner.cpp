@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "planner.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "execution/executor_delete.h"
@@ -22,16 +23,173 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "record_printer.h"
 
-// 目前的索引匹配规则为：完全匹配索引字段，且全部为单点查询，不会自动调整where条件的顺序
+/**
+ * @description: 选择扫描表时使用的索引
+ * B+树索引按字段顺序匹配：前k个字段上都有等值条件（与条件在where中的顺序无关），第k+1个字段上可以再有一个范围条件，
+ * 等值前缀越长越好，等值前缀一样长时有范围条件的更好；仍然相同时按统计信息选前缀不同取值更多（匹配的记录更少）的索引，
+ * 最后选字段更少的索引。ART索引或哈希索引的每个字段上都有等值条件，且字段数不少于B+树索引的等值前缀时，
+ * 优先使用这两种索引做一次点查（ART索引在内存中，先于哈希索引）
+ * @return 找到可用的索引时返回true，index_col_names为该索引的全部字段
+ */
 bool Planner::get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names) {
     index_col_names.clear();
-    for(auto& cond: curr_conds) {
-        if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name.compare(tab_name) == 0)
-            index_col_names.push_back(cond.lhs_col.col_name);
+    TabMeta& tab = sm_manager_->db_.get_table(tab_name);
+    auto is_sargable = [&](const Condition& cond, const ColMeta& col) {
+        return cond.is_rhs_val && cond.op != OP_NE && cond.lhs_col.tab_name.compare(tab_name) == 0 &&
+               cond.lhs_col.col_name == col.name && is_same_type(col.type, cond.rhs_val.type);
+    };
+    auto use_index = [&](const IndexMeta& index) {
+        for(auto& col: index.cols) {
+            index_col_names.push_back(col.name);
+        }
+        return true;
+    };
+    auto has_cond = [&](const ColMeta& col, bool eq) {
+        return std::any_of(curr_conds.begin(), curr_conds.end(), [&](const Condition& cond) {
+            return (cond.op == OP_EQ) == eq && is_sargable(cond, col);
+        });
+    };
+
+    const IndexMeta* best = nullptr;
+    size_t best_eq = 0;
+    bool best_range = false;
+    int64_t best_rows = 0;     // 等值前缀匹配的键值对个数的估计值
+    for(auto& index: tab.indexes) {
+        if(index.type != INDEX_BTREE) continue;
+        size_t num_eq = 0;
+        while(num_eq < index.cols.size() && has_cond(index.cols[num_eq], true)) {
+            num_eq++;
+        }
+        bool range = num_eq < index.cols.size() && has_cond(index.cols[num_eq], false);
+        if(num_eq == 0 && !range) continue;
+        int64_t rows = 0;
+        if(num_eq > 0) {
+            IxIndexStats stats =
+                sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name, index.cols))->get_stats();
+            rows = stats.num_entries / std::max<int64_t>(stats.distinct_prefixes[num_eq - 1], 1);
+        }
+        bool better = best == nullptr || num_eq > best_eq || (num_eq == best_eq && range && !best_range);
+        if(!better && best != nullptr && num_eq == best_eq && range == best_range) {
+            better = rows < best_rows || (rows == best_rows && index.cols.size() < best->cols.size());
+        }
+        if(better) {
+            best = &index;
+            best_eq = num_eq;
+            best_range = range;
+            best_rows = rows;
+        }
+    }
+
+    // 每个字段上都有等值条件时优先使用内存中的ART索引，其次是哈希索引
+    // 这两种索引只能是唯一索引
+    for(IndexType type: {INDEX_ART, INDEX_HASH}) {
+        for(auto& index: tab.indexes) {
+            if(index.type != type || index.cols.size() < best_eq) continue;
+            bool all_eq = std::all_of(index.cols.begin(), index.cols.end(), [&](const ColMeta& col) {
+                return has_cond(col, true);
+            });
+            if(all_eq) return use_index(index);
+        }
     }
+    return best != nullptr && use_index(*best);
+}
+
+/* 使用index_col_names对应的索引扫描时的算子类型 */
+PlanTag Planner::get_index_scan_tag(const std::string &tab_name, const std::vector<std::string> &index_col_names) {
     TabMeta& tab = sm_manager_->db_.get_table(tab_name);
-    if(tab.is_index(index_col_names)) return true;
-    return false;
+    return tab.get_index_meta(index_col_names)->type == INDEX_BTREE ? T_IndexScan : T_PointIndexScan;
+}
+
+/**
+ * @description: 判断select语句中用到的tab_name的字段是否都在索引中，是则可以只扫描索引，不读取数据文件
+ * 需要检查投影列、本表的条件、还没有下推的连接条件以及order by的字段
+ */
+bool Planner::is_index_covering(std::shared_ptr<Query> query, const std::string &tab_name, const std::vector<Condition> &curr_conds,
+                                const std::vector<std::string> &index_col_names) {
+    auto covered = [&](const TabCol &col) {
+        return col.tab_name != tab_name ||
+               std::find(index_col_names.begin(), index_col_names.end(), col.col_name) != index_col_names.end();
+    };
+    for(auto& col: query->cols) {
+        if(!covered(col)) return false;
+    }
+    auto conds_covered = [&](const std::vector<Condition> &conds) {
+        for(auto& cond: conds) {
+            if(!covered(cond.lhs_col) || (!cond.is_rhs_val && !covered(cond.rhs_col))) return false;
+        }
+        return true;
+    };
+    if(!conds_covered(curr_conds) || !conds_covered(query->conds)) return false;
+    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
+    TabMeta& tab = sm_manager_->db_.get_table(tab_name);
+    for(auto& order: x->orders) {
+        if(tab.is_col(order->cols->col_name) && !covered({.tab_name = tab_name, .col_name = order->cols->col_name})) return false;
+    }
+    return true;
+}
+
+/**
+ * @description: 把内表上有可用索引的嵌套循环连接改成索引嵌套循环连接
+ * 连接的一侧是单表扫描，且该表某个B+树索引的前缀字段上都有等值条件（连接条件中另一侧的字段类型和长度都相同，
+ * 或者是该表上与同类型常量的等值条件），其中至少一个来自连接条件时，取前缀最长的索引，把这张表作为内表放到右侧
+ */
+void Planner::choose_index_joins(std::shared_ptr<Plan> plan) {
+    auto x = std::dynamic_pointer_cast<JoinPlan>(plan);
+    if(x == nullptr) return;
+    choose_index_joins(x->left_);
+    choose_index_joins(x->right_);
+    if(x->tag != T_NestLoop || x->conds_.empty()) return;
+
+    // 返回col上的等值条件来自哪里：0没有，1连接条件，2常量条件
+    auto eq_source = [&](const ScanPlan& scan, const ColMeta& col) {
+        for(auto& cond: x->conds_) {
+            if(cond.op != OP_EQ || cond.is_rhs_val) continue;
+            const TabCol* outer = nullptr;
+            if(cond.lhs_col.tab_name == scan.tab_name_ && cond.lhs_col.col_name == col.name) outer = &cond.rhs_col;
+            if(cond.rhs_col.tab_name == scan.tab_name_ && cond.rhs_col.col_name == col.name) outer = &cond.lhs_col;
+            if(outer == nullptr || outer->tab_name == scan.tab_name_) continue;
+            auto outer_col = sm_manager_->db_.get_table(outer->tab_name).get_col(outer->col_name);
+            if(outer_col->type == col.type && outer_col->len == col.len) return 1;
+        }
+        for(auto& cond: scan.conds_) {
+            if(cond.op == OP_EQ && cond.is_rhs_val && cond.lhs_col.col_name == col.name && cond.rhs_val.type == col.type) {
+                return 2;
+            }
+        }
+        return 0;
+    };
+
+    size_t best_len = 0;
+    bool best_right = true;
+    const IndexMeta* best = nullptr;
+    for(bool inner_right: {true, false}) {
+        auto scan = std::dynamic_pointer_cast<ScanPlan>(inner_right ? x->right_ : x->left_);
+        if(scan == nullptr) continue;
+        for(auto& index: sm_manager_->db_.get_table(scan->tab_name_).indexes) {
+            if(index.type != INDEX_BTREE) continue;
+            size_t len = 0;
+            bool has_join_col = false;
+            for(; len < index.cols.size(); ++len) {
+                int source = eq_source(*scan, index.cols[len]);
+                if(source == 0) break;
+                has_join_col |= source == 1;
+            }
+            if(has_join_col && len > best_len) {
+                best_len = len;
+                best_right = inner_right;
+                best = &index;
+            }
+        }
+    }
+    if(best == nullptr) return;
+    if(!best_right) {
+        std::swap(x->left_, x->right_);
+    }
+    x->tag = T_IndexNestLoop;
+    x->index_col_names_.clear();
+    for(auto& col: best->cols) {
+        x->index_col_names_.push_back(col.name);
+    }
 }
 
 /**
@@ -129,6 +287,7 @@ std::shared_ptr<Query> Planner::logical_optimization(std::shared_ptr<Query> quer
 std::shared_ptr<Plan> Planner::physical_optimization(std::shared_ptr<Query> query, Context *context)
 {
     std::shared_ptr<Plan> plan = make_one_rel(query);
+    choose_index_joins(plan);
     
     // 其他物理优化
 
@@ -156,9 +315,13 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
             index_col_names.clear();
             table_scan_executors[i] = 
                 std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, tables[i], curr_conds, index_col_names);
-        } else {  // 存在索引
+        } else {  // 存在索引，查询用到的字段都在索引中时只扫描索引
+            PlanTag tag = get_index_scan_tag(tables[i], index_col_names);
+            if (tag == T_IndexScan && is_index_covering(query, tables[i], curr_conds, index_col_names)) {
+                tag = T_IndexOnlyScan;
+            }
             table_scan_executors[i] =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
+                std::make_shared<ScanPlan>(tag, sm_manager_, tables[i], curr_conds, index_col_names);
         }
     }
     // 只有一个表，不需要join。
@@ -308,27 +471,49 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
     std::shared_ptr<Plan> plannerRoot;
     if (auto x = std::dynamic_pointer_cast<ast::CreateTable>(query->parse)) {
         // create table;
+        // 主键字段放在tab_col_names_中，建表后在其上建立唯一索引
         std::vector<ColDef> col_defs;
+        std::vector<std::string> primary_key;
         for (auto &field : x->fields) {
             if (auto sv_col_def = std::dynamic_pointer_cast<ast::ColDef>(field)) {
                 ColDef col_def = {.name = sv_col_def->col_name,
                                   .type = interp_sv_type(sv_col_def->type_len->type),
                                   .len = sv_col_def->type_len->len};
                 col_defs.push_back(col_def);
+                if (sv_col_def->is_primary_key) {
+                    primary_key.push_back(sv_col_def->col_name);
+                }
+            } else if (auto sv_primary_key = std::dynamic_pointer_cast<ast::PrimaryKeyDef>(field)) {
+                primary_key.insert(primary_key.end(), sv_primary_key->col_names.begin(),
+                                   sv_primary_key->col_names.end());
             } else {
                 throw InternalError("Unexpected field type");
             }
         }
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
+        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, primary_key, col_defs, x->storage);
     } else if (auto x = std::dynamic_pointer_cast<ast::DropTable>(query->parse)) {
         // drop table;
         plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        auto plan = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        if (x->fill_factor != 0) {
+            plan->fill_factor_ = x->fill_factor;
+        }
+        if (x->is_hash) {
+            plan->index_type_ = INDEX_HASH;
+        } else if (x->is_art) {
+            plan->index_type_ = INDEX_ART;
+        }
+        plan->unique_ = x->is_unique;
+        plan->bloom_ = x->with_bloom;
+        plannerRoot = plan;
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+    } else if (auto x = std::dynamic_pointer_cast<ast::Reindex>(query->parse)) {
+        // reindex
+        plannerRoot = std::make_shared<DDLPlan>(T_Reindex, x->tab_name, x->col_names, std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(query->parse)) {
         // insert;
         plannerRoot = std::make_shared<DMLPlan>(T_Insert, std::shared_ptr<Plan>(),  x->tab_name,  
@@ -348,7 +533,8 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
                 std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds, index_col_names);
         } else {  // 存在索引
             table_scan_executors =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+                std::make_shared<ScanPlan>(get_index_scan_tag(x->tab_name, index_col_names), sm_manager_, x->tab_name,
+                                           query->conds, index_col_names);
         }
 
         plannerRoot = std::make_shared<DMLPlan>(T_Delete, table_scan_executors, x->tab_name,  
@@ -368,7 +554,8 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
                 std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds, index_col_names);
         } else {  // 存在索引
             table_scan_executors =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+                std::make_shared<ScanPlan>(get_index_scan_tag(x->tab_name, index_col_names), sm_manager_, x->tab_name,
+                                           query->conds, index_col_names);
         }
         plannerRoot = std::make_shared<DMLPlan>(T_Update, table_scan_executors, x->tab_name,
                                                      std::vector<Value>(), query->conds, 
@@ -50,9 +50,17 @@ class Planner {
     // int get_indexNo(std::string tab_name, std::vector<Condition> curr_conds);
     bool get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names);
 
+    void choose_index_joins(std::shared_ptr<Plan> plan);
+
+    PlanTag get_index_scan_tag(const std::string &tab_name, const std::vector<std::string> &index_col_names);
+
+    bool is_index_covering(std::shared_ptr<Query> query, const std::string &tab_name, const std::vector<Condition> &curr_conds,
+                           const std::vector<std::string> &index_col_names);
+
     ColType interp_sv_type(ast::SvType sv_type) {
         std::map<ast::SvType, ColType> m = {
-            {ast::SV_TYPE_INT, TYPE_INT}, {ast::SV_TYPE_FLOAT, TYPE_FLOAT}, {ast::SV_TYPE_STRING, TYPE_STRING}, {ast::SV_TYPE_DATETIME,TYPE_DATETIME}};
+            {ast::SV_TYPE_INT, TYPE_INT}, {ast::SV_TYPE_FLOAT, TYPE_FLOAT}, {ast::SV_TYPE_STRING, TYPE_STRING}, {ast::SV_TYPE_DATETIME,TYPE_DATETIME},
+            {ast::SV_TYPE_VARCHAR, TYPE_VARCHAR}};
         return m.at(sv_type);
     }
 };
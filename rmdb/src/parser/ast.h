@@ -19,7 +19,7 @@ enum JoinType {
 namespace ast {
 
 enum SvType {
-    SV_TYPE_INT, SV_TYPE_FLOAT, SV_TYPE_STRING, SV_TYPE_DATETIME
+    SV_TYPE_INT, SV_TYPE_FLOAT, SV_TYPE_STRING, SV_TYPE_DATETIME, SV_TYPE_VARCHAR
 };
 
 enum SvCompOp {
@@ -68,17 +68,26 @@ struct Field : public TreeNode {
 struct ColDef : public Field {
     std::string col_name;
     std::shared_ptr<TypeLen> type_len;
+    bool is_primary_key;    // 字段定义后的PRIMARY KEY
 
-    ColDef(std::string col_name_, std::shared_ptr<TypeLen> type_len_) :
-            col_name(std::move(col_name_)), type_len(std::move(type_len_)) {}
+    ColDef(std::string col_name_, std::shared_ptr<TypeLen> type_len_, bool is_primary_key_ = false) :
+            col_name(std::move(col_name_)), type_len(std::move(type_len_)), is_primary_key(is_primary_key_) {}
+};
+
+// 表定义中的PRIMARY KEY (col, ...)
+struct PrimaryKeyDef : public Field {
+    std::vector<std::string> col_names;
+
+    PrimaryKeyDef(std::vector<std::string> col_names_) : col_names(std::move(col_names_)) {}
 };
 
 struct CreateTable : public TreeNode {
     std::string tab_name;
     std::vector<std::shared_ptr<Field>> fields;
+    std::string storage;    // STORAGE = xxx 指定的存储格式，未指定时为空
 
-    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_) :
-            tab_name(std::move(tab_name_)), fields(std::move(fields_)) {}
+    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_, std::string storage_ = "") :
+            tab_name(std::move(tab_name_)), fields(std::move(fields_)), storage(std::move(storage_)) {}
 };
 
 struct DropTable : public TreeNode {
@@ -93,12 +102,25 @@ struct DescTable : public TreeNode {
     DescTable(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
 };
 
+struct ShowIndexStats : public TreeNode {
+    std::string tab_name;
+
+    ShowIndexStats(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    int fill_factor;        // FILLFACTOR = n 指定的填充因子（百分比），未指定时为0
+    bool is_hash;           // USING HASH，建立哈希索引
+    bool is_art;            // USING ART，建立内存中的ART索引
+    bool is_unique;         // CREATE UNIQUE INDEX，建立唯一索引
+    bool with_bloom;        // WITH BLOOM，为B+树索引维护Bloom过滤器
 
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_, int fill_factor_ = 0, bool is_hash_ = false,
+                bool is_art_ = false, bool is_unique_ = false, bool with_bloom_ = false) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), fill_factor(fill_factor_), is_hash(is_hash_),
+            is_art(is_art_), is_unique(is_unique_), with_bloom(with_bloom_) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -109,6 +131,14 @@ struct DropIndex : public TreeNode {
             tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
 };
 
+struct Reindex : public TreeNode {
+    std::string tab_name;
+    std::vector<std::string> col_names;
+
+    Reindex(std::string tab_name_, std::vector<std::string> col_names_) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+};
+
 struct Expr : public TreeNode {
 };
 
@@ -240,6 +270,14 @@ struct SelectStmt : public TreeNode {
     }
 };
 
+struct LoadData : public TreeNode {
+    std::string file_name;
+    std::string tab_name;
+
+    LoadData(std::string file_name_, std::string tab_name_) :
+            file_name(std::move(file_name_)), tab_name(std::move(tab_name_)) {}
+};
+
 // Semantic value
 struct SemValue {
     int sv_int;
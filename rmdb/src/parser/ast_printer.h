@@ -46,6 +46,7 @@ private:
                 {SV_TYPE_INT,    "INT"},
                 {SV_TYPE_FLOAT,  "FLOAT"},
                 {SV_TYPE_STRING, "STRING"},
+                {SV_TYPE_VARCHAR, "VARCHAR"},
                 {SV_TYPE_DATETIME,"DATETIME"},
         };
         return m.at(type);
@@ -93,28 +94,61 @@ private:
             std::cout << "CREATE_TABLE\n";
             print_val(x->tab_name, offset);
             print_node_list(x->fields, offset);
+            if (!x->storage.empty()) {
+                print_val(x->storage, offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DropTable>(node)) {
             std::cout << "DROP_TABLE\n";
             print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<DescTable>(node)) {
             std::cout << "DESC_TABLE\n";
             print_val(x->tab_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<ShowIndexStats>(node)) {
+            std::cout << "SHOW_INDEX_STATS\n";
+            print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<CreateIndex>(node)) {
             std::cout << "CREATE_INDEX\n";
             print_val(x->tab_name, offset);
             // print_val(x->col_name, offset);
             for(auto col_name: x->col_names)
                 print_val(col_name, offset);
+            if (x->fill_factor != 0) {
+                print_val(x->fill_factor, offset);
+            }
+            if (x->is_hash) {
+                print_val(std::string("HASH"), offset);
+            }
+            if (x->is_art) {
+                print_val(std::string("ART"), offset);
+            }
+            if (x->is_unique) {
+                print_val(std::string("UNIQUE"), offset);
+            }
+            if (x->with_bloom) {
+                print_val(std::string("BLOOM"), offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DropIndex>(node)) {
             std::cout << "DROP_INDEX\n";
             print_val(x->tab_name, offset);
             // print_val(x->col_name, offset);
             for(auto col_name: x->col_names)
                 print_val(col_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<Reindex>(node)) {
+            std::cout << "REINDEX\n";
+            print_val(x->tab_name, offset);
+            for(auto col_name: x->col_names)
+                print_val(col_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<ColDef>(node)) {
             std::cout << "COL_DEF\n";
             print_val(x->col_name, offset);
             print_node(x->type_len, offset);
+            if (x->is_primary_key) {
+                print_val(std::string("PRIMARY_KEY"), offset);
+            }
+        } else if (auto x = std::dynamic_pointer_cast<PrimaryKeyDef>(node)) {
+            std::cout << "PRIMARY_KEY\n";
+            for(auto col_name: x->col_names)
+                print_val(col_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<Col>(node)) {
             std::cout << "COL\n";
             print_val(x->tab_name, offset);
@@ -167,6 +201,10 @@ private:
                 print_val(x->limit, offset);
                 print_node_list(x->orders,offset);
             }
+        } else if (auto x = std::dynamic_pointer_cast<LoadData>(node)) {
+            std::cout << "LOAD_DATA\n";
+            print_val(x->file_name, offset);
+            print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<TxnBegin>(node)) {
             std::cout << "BEGIN\n";
         } else if (auto x = std::dynamic_pointer_cast<TxnCommit>(node)) {
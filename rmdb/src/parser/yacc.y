@@ -22,7 +22,7 @@ using namespace ast;
 
 // keywords
 %token SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
-WHERE UPDATE SET SELECT INT CHAR FLOAT DATETIME INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY LIMIT
+WHERE UPDATE SET SELECT INT CHAR FLOAT DATETIME INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY LIMIT LOAD DATA INFILE VARCHAR STORAGE FILLFACTOR USING HASH ART UNIQUE PRIMARY KEY WITH BLOOM STATS REINDEX
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 
@@ -53,6 +53,7 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT DATETIME INDEX AND JOIN EXIT HELP TXN_BEG
 %type <sv_orderbys> order_clauses
 %type <sv_opt_orders> opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
+%type <sv_int> optUnique optBloom
 
 %%
 start:
@@ -109,6 +110,10 @@ dbStmt:
     {
         $$ = std::make_shared<ShowTables>();
     }
+    |   SHOW INDEX STATS tbName
+    {
+        $$ = std::make_shared<ShowIndexStats>($4);
+    }
     ;
 
 ddl:
@@ -116,6 +121,10 @@ ddl:
     {
         $$ = std::make_shared<CreateTable>($3, $5);
     }
+    |   CREATE TABLE tbName '(' fieldList ')' STORAGE '=' IDENTIFIER
+    {
+        $$ = std::make_shared<CreateTable>($3, $5, $9);
+    }
     |   DROP TABLE tbName
     {
         $$ = std::make_shared<DropTable>($3);
@@ -124,14 +133,30 @@ ddl:
     {
         $$ = std::make_shared<DescTable>($2);
     }
-    |   CREATE INDEX tbName '(' colNameList ')'
+    |   CREATE optUnique INDEX tbName '(' colNameList ')' optBloom
+    {
+        $$ = std::make_shared<CreateIndex>($4, $6, 0, false, false, $2, $8);
+    }
+    |   CREATE optUnique INDEX tbName '(' colNameList ')' FILLFACTOR '=' VALUE_INT optBloom
+    {
+        $$ = std::make_shared<CreateIndex>($4, $6, $10, false, false, $2, $11);
+    }
+    |   CREATE optUnique INDEX tbName '(' colNameList ')' USING HASH
     {
-        $$ = std::make_shared<CreateIndex>($3, $5);
+        $$ = std::make_shared<CreateIndex>($4, $6, 0, true, false, $2);
+    }
+    |   CREATE optUnique INDEX tbName '(' colNameList ')' USING ART
+    {
+        $$ = std::make_shared<CreateIndex>($4, $6, 0, false, true, $2);
     }
     |   DROP INDEX tbName '(' colNameList ')'
     {
         $$ = std::make_shared<DropIndex>($3, $5);
     }
+    |   REINDEX tbName '(' colNameList ')'
+    {
+        $$ = std::make_shared<Reindex>($2, $4);
+    }
     ;
 
 dml:
@@ -151,6 +176,10 @@ dml:
     {
         $$ = std::make_shared<SelectStmt>($2, $4, $5, $6);
     }
+    |   LOAD DATA INFILE VALUE_STRING INTO TABLE tbName
+    {
+        $$ = std::make_shared<LoadData>($4, $7);
+    }
     ;
 
 fieldList:
@@ -175,11 +204,41 @@ colNameList:
     }
     ;
 
+optUnique:
+        /* epsilon */
+    {
+        $$ = 0;
+    }
+    |   UNIQUE
+    {
+        $$ = 1;
+    }
+    ;
+
+optBloom:
+        /* epsilon */
+    {
+        $$ = 0;
+    }
+    |   WITH BLOOM
+    {
+        $$ = 1;
+    }
+    ;
+
 field:
         colName type
     {
         $$ = std::make_shared<ColDef>($1, $2);
     }
+    |   colName type PRIMARY KEY
+    {
+        $$ = std::make_shared<ColDef>($1, $2, true);
+    }
+    |   PRIMARY KEY '(' colNameList ')'
+    {
+        $$ = std::make_shared<PrimaryKeyDef>($4);
+    }
     ;
 
 type:
@@ -191,6 +250,10 @@ type:
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_STRING, $3);
     }
+    |   VARCHAR '(' VALUE_INT ')'
+    {
+        $$ = std::make_shared<TypeLen>(SV_TYPE_VARCHAR, $3);
+    }
     |   FLOAT
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
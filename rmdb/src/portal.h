@@ -18,13 +18,17 @@ See the Mulan PSL v2 for more details. */
 #include "execution/executor_nestedloop_join.h"
 #include "execution/executor_projection.h"
 #include "execution/executor_seq_scan.h"
+#include "execution/executor_parallel_seq_scan.h"
 #include "execution/executor_index_scan.h"
+#include "execution/executor_index_only_scan.h"
+#include "execution/executor_point_index_scan.h"
 #include "execution/executor_update.h"
 #include "execution/executor_insert.h"
 #include "execution/executor_delete.h"
 #include "execution/execution_sort.h"
 #include "common/common.h"
 #include "execution/executor_block_nestedloop_join.h"
+#include "execution/executor_index_nestedloop_join.h"
 
 typedef enum portalTag{
     PORTAL_Invalid_Query = 0,
@@ -69,7 +73,7 @@ class Portal
                 case T_select:
                 {
                     std::shared_ptr<ProjectionPlan> p = std::dynamic_pointer_cast<ProjectionPlan>(x->subplan_);
-                    std::unique_ptr<AbstractExecutor> root= convert_plan_executor(p, context);
+                    std::unique_ptr<AbstractExecutor> root= convert_plan_executor(p, context, true);
                     return std::make_shared<PortalStmt>(PORTAL_ONE_SELECT, std::move(p->sel_cols_), std::move(root), plan);
                 }
                     
@@ -152,19 +156,41 @@ class Portal
     void drop(){}
 
 
-    std::unique_ptr<AbstractExecutor> convert_plan_executor(std::shared_ptr<Plan> plan, Context *context)
+    // parallel表示该子树的输出顺序无关紧要，可以使用并行扫描；join的两侧需要稳定地多次重扫，不使用并行扫描
+    std::unique_ptr<AbstractExecutor> convert_plan_executor(std::shared_ptr<Plan> plan, Context *context,
+                                                            bool parallel = false)
     {
         if(auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)){
-            auto subplan_executor = convert_plan_executor(x->subplan_, context);
+            auto subplan_executor = convert_plan_executor(x->subplan_, context, parallel);
             return std::make_unique<ProjectionExecutor>(std::move(subplan_executor), x->sel_cols_);
         } else if(auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
             if(x->tag == T_SeqScan) {
+                size_t num_workers = 0;
+                if (parallel) {
+                    num_workers = ParallelSeqScanExecutor::choose_num_workers(sm_manager_->fhs_.at(x->tab_name_).get());
+                }
+                if (num_workers > 0) {
+                    return std::make_unique<ParallelSeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_, context,
+                                                                     num_workers);
+                }
                 return std::make_unique<SeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_, context);
             }
+            else if(x->tag == T_PointIndexScan) {
+                return std::make_unique<PointIndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, context);
+            }
+            else if(x->tag == T_IndexOnlyScan) {
+                return std::make_unique<IndexOnlyScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, context);
+            }
             else {
                 return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, context);
             } 
         } else if(auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+            if(x->tag == T_IndexNestLoop) {
+                auto inner = std::dynamic_pointer_cast<ScanPlan>(x->right_);
+                return std::make_unique<IndexNestedLoopJoinExecutor>(convert_plan_executor(x->left_, context), sm_manager_,
+                                                                     inner->tab_name_, inner->conds_, x->index_col_names_,
+                                                                     x->conds_, context);
+            }
             std::unique_ptr<AbstractExecutor> left = convert_plan_executor(x->left_, context);
             std::unique_ptr<AbstractExecutor> right = convert_plan_executor(x->right_, context);
 
@@ -180,7 +206,7 @@ class Portal
                                 sm_manager_->get_bpm());
             return join;
         } else if(auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
-            return std::make_unique<SortExecutor>(convert_plan_executor(x->subplan_, context), 
+            return std::make_unique<SortExecutor>(convert_plan_executor(x->subplan_, context, parallel), 
                                             x->order_cols_, x->limit_);
         }
         return nullptr;
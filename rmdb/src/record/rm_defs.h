@@ -17,14 +17,41 @@ constexpr int RM_NO_PAGE = -1;
 constexpr int RM_FILE_HDR_PAGE = 0;
 constexpr int RM_FIRST_RECORD_PAGE = 1;
 constexpr int RM_MAX_RECORD_SIZE = 512;
+constexpr int RM_MAX_VAR_COLS = 32;
+constexpr int RM_MAX_COLS = 64;
+
+/* 表数据文件的页面布局 */
+enum RmLayout {
+    RM_LAYOUT_FIXED = 0,    // 定长记录：bitmap + 等长slot
+    RM_LAYOUT_SLOTTED,      // 变长记录：slot目录从页头向后增长，记录数据从页尾向前增长
+    RM_LAYOUT_PAX           // 页内按列分组：bitmap + 每个字段一个mini page，同一字段的值连续存放
+};
+
+/* 字段在内存记录中的位置和类型，供记录层按字段访问页面 */
+struct RmColDesc {
+    int offset;     // 字段在内存记录中的偏移
+    int len;        // 字段长度
+    ColType type;   // 字段类型
+};
+
+/* 变长字段在内存记录中的位置，内存中的记录始终是定长的，只有落盘时才把变长字段压缩成(长度, 内容) */
+struct RmVarCol {
+    int offset;     // 字段在内存记录中的偏移
+    int len;        // 字段的最大长度
+};
 
 /* 文件头，记录表数据文件的元信息，写入磁盘中文件的第0号页面 */
 struct RmFileHdr {
-    int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
+    int record_size;            // 表中每条记录在内存中的大小，变长字段按最大长度计算，初始化后保持不变
     int num_pages;              // 文件中分配的页面个数（初始化为1）
-    int num_records_per_page;   // 每个页面最多能存储的元组个数
+    int num_records_per_page;   // 每个页面最多能存储的元组个数，slotted布局下为slot个数的上限
     int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
-    int bitmap_size;            // 每个页面bitmap大小
+    int bitmap_size;            // 每个页面bitmap大小，slotted布局下为0
+    int layout;                 // 页面布局，取值为RmLayout
+    int num_var_cols;           // 变长字段个数
+    RmVarCol var_cols[RM_MAX_VAR_COLS];     // 变长字段，按offset升序排列
+    int num_cols;               // 字段个数
+    RmColDesc cols[RM_MAX_COLS];            // 所有字段，按offset升序排列且首尾相接
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
@@ -27,7 +27,34 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
 
     // 获取指定记录所在的页面句柄
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-    
+
+    if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+        RmSlottedPageHandle slotted_page(page_handle.page);
+        if (!slotted_page.is_used(rid.slot_no) || (slotted_page.get_flags(rid.slot_no) & RM_SLOT_MOVED)) {
+            if (context != nullptr) {
+                LockDataId lock_data_id(fd_, rid, LockDataType::RECORD);
+                context->lock_mgr_->unlock(context->txn_, lock_data_id);
+            }
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            throw RecordNotFoundError(rid.page_no, rid.slot_no);
+        }
+        // 记录已被移到其他页面，顺着转发slot读取
+        if (slotted_page.get_flags(rid.slot_no) & RM_SLOT_FORWARD) {
+            Rid new_rid = *reinterpret_cast<Rid*>(slotted_page.get_data(rid.slot_no));
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            page_handle = fetch_page_handle(new_rid.page_no);
+            slotted_page = RmSlottedPageHandle(page_handle.page);
+            std::unique_ptr<RmRecord> ret_ptr = std::make_unique<RmRecord>(file_hdr_.record_size);
+            decode_record(slotted_page.get_data(new_rid.slot_no), slotted_page.get_len(new_rid.slot_no), ret_ptr->data);
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            return ret_ptr;
+        }
+        std::unique_ptr<RmRecord> ret_ptr = std::make_unique<RmRecord>(file_hdr_.record_size);
+        decode_record(slotted_page.get_data(rid.slot_no), slotted_page.get_len(rid.slot_no), ret_ptr->data);
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        return ret_ptr;
+    }
+
     // 检查记录是否存在
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
         if (context != nullptr) {
@@ -39,9 +66,9 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     }
 
     // 初始化记录指针
-    char* data = page_handle.get_slot(rid.slot_no);
     int record_size = page_handle.file_hdr->record_size;
-    std::unique_ptr<RmRecord> ret_ptr = std::make_unique<RmRecord>(record_size, data);
+    std::unique_ptr<RmRecord> ret_ptr = std::make_unique<RmRecord>(record_size);
+    page_handle.get_record_data(rid.slot_no, ret_ptr->data);
 
     // 解除页面的固定
     buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
@@ -63,6 +90,17 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
     // 4. 更新page_handle.page_hdr中的数据结构
     // 注意考虑插入一条记录后页面已满的情况，需要更新file_hdr_.first_free_page_no
 
+    if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+        char data[PAGE_SIZE];
+        int len = encode_record(buf, data);
+        Rid ret = insert_slotted(data, len, 0);
+        zone_map_.add_record(ret.page_no, buf);
+        if (context != nullptr) {
+            context->lock_mgr_->lock_exclusive_on_record(context->txn_, ret, fd_);
+        }
+        return ret;
+    }
+
     // 1.
     RmPageHandle free_page_handle = create_page_handle();
     page_id_t ret_page_no = free_page_handle.page->get_page_id().page_no;
@@ -75,8 +113,9 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
     }
     
     // 3.
-    char* des = free_page_handle.get_slot(free_slot_no);
-    memcpy(des,  buf, file_hdr_.record_size);
+    free_page_handle.page->wlatch();
+    free_page_handle.set_record_data(free_slot_no, buf);
+    zone_map_.add_record(ret_page_no, buf);
     Bitmap::set(free_page_handle.bitmap, free_slot_no);
     // 4.
     free_page_handle.page_hdr->num_records++;
@@ -87,6 +126,7 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
         disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char*)&file_hdr_,
             sizeof(file_hdr_));
     }
+    free_page_handle.page->wunlatch();
 
     Rid ret =  Rid{ret_page_no, free_slot_no};
 
@@ -101,16 +141,43 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
  */
 void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+        RmSlottedPageHandle slotted_page(page_handle.page);
+        if (slotted_page.is_used(rid.slot_no)) {
+            assert(0 && "ERROR RmFileHandle::insert_record this slot is already set.");
+        }
+        char data[PAGE_SIZE];
+        int len = encode_record(buf, data);
+        // 原页面放不下时，把记录放到其他页面，原slot改写成转发slot
+        page_handle.page->wlatch();
+        bool done = slotted_page.insert_at(rid.slot_no, data, len, 0);
+        page_handle.page->wunlatch();
+        if (!done) {
+            Rid new_rid = insert_slotted(data, len, RM_SLOT_MOVED);
+            page_handle.page->wlatch();
+            done = slotted_page.insert_at(rid.slot_no, (char*)&new_rid, sizeof(Rid), RM_SLOT_FORWARD);
+            page_handle.page->wunlatch();
+            if (!done) {
+                buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+                throw InternalError("RmFileHandle::insert_record: no space for forwarding slot");
+            }
+        }
+        zone_map_.add_record(rid.page_no, buf);
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+        return;
+    }
     char* bitmap = page_handle.bitmap;
     if(Bitmap::is_set(bitmap,rid.slot_no)){
         assert(0 && "ERROR RmFileHandle::insert_record this slot is already set.");
     }
     else {
-        char* slot_data = page_handle.get_slot(rid.slot_no);
-        memcpy(slot_data, buf, file_hdr_.record_size);
+        page_handle.page->wlatch();
+        page_handle.set_record_data(rid.slot_no, buf);
+        zone_map_.add_record(rid.page_no, buf);
         Bitmap::set(bitmap, rid.slot_no);
         // Update page header
         page_handle.page_hdr->num_records++;
+        page_handle.page->wunlatch();
 
         // Update file header
         if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
@@ -122,12 +189,16 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
                     buffer_pool_manager_->unpin_page(free_page_handle.page->get_page_id(), false);
                     free_page_handle = nxt_free_page_handle;
                 }
+                free_page_handle.page->wlatch();
                 free_page_handle.page_hdr->next_free_page_no = page_handle.page_hdr->next_free_page_no;
+                free_page_handle.page->wunlatch();
                 buffer_pool_manager_->unpin_page(free_page_handle.page->get_page_id(), false);
             }
             else {
                 file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
+                page_handle.page->wlatch();
                 page_handle.page_hdr->next_free_page_no = -1;
+                page_handle.page->wunlatch();
                 disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char*)&file_hdr_,
                     sizeof(file_hdr_));
             }
@@ -137,6 +208,88 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
 }
 
+/**
+ * @description: 批量追加记录，用于load data等批量导入场景
+ * 不经过空闲页链表，直接在文件末尾分配新页面并按槽位顺序写满，每个页面只需pin一次
+ * 最后一个未写满的页面会挂到空闲页链表头部，文件头只在结束时写回一次
+ * @param {char*} buf 连续存放的num_records条记录，每条记录长度为file_hdr_.record_size
+ * @param {int} num_records 记录数量
+ * @param {Rid*} rids 传出参数，依次存放每条记录的插入位置，长度不小于num_records
+ */
+void RmFileHandle::append_records(const char* buf, int num_records, Rid* rids) {
+    int record_size = file_hdr_.record_size;
+    if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+        char data[PAGE_SIZE];
+        int num_done = 0;
+        while (num_done < num_records) {
+            PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+            Page* page = buffer_pool_manager_->new_page(&page_id);
+            if (page == nullptr) {
+                throw InternalError("RmFileHandle::append_records: buffer pool is full");
+            }
+            RmSlottedPageHandle slotted_page(page);
+            slotted_page.init();
+            file_hdr_.num_pages++;
+            while (num_done < num_records) {
+                int len = encode_record(buf + (size_t)num_done * record_size, data);
+                int slot_no = slotted_page.insert(data, len, 0);
+                if (slot_no < 0) {
+                    break;
+                }
+                zone_map_.add_record(page_id.page_no, buf + (size_t)num_done * record_size);
+                rids[num_done++] = Rid{page_id.page_no, slot_no};
+            }
+            add_to_free_list(slotted_page);
+            buffer_pool_manager_->unpin_page(page_id, true);
+        }
+        disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char*)&file_hdr_, sizeof(file_hdr_));
+        return;
+    }
+    int records_per_page = file_hdr_.num_records_per_page;
+    int num_done = 0;
+    while (num_done < num_records) {
+        PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+        Page* page = buffer_pool_manager_->new_page(&page_id);
+        if (page == nullptr) {
+            throw InternalError("RmFileHandle::append_records: buffer pool is full");
+        }
+        RmPageHandle page_handle(&file_hdr_, page);
+        Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
+
+        int num_in_page = std::min(records_per_page, num_records - num_done);
+        const char* page_buf = buf + (size_t)num_done * record_size;
+        if (file_hdr_.layout == RM_LAYOUT_PAX) {
+            // 按字段写入，每个mini page只顺序写一遍
+            for (int i = 0; i < file_hdr_.num_cols; ++i) {
+                const RmColDesc& col = file_hdr_.cols[i];
+                char* dest = page_handle.get_field(0, col.offset, col.len);
+                for (int slot_no = 0; slot_no < num_in_page; ++slot_no) {
+                    memcpy(dest + slot_no * col.len, page_buf + (size_t)slot_no * record_size + col.offset, col.len);
+                }
+            }
+        } else {
+            memcpy(page_handle.slots, page_buf, (size_t)num_in_page * record_size);
+        }
+        for (int slot_no = 0; slot_no < num_in_page; ++slot_no) {
+            zone_map_.add_record(page_id.page_no, page_buf + (size_t)slot_no * record_size);
+            Bitmap::set(page_handle.bitmap, slot_no);
+            rids[num_done + slot_no] = Rid{page_id.page_no, slot_no};
+        }
+        page_handle.page_hdr->num_records = num_in_page;
+        file_hdr_.num_pages++;
+
+        if (num_in_page < records_per_page) {
+            page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
+            file_hdr_.first_free_page_no = page_id.page_no;
+        } else {
+            page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
+        }
+        buffer_pool_manager_->unpin_page(page_id, true);
+        num_done += num_in_page;
+    }
+    disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char*)&file_hdr_, sizeof(file_hdr_));
+}
+
 /**
  * @description: 删除记录文件中记录号为rid的记录
  * @param {Rid&} rid 要删除的记录的记录号（位置）
@@ -149,6 +302,35 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     // 注意考虑删除一条记录后页面未满的情况，需要调用release_page_handle()
 
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+        RmSlottedPageHandle slotted_page(page_handle.page);
+        if (!slotted_page.is_used(rid.slot_no) || (slotted_page.get_flags(rid.slot_no) & RM_SLOT_MOVED)) {
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            throw RecordNotFoundError(rid.page_no, rid.slot_no);
+        }
+        if (context != nullptr) {
+            context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
+        }
+        // 先删除转发到其他页面的记录
+        if (slotted_page.get_flags(rid.slot_no) & RM_SLOT_FORWARD) {
+            Rid new_rid = *reinterpret_cast<Rid*>(slotted_page.get_data(rid.slot_no));
+            RmSlottedPageHandle moved_page(fetch_page_handle(new_rid.page_no).page);
+            moved_page.page->wlatch();
+            moved_page.erase(new_rid.slot_no);
+            moved_page.page->wunlatch();
+            add_to_free_list(moved_page);
+            buffer_pool_manager_->unpin_page(moved_page.page->get_page_id(), true);
+        }
+        page_handle.page->wlatch();
+        slotted_page.erase(rid.slot_no);
+        page_handle.page->wunlatch();
+        if (slotted_page.page_hdr->num_records == 0) {
+            zone_map_.clear_page(rid.page_no);
+        }
+        add_to_free_list(slotted_page);
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+        return;
+    }
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
         throw new RecordNotFoundError(rid.page_no, rid.slot_no);
     }
@@ -158,10 +340,7 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
         context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
     }
 
-    // 获取要删除的记录数据
-    char* slot_data = page_handle.get_slot(rid.slot_no);
-    RmRecord del_rec(file_hdr_.record_size, slot_data);
-
+    page_handle.page->wlatch();
     Bitmap::reset(page_handle.bitmap, rid.slot_no);
     // Update file header
     if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
@@ -169,6 +348,10 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     }
     // Update page header
     page_handle.page_hdr->num_records--;
+    page_handle.page->wunlatch();
+    if (page_handle.page_hdr->num_records == 0) {
+        zone_map_.clear_page(rid.page_no);
+    }
 
     buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
 }
@@ -186,24 +369,139 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     // 2. 更新记录
 
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+        RmSlottedPageHandle slotted_page(page_handle.page);
+        if (!slotted_page.is_used(rid.slot_no) || (slotted_page.get_flags(rid.slot_no) & RM_SLOT_MOVED)) {
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            throw RecordNotFoundError(rid.page_no, rid.slot_no);
+        }
+        if (context != nullptr) {
+            context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
+        }
+        char data[PAGE_SIZE];
+        int len = encode_record(buf, data);
+        zone_map_.add_record(rid.page_no, buf);
+        if (slotted_page.get_flags(rid.slot_no) & RM_SLOT_FORWARD) {
+            // 先尝试在记录当前所在的页面上原地更新，放不下再考虑搬回原页面或者搬到新页面
+            Rid moved_rid = *reinterpret_cast<Rid*>(slotted_page.get_data(rid.slot_no));
+            RmSlottedPageHandle moved_page(fetch_page_handle(moved_rid.page_no).page);
+            moved_page.page->wlatch();
+            bool done = moved_page.update(moved_rid.slot_no, data, len);
+            if (!done) {
+                moved_page.erase(moved_rid.slot_no);
+            }
+            moved_page.page->wunlatch();
+            if (!done) {
+                add_to_free_list(moved_page);
+            }
+            buffer_pool_manager_->unpin_page(moved_page.page->get_page_id(), true);
+            if (!done) {
+                page_handle.page->wlatch();
+                done = slotted_page.update(rid.slot_no, data, len);
+                if (done) {
+                    slotted_page.set_flags(rid.slot_no, 0);
+                }
+                page_handle.page->wunlatch();
+            }
+            if (!done) {
+                Rid new_rid = insert_slotted(data, len, RM_SLOT_MOVED);
+                page_handle.page->wlatch();
+                slotted_page.update(rid.slot_no, (char*)&new_rid, sizeof(Rid));
+                page_handle.page->wunlatch();
+            }
+        } else {
+            page_handle.page->wlatch();
+            bool done = slotted_page.update(rid.slot_no, data, len);
+            page_handle.page->wunlatch();
+            if (!done) {
+                // 页面放不下更新后的记录，搬到其他页面，原slot改写成转发slot，rid保持不变
+                Rid new_rid = insert_slotted(data, len, RM_SLOT_MOVED);
+                page_handle.page->wlatch();
+                slotted_page.update(rid.slot_no, (char*)&new_rid, sizeof(Rid));
+                slotted_page.set_flags(rid.slot_no, RM_SLOT_FORWARD);
+                page_handle.page->wunlatch();
+            }
+        }
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+        return;
+    }
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
         throw new RecordNotFoundError(rid.page_no, rid.slot_no);
     }
-    // 获取要更新的记录数据
-    char* slot_data = page_handle.get_slot(rid.slot_no);
-    RmRecord old_rec(file_hdr_.record_size, slot_data);
-    RmRecord new_rec(file_hdr_.record_size, buf);
-
     // 先加互斥锁
     if(context != nullptr) {
         context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
     }
     
-    memcpy(slot_data, buf, file_hdr_.record_size);
+    page_handle.page->wlatch();
+    page_handle.set_record_data(rid.slot_no, buf);
+    page_handle.page->wunlatch();
+    zone_map_.add_record(rid.page_no, buf);
 
     buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
 }
 
+/**
+ * @description: 在页面读锁下把页面内容拷贝到out中，用于与修改并发执行的扫描
+ * 修改记录时持有页面写锁，拷贝出来的页面中不会有修改了一半的记录，之后读取out不再需要加锁
+ * @param {int} page_no 页面号
+ * @param {Page*} out 传出参数，页面内容的拷贝
+ */
+void RmFileHandle::snapshot_page(int page_no, Page* out) const {
+    RmPageHandle page_handle = fetch_page_handle(page_no);
+    page_handle.page->rlatch();
+    memcpy(out->get_data(), page_handle.page->get_data(), PAGE_SIZE);
+    page_handle.page->runlatch();
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+}
+
+/**
+ * @description: slotted布局下从snapshot_page()得到的页面拷贝中读取rid上的记录
+ * 转发slot指向的记录在其他页面上，先在该页面的读锁下读出记录，再确认原页面上的转发slot仍指向它，
+ * 期间记录被并发地搬走时重新读取。两个页面的锁不同时持有，与修改记录时的加锁顺序无关
+ * @return {bool} 记录在拷贝之后被并发删除时返回false
+ * @param {Page*} snapshot rid.page_no页面的拷贝
+ * @param {Rid&} rid 记录号，拷贝中该slot上存放了记录或者转发slot
+ * @param {char*} out 传出参数，定长记录，长度为file_hdr_.record_size
+ */
+bool RmFileHandle::read_snapshot_record(Page* snapshot, const Rid& rid, char* out) const {
+    RmSlottedPageHandle slotted_page(snapshot);
+    if (!(slotted_page.get_flags(rid.slot_no) & RM_SLOT_FORWARD)) {
+        decode_record(slotted_page.get_data(rid.slot_no), slotted_page.get_len(rid.slot_no), out);
+        return true;
+    }
+    Rid moved_rid = *reinterpret_cast<Rid*>(slotted_page.get_data(rid.slot_no));
+    while (true) {
+        RmSlottedPageHandle moved_page(fetch_page_handle(moved_rid.page_no).page);
+        moved_page.page->rlatch();
+        bool found = moved_page.is_used(moved_rid.slot_no) && (moved_page.get_flags(moved_rid.slot_no) & RM_SLOT_MOVED);
+        if (found) {
+            decode_record(moved_page.get_data(moved_rid.slot_no), moved_page.get_len(moved_rid.slot_no), out);
+        }
+        moved_page.page->runlatch();
+        buffer_pool_manager_->unpin_page(moved_page.page->get_page_id(), false);
+
+        // 重新读取原页面上的slot，仍是指向同一位置的转发slot时读到的就是这条记录
+        RmSlottedPageHandle orig_page(fetch_page_handle(rid.page_no).page);
+        orig_page.page->rlatch();
+        bool exists = orig_page.is_used(rid.slot_no) && !(orig_page.get_flags(rid.slot_no) & RM_SLOT_MOVED);
+        bool forwarded = exists && (orig_page.get_flags(rid.slot_no) & RM_SLOT_FORWARD);
+        Rid cur_rid = forwarded ? *reinterpret_cast<Rid*>(orig_page.get_data(rid.slot_no)) : Rid{};
+        if (exists && !forwarded) {
+            decode_record(orig_page.get_data(rid.slot_no), orig_page.get_len(rid.slot_no), out);
+        }
+        orig_page.page->runlatch();
+        buffer_pool_manager_->unpin_page(orig_page.page->get_page_id(), false);
+        if (!exists) {
+            return false;
+        }
+        if (!forwarded || (found && cur_rid == moved_rid)) {
+            return true;
+        }
+        moved_rid = cur_rid;
+    }
+}
+
 /**
  * 以下函数为辅助函数，仅提供参考，可以选择完成如下函数，也可以删除如下函数，在单元测试中不涉及如下函数接口的直接调用
 */
@@ -251,8 +549,14 @@ RmPageHandle RmFileHandle::create_new_page_handle() {
 
     // 2.
     RmPageHandle page_handle(&file_hdr_, page);
+    if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+        RmSlottedPageHandle slotted_page(page);
+        slotted_page.init();
+        slotted_page.hdr->in_free_list = 1;
+    } else {
+        Bitmap::init(page_handle.bitmap, page_handle.file_hdr->bitmap_size);
+    }
     page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    Bitmap::init(page_handle.bitmap, page_handle.file_hdr->bitmap_size);
     page_handle.page_hdr->num_records = 0;
 
     // 3.
@@ -300,4 +604,181 @@ void RmFileHandle::release_page_handle(RmPageHandle&page_handle) {
         // 将更新后的文件头写回磁盘
         disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char*)&file_hdr_, sizeof(file_hdr_));
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @description: slotted布局下一条记录编码后的最大长度
+ */
+int RmFileHandle::max_encoded_size() const {
+    int size = file_hdr_.record_size;
+    for (int i = 0; i < file_hdr_.num_var_cols; ++i) {
+        size += sizeof(uint16_t);
+    }
+    return size;
+}
+
+/**
+ * @description: 把内存中的定长记录编码成落盘格式：先依次存放所有定长字段，
+ * 再依次存放每个变长字段的(uint16长度, 内容)，内容不包括末尾补齐的'\0'
+ * @param {char*} rec 定长记录
+ * @param {char*} out 传出参数，编码后的记录，空间不小于max_encoded_size()
+ * @return {int} 编码后的长度
+ */
+int RmFileHandle::encode_record(const char* rec, char* out) const {
+    char* pos = out;
+    int rec_offset = 0;
+    for (int i = 0; i < file_hdr_.num_var_cols; ++i) {
+        const RmVarCol& col = file_hdr_.var_cols[i];
+        memcpy(pos, rec + rec_offset, col.offset - rec_offset);
+        pos += col.offset - rec_offset;
+        rec_offset = col.offset + col.len;
+    }
+    memcpy(pos, rec + rec_offset, file_hdr_.record_size - rec_offset);
+    pos += file_hdr_.record_size - rec_offset;
+    for (int i = 0; i < file_hdr_.num_var_cols; ++i) {
+        const RmVarCol& col = file_hdr_.var_cols[i];
+        uint16_t len = strnlen(rec + col.offset, col.len);
+        memcpy(pos, &len, sizeof(uint16_t));
+        memcpy(pos + sizeof(uint16_t), rec + col.offset, len);
+        pos += sizeof(uint16_t) + len;
+    }
+    return pos - out;
+}
+
+/**
+ * @description: encode_record()的逆过程，把落盘格式的记录还原成定长记录
+ * @param {char*} data 编码后的记录
+ * @param {int} len 编码后的长度
+ * @param {char*} out 传出参数，定长记录，长度为file_hdr_.record_size
+ */
+void RmFileHandle::decode_record(const char* data, int len, char* out) const {
+    if (file_hdr_.num_var_cols == 0) {
+        memcpy(out, data, len);
+        return;
+    }
+    const char* pos = data;
+    int rec_offset = 0;
+    for (int i = 0; i < file_hdr_.num_var_cols; ++i) {
+        const RmVarCol& col = file_hdr_.var_cols[i];
+        memcpy(out + rec_offset, pos, col.offset - rec_offset);
+        pos += col.offset - rec_offset;
+        rec_offset = col.offset + col.len;
+    }
+    memcpy(out + rec_offset, pos, file_hdr_.record_size - rec_offset);
+    pos += file_hdr_.record_size - rec_offset;
+    for (int i = 0; i < file_hdr_.num_var_cols; ++i) {
+        const RmVarCol& col = file_hdr_.var_cols[i];
+        uint16_t col_len;
+        memcpy(&col_len, pos, sizeof(uint16_t));
+        memcpy(out + col.offset, pos + sizeof(uint16_t), col_len);
+        memset(out + col.offset + col_len, 0, col.len - col_len);
+        pos += sizeof(uint16_t) + col_len;
+    }
+}
+
+/**
+ * @description: slotted布局下插入一条已编码的记录，从空闲页链表头部开始找能放下的页面
+ * 页面剩余空间不足以放下一条最长的记录时就从链表中摘下，链表为空时分配新页面
+ * @param {char*} data 编码后的记录
+ * @param {int} len 编码后的长度
+ * @param {uint16_t} flags slot标记位
+ * @return {Rid} 插入的位置
+ */
+Rid RmFileHandle::insert_slotted(const char* data, int len, uint16_t flags) {
+    while (true) {
+        RmSlottedPageHandle slotted_page(create_page_handle().page);
+        slotted_page.page->wlatch();
+        int slot_no = slotted_page.insert(data, len, flags);
+        slotted_page.page->wunlatch();
+        if (slot_no < 0) {
+            remove_from_free_list(slotted_page);
+            buffer_pool_manager_->unpin_page(slotted_page.page->get_page_id(), true);
+            continue;
+        }
+        Rid ret = Rid{slotted_page.page->get_page_id().page_no, slot_no};
+        if (slotted_page.free_space() < max_encoded_size() + (int)sizeof(RmSlot)) {
+            remove_from_free_list(slotted_page);
+        }
+        buffer_pool_manager_->unpin_page(slotted_page.page->get_page_id(), true);
+        return ret;
+    }
+}
+
+/**
+ * @description: 页面空闲空间足够放下一条最长的记录时，把它挂到空闲页链表的头部
+ */
+void RmFileHandle::add_to_free_list(RmSlottedPageHandle& slotted_page) {
+    if (slotted_page.hdr->in_free_list || slotted_page.free_space() < max_encoded_size() + (int)sizeof(RmSlot)) {
+        return;
+    }
+    slotted_page.page->wlatch();
+    slotted_page.hdr->in_free_list = 1;
+    slotted_page.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
+    slotted_page.page->wunlatch();
+    file_hdr_.first_free_page_no = slotted_page.page->get_page_id().page_no;
+    disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char*)&file_hdr_, sizeof(file_hdr_));
+}
+
+/**
+ * @description: 把页面从空闲页链表中摘下
+ */
+void RmFileHandle::remove_from_free_list(RmSlottedPageHandle& slotted_page) {
+    if (!slotted_page.hdr->in_free_list) {
+        return;
+    }
+    int page_no = slotted_page.page->get_page_id().page_no;
+    if (file_hdr_.first_free_page_no == page_no) {
+        file_hdr_.first_free_page_no = slotted_page.page_hdr->next_free_page_no;
+        disk_manager_->write_page(fd_, RM_FILE_HDR_PAGE, (char*)&file_hdr_, sizeof(file_hdr_));
+    } else {
+        RmPageHandle prev = fetch_page_handle(file_hdr_.first_free_page_no);
+        while (prev.page_hdr->next_free_page_no != page_no) {
+            RmPageHandle next = fetch_page_handle(prev.page_hdr->next_free_page_no);
+            buffer_pool_manager_->unpin_page(prev.page->get_page_id(), false);
+            prev = next;
+        }
+        prev.page->wlatch();
+        prev.page_hdr->next_free_page_no = slotted_page.page_hdr->next_free_page_no;
+        prev.page->wunlatch();
+        buffer_pool_manager_->unpin_page(prev.page->get_page_id(), true);
+    }
+    slotted_page.page->wlatch();
+    slotted_page.page_hdr->next_free_page_no = RM_NO_PAGE;
+    slotted_page.hdr->in_free_list = 0;
+    slotted_page.page->wunlatch();
+}
+
+/**
+ * @description: 扫描整个文件重建zone map，用于摘要文件不存在或者已经失效的情况
+ */
+void RmFileHandle::rebuild_zone_map() {
+    zone_map_.init(file_hdr_);
+    if (!zone_map_.enabled()) {
+        return;
+    }
+    std::vector<char> rec(file_hdr_.record_size);
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr_.num_pages; ++page_no) {
+        RmPageHandle page_handle = fetch_page_handle(page_no);
+        if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+            // 被搬走的记录要顺着转发slot读取，先收集rid再逐条读
+            std::vector<Rid> rids;
+            RmSlottedPageHandle slotted_page(page_handle.page);
+            for (int slot_no = slotted_page.next_record(-1); slot_no < slotted_page.hdr->num_slots;
+                 slot_no = slotted_page.next_record(slot_no)) {
+                rids.push_back(Rid{page_no, slot_no});
+            }
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            for (auto& rid : rids) {
+                zone_map_.add_record(page_no, get_record(rid, nullptr)->data);
+            }
+            continue;
+        }
+        for (int slot_no = Bitmap::first_bit(1, page_handle.bitmap, file_hdr_.num_records_per_page);
+             slot_no < file_hdr_.num_records_per_page;
+             slot_no = Bitmap::next_bit(1, page_handle.bitmap, file_hdr_.num_records_per_page, slot_no)) {
+            page_handle.get_record_data(slot_no, rec.data());
+            zone_map_.add_record(page_no, rec.data());
+        }
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+    }
+}
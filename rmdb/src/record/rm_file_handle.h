@@ -17,6 +17,8 @@ See the Mulan PSL v2 for more details. */
 #include "bitmap.h"
 #include "common/context.h"
 #include "rm_defs.h"
+#include "rm_slotted_page.h"
+#include "rm_zone_map.h"
 
 class RmManager;
 
@@ -38,6 +40,39 @@ struct RmPageHandle {
     char* get_slot(int slot_no) const {
         return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
     }
+
+    // 返回指定slot_no上记录中某个字段的地址，pax布局下每个字段的值存放在各自的mini page中
+    char* get_field(int slot_no, int offset, int len) const {
+        if (file_hdr->layout == RM_LAYOUT_PAX) {
+            // 字段在记录中首尾相接，所以offset之前的字段恰好占用num_records_per_page * offset字节
+            return slots + file_hdr->num_records_per_page * offset + slot_no * len;
+        }
+        return get_slot(slot_no) + offset;
+    }
+
+    // 把指定slot_no上的记录拷贝到out中
+    void get_record_data(int slot_no, char* out) const {
+        if (file_hdr->layout == RM_LAYOUT_PAX) {
+            for (int i = 0; i < file_hdr->num_cols; ++i) {
+                const RmColDesc &col = file_hdr->cols[i];
+                memcpy(out + col.offset, get_field(slot_no, col.offset, col.len), col.len);
+            }
+        } else {
+            memcpy(out, get_slot(slot_no), file_hdr->record_size);
+        }
+    }
+
+    // 把buf写入指定slot_no
+    void set_record_data(int slot_no, const char* buf) {
+        if (file_hdr->layout == RM_LAYOUT_PAX) {
+            for (int i = 0; i < file_hdr->num_cols; ++i) {
+                const RmColDesc &col = file_hdr->cols[i];
+                memcpy(get_field(slot_no, col.offset, col.len), buf + col.offset, col.len);
+            }
+        } else {
+            memcpy(get_slot(slot_no), buf, file_hdr->record_size);
+        }
+    }
 };
 
 /* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
@@ -50,6 +85,7 @@ class RmFileHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    RmZoneMap zone_map_;    // 每个页面的min/max摘要，只在内存中维护，关闭文件时由RmManager写到旁路文件
 
    public:
     RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
@@ -60,15 +96,28 @@ class RmFileHandle {
         disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+        zone_map_.init(file_hdr_);
     }
 
     RmFileHdr get_file_hdr() { return file_hdr_; }
+
+    const RmZoneMap &get_zone_map() const { return zone_map_; }
+
+    void rebuild_zone_map();
     int GetFd() { return fd_; }
 
-    /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
+    /* 判断指定位置上是否已经存在一条记录，定长布局通过Bitmap来判断，slotted布局通过slot目录来判断 */
     bool is_record(const Rid &rid) const {
         RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-        return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        bool ret;
+        if (file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+            RmSlottedPageHandle slotted_page(page_handle.page);
+            ret = slotted_page.is_used(rid.slot_no) && !(slotted_page.get_flags(rid.slot_no) & RM_SLOT_MOVED);
+        } else {
+            ret = Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        }
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        return ret;
     }
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
@@ -77,6 +126,8 @@ class RmFileHandle {
 
     void insert_record(const Rid &rid, char *buf);
 
+    void append_records(const char *buf, int num_records, Rid *rids);
+
     void delete_record(const Rid &rid, Context *context);
 
     void update_record(const Rid &rid, char *buf, Context *context);
@@ -85,8 +136,25 @@ class RmFileHandle {
 
     RmPageHandle fetch_page_handle(int page_no) const;
 
+    void snapshot_page(int page_no, Page *out) const;
+
+    bool read_snapshot_record(Page *snapshot, const Rid &rid, char *out) const;
+
    private:
     RmPageHandle create_page_handle();
 
     void release_page_handle(RmPageHandle &page_handle);
+
+    // 以下为slotted布局使用的辅助函数
+    int max_encoded_size() const;
+
+    int encode_record(const char *rec, char *out) const;
+
+    void decode_record(const char *data, int len, char *out) const;
+
+    Rid insert_slotted(const char *data, int len, uint16_t flags);
+
+    void add_to_free_list(RmSlottedPageHandle &slotted_page);
+
+    void remove_from_free_list(RmSlottedPageHandle &slotted_page);
 };
\ No newline at end of file
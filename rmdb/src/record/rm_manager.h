@@ -12,6 +12,9 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <cstdio>
+#include <fstream>
+
 #include "bitmap.h"
 #include "rm_defs.h"
 #include "rm_file_handle.h"
@@ -30,11 +33,23 @@ class RmManager {
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
      * @param {int} record_size 表中记录的大小
+     * @param {RmLayout} layout 页面布局
+     * @param {vector<RmColDesc>&} cols 表的所有字段，按offset升序排列，slotted和pax布局必须提供
      */ 
-    void create_file(const std::string& filename, int record_size) {
+    void create_file(const std::string& filename, int record_size, RmLayout layout = RM_LAYOUT_FIXED,
+                     const std::vector<RmColDesc>& cols = {}) {
         if (record_size < 1 || record_size > RM_MAX_RECORD_SIZE) {
             throw InvalidRecordSizeError(record_size);
         }
+        std::vector<RmVarCol> var_cols;
+        for (auto& col : cols) {
+            if (col.type == TYPE_VARCHAR) {
+                var_cols.push_back({.offset = col.offset, .len = col.len});
+            }
+        }
+        if (cols.size() > RM_MAX_COLS || var_cols.size() > RM_MAX_VAR_COLS) {
+            throw InternalError("RmManager::create_file: too many columns");
+        }
         disk_manager_->create_file(filename);
         int fd = disk_manager_->open_file(filename);
 
@@ -43,10 +58,23 @@ class RmManager {
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
-        file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
-        file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        file_hdr.layout = layout;
+        file_hdr.num_cols = cols.size();
+        std::copy(cols.begin(), cols.end(), file_hdr.cols);
+        if (layout == RM_LAYOUT_SLOTTED) {
+            // slotted布局不使用bitmap，num_records_per_page只是slot编号的上限
+            file_hdr.num_records_per_page = RmSlottedPageHandle::max_slots();
+            file_hdr.bitmap_size = 0;
+            file_hdr.num_var_cols = var_cols.size();
+            std::copy(var_cols.begin(), var_cols.end(), file_hdr.var_cols);
+        } else {
+            // pax布局与定长布局的页面容量相同，只是把n个slot按字段拆成若干个mini page
+            // We have: sizeof(page hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
+            int page_hdr_size = Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr);
+            file_hdr.num_records_per_page =
+                (BITMAP_WIDTH * (PAGE_SIZE - 1 - page_hdr_size) + 1) / (1 + record_size * BITMAP_WIDTH);
+            file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        }
 
         // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
         // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
@@ -58,7 +86,10 @@ class RmManager {
      * @description: 删除表的数据文件
      * @param {string&} filename 要删除的文件名称
      */    
-    void destroy_file(const std::string& filename) { disk_manager_->destroy_file(filename); }
+    void destroy_file(const std::string& filename) {
+        disk_manager_->destroy_file(filename);
+        std::remove(get_zone_map_name(filename).c_str());
+    }
 
     // 注意这里打开文件，创建并返回了record file handle的指针
     /**
@@ -68,17 +99,36 @@ class RmManager {
      */
     std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        auto file_handle = std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        // zone map文件只在正常关闭时写出，读入后立即删除，这样异常退出后再打开时会扫描全表重建
+        if (file_handle->zone_map_.enabled()) {
+            std::string zone_map_name = get_zone_map_name(filename);
+            std::ifstream ifs(zone_map_name, std::ios::binary);
+            if (!ifs.is_open() || !file_handle->zone_map_.deserialize(ifs)) {
+                file_handle->rebuild_zone_map();
+            }
+            ifs.close();
+            std::remove(zone_map_name.c_str());
+        }
+        return file_handle;
     }
     /**
      * @description: 关闭表的数据文件
      * @param {RmFileHandle*} file_handle 要关闭文件的句柄
      */
     void close_file(const RmFileHandle* file_handle) {
+        if (file_handle->zone_map_.enabled()) {
+            std::ofstream ofs(get_zone_map_name(disk_manager_->get_file_name(file_handle->fd_)), std::ios::binary);
+            file_handle->zone_map_.serialize(ofs);
+        }
         disk_manager_->write_page(file_handle->fd_, RM_FILE_HDR_PAGE, (char *)&file_handle->file_hdr_,
                                   sizeof(file_handle->file_hdr_));
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(file_handle->fd_);
         disk_manager_->close_file(file_handle->fd_);
     }
+
+   private:
+    // 表数据文件对应的zone map文件
+    static std::string get_zone_map_name(const std::string& filename) { return filename + ".zm"; }
 };
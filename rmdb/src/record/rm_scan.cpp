@@ -9,17 +9,22 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "rm_scan.h"
+
+#include <algorithm>
+
 #include "rm_file_handle.h"
 
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+RmScan::RmScan(const RmFileHandle *file_handle, std::vector<RmScanFilter> filters, std::vector<RmZoneRange> ranges,
+               int start_page, int end_page)
+    : file_handle_(file_handle), filters_(std::move(filters)), ranges_(std::move(ranges)), end_page_(end_page) {
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
 
-    rid_ = Rid({ RM_FIRST_RECORD_PAGE,-1 });
+    rid_ = Rid({ start_page,-1 });
     next();
 }
 
@@ -29,11 +34,25 @@ RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
 void RmScan::next() {
     // Todo:
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
-    while (rid_.page_no < file_handle_->file_hdr_.num_pages) {
+    while (rid_.page_no < end_page()) {
+        // 刚进入一个页面时先查zone map，整页都不满足条件就不用读这个页面
+        if (rid_.slot_no == -1 && !ranges_.empty() && !file_handle_->zone_map_.may_contain(rid_.page_no, ranges_)) {
+            rid_.page_no++;
+            continue;
+        }
         RmPageHandle page_handle = file_handle_->fetch_page_handle(rid_.page_no);
-        rid_.slot_no = Bitmap::next_bit(1, page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page, rid_.slot_no);
-        
-        if (rid_.slot_no < file_handle_->file_hdr_.num_records_per_page) {
+        int num_slots;
+        if (file_handle_->file_hdr_.layout == RM_LAYOUT_SLOTTED) {
+            // slotted布局跳过空slot和从其他页面搬过来的记录，后者通过原页面上的转发slot访问
+            RmSlottedPageHandle slotted_page(page_handle.page);
+            num_slots = slotted_page.hdr->num_slots;
+            rid_.slot_no = slotted_page.next_record(rid_.slot_no);
+        } else {
+            num_slots = file_handle_->file_hdr_.num_records_per_page;
+            rid_.slot_no = next_slot(page_handle, rid_.slot_no);
+        }
+
+        if (rid_.slot_no < num_slots) {
             file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
             return;
         }
@@ -44,15 +63,68 @@ void RmScan::next() {
     }
 }
 
+/* 定长布局的页面中slot_no之后下一个存放了记录且满足全部过滤条件的slot，没有时返回每页的记录数 */
+int RmScan::next_slot(const RmPageHandle &page_handle, int slot_no) const {
+    int num_slots = file_handle_->file_hdr_.num_records_per_page;
+    slot_no = Bitmap::next_bit(1, page_handle.bitmap, num_slots, slot_no);
+    while (slot_no < num_slots && !std::all_of(filters_.begin(), filters_.end(), [&](const RmScanFilter &f) {
+               return f.pred(page_handle.get_field(slot_no, f.offset, f.len));
+           })) {
+        slot_no = Bitmap::next_bit(1, page_handle.bitmap, num_slots, slot_no);
+    }
+    return slot_no;
+}
+
+/**
+ * @description: 从当前位置开始连续取出最多max_records条记录，之后指向下一条还没有取出的记录
+ * 定长布局下同一个页面中的记录只固定一次页面就全部拷贝出来；slotted布局的记录需要解码，仍逐条读取
+ * @return 取出的记录条数，记录依次写入out，位置写入rids
+ * @param out 至少能存放max_records条记录的缓冲区
+ */
+int RmScan::next_batch(char *out, Rid *rids, int max_records) {
+    const RmFileHdr &file_hdr = file_handle_->file_hdr_;
+    int n = 0;
+    while (n < max_records && !is_end()) {
+        if (file_hdr.layout == RM_LAYOUT_SLOTTED) {
+            auto rec = file_handle_->get_record(rid_, nullptr);
+            memcpy(out + (size_t)n * file_hdr.record_size, rec->data, file_hdr.record_size);
+            rids[n++] = rid_;
+            next();
+            continue;
+        }
+        RmPageHandle page_handle = file_handle_->fetch_page_handle(rid_.page_no);
+        int slot_no = rid_.slot_no;
+        while (n < max_records && slot_no < file_hdr.num_records_per_page) {
+            page_handle.get_record_data(slot_no, out + (size_t)n * file_hdr.record_size);
+            rids[n++] = Rid{rid_.page_no, slot_no};
+            slot_no = next_slot(page_handle, slot_no);
+        }
+        file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        if (slot_no < file_hdr.num_records_per_page) {
+            rid_.slot_no = slot_no;
+        } else {
+            rid_.page_no++;
+            rid_.slot_no = -1;
+            next();
+        }
+    }
+    return n;
+}
+
 /**
  * @brief ​ 判断是否到达文件末尾
  */
 bool RmScan::is_end() const {
     // Todo: 修改返回值
-    if (rid_.page_no >= file_handle_->file_hdr_.num_pages) return true;
+    if (rid_.page_no >= end_page()) return true;
     return false;
 }
 
+int RmScan::end_page() const {
+    int num_pages = file_handle_->file_hdr_.num_pages;
+    return end_page_ < 0 ? num_pages : std::min(end_page_, num_pages);
+}
+
 /**
  * @brief RmScan内部存放的rid
  */
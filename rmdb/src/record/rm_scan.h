@@ -10,19 +10,43 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "rm_defs.h"
+#include "rm_zone_map.h"
 
 class RmFileHandle;
+struct RmPageHandle;
+
+/* 扫描时直接在页面上对单个字段做的过滤，不满足的记录不会被返回
+ * pax布局下只会访问该字段所在的mini page；slotted布局的记录需要解码，因此不使用过滤 */
+struct RmScanFilter {
+    int offset;                             // 字段在记录中的偏移
+    int len;                                // 字段长度
+    std::function<bool(const char *)> pred; // 参数为字段值的地址
+};
 
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    std::vector<RmScanFilter> filters_;
+    std::vector<RmZoneRange> ranges_;   // 根据zone map跳过不可能满足这些范围的页面
+    int end_page_;                      // 只扫描[start_page, end_page)范围内的页面，-1表示扫描到文件末尾
 public:
-    RmScan(const RmFileHandle *file_handle);
+    RmScan(const RmFileHandle *file_handle, std::vector<RmScanFilter> filters = {},
+           std::vector<RmZoneRange> ranges = {}, int start_page = RM_FIRST_RECORD_PAGE, int end_page = -1);
 
     void next() override;
 
     bool is_end() const override;
 
     Rid rid() const override;
+
+    int next_batch(char *out, Rid *rids, int max_records);
+
+private:
+    int end_page() const;
+
+    int next_slot(const RmPageHandle &page_handle, int slot_no) const;
 };
@@ -0,0 +1,204 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "rm_defs.h"
+
+// slot的len字段中高位用作标记
+constexpr uint16_t RM_SLOT_FORWARD = 0x8000;    // 记录已被移到其他页面，slot中存放的是新位置的Rid
+constexpr uint16_t RM_SLOT_MOVED = 0x4000;      // 记录是从其他页面移过来的，真正的rid是原页面上的转发slot
+constexpr uint16_t RM_SLOT_LEN_MASK = 0x1fff;
+
+/* slot目录中的一项，offset为0表示空slot */
+struct RmSlot {
+    uint16_t offset;    // 记录数据在页面中的偏移
+    uint16_t len;       // 记录数据的长度及标记位
+};
+
+/* slotted页面的页头，紧跟在RmPageHdr之后 */
+struct RmSlottedPageHdr {
+    int num_slots;          // slot目录的项数（包括空slot）
+    int free_space_end;     // 空闲空间的结束位置，也就是记录数据区的起始位置
+    int in_free_list;       // 页面当前是否挂在文件的空闲页链表上
+};
+
+/* 对slotted布局的页面进行封装：
+ * | lsn | RmPageHdr | RmSlottedPageHdr | slot[0] slot[1] ... -> | 空闲空间 | <- ... 记录数据 |
+ * 记录被删除后只清空slot，数据区中留下的空洞在空闲空间不足时通过compact()整理，
+ * 整理只移动数据、不改变slot编号，因此Rid保持稳定 */
+struct RmSlottedPageHandle {
+    Page *page;
+    RmPageHdr *page_hdr;
+    RmSlottedPageHdr *hdr;
+    RmSlot *slots;
+
+    static constexpr int HDR_END = Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr) + sizeof(RmSlottedPageHdr);
+
+    RmSlottedPageHandle(Page *page_) : page(page_) {
+        page_hdr = reinterpret_cast<RmPageHdr *>(page->get_data() + page->OFFSET_PAGE_HDR);
+        hdr = reinterpret_cast<RmSlottedPageHdr *>(page->get_data() + page->OFFSET_PAGE_HDR + sizeof(RmPageHdr));
+        slots = reinterpret_cast<RmSlot *>(page->get_data() + HDR_END);
+    }
+
+    // 每条记录至少占用一个Rid的空间，保证记录被移走后原地可以改写成转发slot
+    static int alloc_size(int len) { return std::max(len, (int)sizeof(Rid)); }
+
+    // 一个空页面最多能容纳的slot个数
+    static int max_slots() { return (PAGE_SIZE - HDR_END) / (sizeof(RmSlot) + sizeof(Rid)); }
+
+    void init() {
+        page_hdr->next_free_page_no = RM_NO_PAGE;
+        page_hdr->num_records = 0;
+        hdr->num_slots = 0;
+        hdr->free_space_end = PAGE_SIZE;
+        hdr->in_free_list = 0;
+    }
+
+    bool is_used(int slot_no) const { return slot_no >= 0 && slot_no < hdr->num_slots && slots[slot_no].offset != 0; }
+
+    uint16_t get_flags(int slot_no) const { return slots[slot_no].len & ~RM_SLOT_LEN_MASK; }
+
+    void set_flags(int slot_no, uint16_t flags) {
+        slots[slot_no].len = (slots[slot_no].len & RM_SLOT_LEN_MASK) | flags;
+    }
+
+    int get_len(int slot_no) const { return slots[slot_no].len & RM_SLOT_LEN_MASK; }
+
+    char *get_data(int slot_no) const { return page->get_data() + slots[slot_no].offset; }
+
+    // slot目录和数据区之间连续的空闲空间
+    int contiguous_free_space() const {
+        return hdr->free_space_end - HDR_END - hdr->num_slots * (int)sizeof(RmSlot);
+    }
+
+    // 整理之后可用的全部空闲空间
+    int free_space() const {
+        int used = 0;
+        for (int i = 0; i < hdr->num_slots; ++i) {
+            if (slots[i].offset != 0) {
+                used += alloc_size(get_len(i));
+            }
+        }
+        return PAGE_SIZE - HDR_END - hdr->num_slots * (int)sizeof(RmSlot) - used;
+    }
+
+    // 返回slot_no之后第一个对外可见的记录（跳过空slot和从其他页面移过来的记录），没有则返回num_slots
+    int next_record(int slot_no) const {
+        for (++slot_no; slot_no < hdr->num_slots; ++slot_no) {
+            if (slots[slot_no].offset != 0 && !(slots[slot_no].len & RM_SLOT_MOVED)) {
+                break;
+            }
+        }
+        return slot_no;
+    }
+
+    /**
+     * @description: 把所有记录数据紧凑地排到页尾，消除删除和更新留下的空洞
+     */
+    void compact() {
+        char buf[PAGE_SIZE];
+        int end = PAGE_SIZE;
+        for (int i = 0; i < hdr->num_slots; ++i) {
+            if (slots[i].offset == 0) {
+                continue;
+            }
+            int size = alloc_size(get_len(i));
+            end -= size;
+            memcpy(buf + end, get_data(i), size);
+            slots[i].offset = end;
+        }
+        memcpy(page->get_data() + end, buf + end, PAGE_SIZE - end);
+        hdr->free_space_end = end;
+    }
+
+    /**
+     * @description: 在指定slot上放入一条记录，slot必须为空，slot_no可以超出当前slot目录
+     * @return {bool} 页面空间不足时返回false，页面内容不变
+     */
+    bool insert_at(int slot_no, const char *data, int len, uint16_t flags) {
+        int new_slots = std::max(0, slot_no + 1 - hdr->num_slots);
+        int need = alloc_size(len) + new_slots * (int)sizeof(RmSlot);
+        if (free_space() < need) {
+            return false;
+        }
+        if (contiguous_free_space() < need) {
+            compact();
+        }
+        for (int i = hdr->num_slots; i <= slot_no; ++i) {
+            slots[i].offset = 0;
+            slots[i].len = 0;
+        }
+        hdr->num_slots += new_slots;
+        hdr->free_space_end -= alloc_size(len);
+        memcpy(page->get_data() + hdr->free_space_end, data, len);
+        slots[slot_no].offset = hdr->free_space_end;
+        slots[slot_no].len = len | flags;
+        page_hdr->num_records++;
+        return true;
+    }
+
+    /**
+     * @description: 插入一条记录，优先复用空slot
+     * @return {int} 记录所在的slot，页面空间不足时返回-1
+     */
+    int insert(const char *data, int len, uint16_t flags) {
+        int slot_no = 0;
+        while (slot_no < hdr->num_slots && slots[slot_no].offset != 0) {
+            ++slot_no;
+        }
+        return insert_at(slot_no, data, len, flags) ? slot_no : -1;
+    }
+
+    /**
+     * @description: 在页面内更新一条记录，保留slot上的标记位
+     * @return {bool} 页面空间不足时返回false，原记录不变
+     */
+    bool update(int slot_no, const char *data, int len) {
+        uint16_t flags = get_flags(slot_no);
+        int old_size = alloc_size(get_len(slot_no));
+        if (alloc_size(len) <= old_size) {
+            memcpy(get_data(slot_no), data, len);
+            slots[slot_no].len = len | flags;
+            return true;
+        }
+        if (free_space() + old_size < alloc_size(len)) {
+            return false;
+        }
+        slots[slot_no].offset = 0;
+        if (contiguous_free_space() < alloc_size(len)) {
+            compact();
+        }
+        hdr->free_space_end -= alloc_size(len);
+        memcpy(page->get_data() + hdr->free_space_end, data, len);
+        slots[slot_no].offset = hdr->free_space_end;
+        slots[slot_no].len = len | flags;
+        return true;
+    }
+
+    /**
+     * @description: 删除一条记录，末尾的空slot会从slot目录中回收
+     */
+    void erase(int slot_no) {
+        if (slots[slot_no].offset == hdr->free_space_end) {
+            hdr->free_space_end += alloc_size(get_len(slot_no));
+        }
+        slots[slot_no].offset = 0;
+        slots[slot_no].len = 0;
+        while (hdr->num_slots > 0 && slots[hdr->num_slots - 1].offset == 0) {
+            hdr->num_slots--;
+        }
+        page_hdr->num_records--;
+    }
+};
@@ -0,0 +1,167 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "rm_defs.h"
+
+/* 扫描时某个字段的取值范围[lo, hi]，用于和zone map比较，判断整个页面能否跳过 */
+struct RmZoneRange {
+    int offset;     // 字段在记录中的偏移
+    double lo;
+    double hi;
+};
+
+/* 每个页面的摘要信息：INT/FLOAT/DATETIME字段的最小值和最大值，以及页面是否为空
+ * 插入和更新只会放宽min/max，删除不会收紧，只有页面删空时才会重置，因此摘要始终是保守的
+ * 记录所在的页面以rid的page_no为准，slotted布局下被搬走的记录仍然算在原页面上
+ * 所有数值都用double保存，DATETIME(YYYYMMDDHHMMSS)和INT都在double能精确表示的范围内 */
+class RmZoneMap {
+    struct ZoneCol {
+        int offset;
+        ColType type;
+    };
+
+    std::vector<ZoneCol> cols_;     // 维护摘要的字段
+    std::vector<double> min_;       // 第page_no个页面第i个字段的最小值位于min_[page_no * cols_.size() + i]
+    std::vector<double> max_;
+    std::vector<char> empty_;       // 页面上是否没有记录
+    mutable std::mutex latch_;
+
+   public:
+    static bool is_zone_type(ColType type) {
+        return type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_DATETIME;
+    }
+
+    static double get_value(const char *data, ColType type) {
+        switch (type) {
+            case TYPE_INT:
+                return *reinterpret_cast<const int *>(data);
+            case TYPE_FLOAT:
+                return *reinterpret_cast<const float *>(data);
+            default:
+                return static_cast<double>(*reinterpret_cast<const int64_t *>(data));
+        }
+    }
+
+    void init(const RmFileHdr &file_hdr) {
+        std::lock_guard<std::mutex> lock(latch_);
+        cols_.clear();
+        for (int i = 0; i < file_hdr.num_cols; ++i) {
+            if (is_zone_type(file_hdr.cols[i].type)) {
+                cols_.push_back({file_hdr.cols[i].offset, file_hdr.cols[i].type});
+            }
+        }
+        min_.clear();
+        max_.clear();
+        empty_.clear();
+    }
+
+    bool enabled() const { return !cols_.empty(); }
+
+    /* 页面被删空，重置摘要 */
+    void clear_page(int page_no) {
+        std::lock_guard<std::mutex> lock(latch_);
+        if (page_no < static_cast<int>(empty_.size())) {
+            empty_[page_no] = 1;
+        }
+    }
+
+    /* 页面上新增或更新了一条记录，放宽摘要 */
+    void add_record(int page_no, const char *rec) {
+        if (!enabled()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(latch_);
+        resize(page_no + 1);
+        size_t base = static_cast<size_t>(page_no) * cols_.size();
+        for (size_t i = 0; i < cols_.size(); ++i) {
+            double val = get_value(rec + cols_[i].offset, cols_[i].type);
+            if (empty_[page_no]) {
+                min_[base + i] = max_[base + i] = val;
+            } else {
+                min_[base + i] = std::min(min_[base + i], val);
+                max_[base + i] = std::max(max_[base + i], val);
+            }
+        }
+        empty_[page_no] = 0;
+    }
+
+    /**
+     * @description: 判断页面上是否可能存在同时满足所有范围条件的记录
+     * 没有摘要的页面（例如摘要还没建立）一律返回true
+     */
+    bool may_contain(int page_no, const std::vector<RmZoneRange> &ranges) const {
+        std::lock_guard<std::mutex> lock(latch_);
+        if (!enabled() || page_no >= static_cast<int>(empty_.size())) {
+            return true;
+        }
+        if (empty_[page_no]) {
+            return false;
+        }
+        size_t base = static_cast<size_t>(page_no) * cols_.size();
+        for (auto &range : ranges) {
+            for (size_t i = 0; i < cols_.size(); ++i) {
+                if (cols_[i].offset == range.offset &&
+                    (max_[base + i] < range.lo || min_[base + i] > range.hi)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void serialize(std::ostream &os) const {
+        std::lock_guard<std::mutex> lock(latch_);
+        size_t num_pages = empty_.size();
+        size_t num_cols = cols_.size();
+        os.write(reinterpret_cast<const char *>(&num_pages), sizeof(num_pages));
+        os.write(reinterpret_cast<const char *>(&num_cols), sizeof(num_cols));
+        os.write(empty_.data(), num_pages);
+        os.write(reinterpret_cast<const char *>(min_.data()), min_.size() * sizeof(double));
+        os.write(reinterpret_cast<const char *>(max_.data()), max_.size() * sizeof(double));
+    }
+
+    /**
+     * @description: 从文件中读出摘要，字段个数不一致或文件不完整时返回false，由调用者重建
+     */
+    bool deserialize(std::istream &is) {
+        std::lock_guard<std::mutex> lock(latch_);
+        size_t num_pages, num_cols;
+        if (!is.read(reinterpret_cast<char *>(&num_pages), sizeof(num_pages)) ||
+            !is.read(reinterpret_cast<char *>(&num_cols), sizeof(num_cols)) || num_cols != cols_.size()) {
+            return false;
+        }
+        empty_.resize(num_pages);
+        min_.resize(num_pages * num_cols);
+        max_.resize(num_pages * num_cols);
+        is.read(empty_.data(), num_pages);
+        is.read(reinterpret_cast<char *>(min_.data()), min_.size() * sizeof(double));
+        is.read(reinterpret_cast<char *>(max_.data()), max_.size() * sizeof(double));
+        return static_cast<bool>(is);
+    }
+
+   private:
+    void resize(int num_pages) {
+        if (num_pages > static_cast<int>(empty_.size())) {
+            empty_.resize(num_pages, 1);
+            min_.resize(static_cast<size_t>(num_pages) * cols_.size());
+            max_.resize(static_cast<size_t>(num_pages) * cols_.size());
+        }
+    }
+};
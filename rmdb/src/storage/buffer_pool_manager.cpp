@@ -249,6 +249,8 @@ bool BufferPoolManager::delete_page(PageId page_id) {
     page->pin_count_ = 0;
     page->is_dirty_ = false;
 
+    // 帧进入free_list_后不能再被replacer选为victim
+    replacer_->pin(frame_id);
     free_list_.push_back(frame_id);
     return true;
 }
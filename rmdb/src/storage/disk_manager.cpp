@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <stdio.h>     // for rename
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
 #include <unistd.h>    // for lseek
@@ -178,6 +179,30 @@ void DiskManager::destroy_file(const std::string& path) {
     }
 }
 
+/**
+ * @description: 重命名文件，文件可以是打开的，已经打开的fd在新的路径下继续有效
+ * @param {string} &old_path 原来的路径
+ * @param {string} &new_path 新的路径，不能已经存在
+ */
+void DiskManager::rename_file(const std::string& old_path, const std::string& new_path) {
+    if (!is_file(old_path)) {
+        throw FileNotFoundError(old_path);
+    }
+    if (is_file(new_path)) {
+        throw FileExistsError(new_path);
+    }
+    if (rename(old_path.c_str(), new_path.c_str()) == -1) {
+        throw UnixError();
+    }
+    auto it = path2fd_.find(old_path);
+    if (it != path2fd_.end()) {
+        int fd = it->second;
+        path2fd_.erase(it);
+        path2fd_[new_path] = fd;
+        fd2path_[fd] = new_path;
+    }
+}
+
 /**
  * @description: 打开指定路径文件
  * @return {int} 返回打开的文件的文件句柄
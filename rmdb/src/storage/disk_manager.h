@@ -54,6 +54,8 @@ class DiskManager {
 
     void destroy_file(const std::string &path);
 
+    void rename_file(const std::string &old_path, const std::string &new_path);
+
     int open_file(const std::string &path);
 
     void close_file(int fd);
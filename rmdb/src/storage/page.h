@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <shared_mutex>
+
 #include "common/config.h"
 
 /**
@@ -71,6 +73,15 @@ class Page {
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
+    /* 页面读写锁，由上层（如B+树的latch crabbing）在pin住页面期间使用，buffer pool本身不使用 */
+    inline void wlatch() { rwlatch_.lock(); }
+
+    inline void wunlatch() { rwlatch_.unlock(); }
+
+    inline void rlatch() { rwlatch_.lock_shared(); }
+
+    inline void runlatch() { rwlatch_.unlock_shared(); }
+
    private:
     void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
 
@@ -87,4 +98,7 @@ class Page {
 
     /** The pin count of this page. */
     int pin_count_ = 0;
+
+    /** 页面内容的读写锁 */
+    std::shared_mutex rwlatch_;
 };
\ No newline at end of file
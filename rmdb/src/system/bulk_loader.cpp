@@ -0,0 +1,559 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "bulk_loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <fstream>
+#include <numeric>
+#include <thread>
+
+#include "common/common.h"
+#include "index/ix_sorter.h"
+#include "record/rm_scan.h"
+
+// 每个解析线程至少处理的字节数，避免小文件也开很多线程
+static constexpr size_t LOAD_MIN_CHUNK_SIZE = 1 << 20;
+// 建索引时每个扫描线程每次领取的页面个数
+static constexpr int BUILD_MORSEL_PAGES = 64;
+// 建索引时外部排序在内存中缓存的键值对总字节数，超出后写入临时文件
+static constexpr size_t BUILD_SORT_MEMORY = 64 << 20;
+
+static std::vector<std::string> get_col_names(const std::vector<ColMeta> &cols) {
+    std::vector<std::string> col_names;
+    for (auto &col : cols) {
+        col_names.push_back(col.name);
+    }
+    return col_names;
+}
+
+/**
+ * @description: 把CSV文件导入到指定表中
+ * CSV文件的第一行如果以表的第一个字段名开头，则视为表头并跳过；字段之间以','分隔，不支持引号转义
+ * @return {size_t} 导入的记录条数
+ * @param {string&} file_name CSV文件路径
+ * @param {string&} tab_name 目标表名称
+ * @param {Context*} context
+ */
+size_t BulkLoader::load(const std::string &file_name, const std::string &tab_name, Context *context) {
+    TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+    RmFileHandle *fh = sm_manager_->fhs_.at(tab_name).get();
+    int record_size = fh->get_file_hdr().record_size;
+
+    // 批量导入直接写数据页，不加记录锁，改为对整张表加排他锁
+    if (context != nullptr && context->txn_ != nullptr) {
+        context->lock_mgr_->lock_exclusive_on_table(context->txn_, fh->GetFd());
+    }
+
+    // 1. 把整个文件读入内存
+    std::ifstream ifs(file_name, std::ios::in | std::ios::binary);
+    if (!ifs.is_open()) {
+        throw FileNotFoundError(file_name);
+    }
+    ifs.seekg(0, std::ios::end);
+    std::string content(static_cast<size_t>(ifs.tellg()), '\0');
+    ifs.seekg(0, std::ios::beg);
+    ifs.read(&content[0], content.size());
+    ifs.close();
+
+    const char *data_begin = content.data();
+    const char *data_end = content.data() + content.size();
+
+    // 跳过表头
+    const char *first_line_end = std::find(data_begin, data_end, '\n');
+    const char *first_field_end = std::find(data_begin, first_line_end, ',');
+    std::string first_field(data_begin, first_field_end);
+    if (!tab.cols.empty() && first_field == tab.cols.front().name) {
+        data_begin = first_line_end == data_end ? data_end : first_line_end + 1;
+    }
+
+    // 2. 按行边界切分成若干块，多线程并行解析
+    size_t data_size = data_end - data_begin;
+    size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::max<size_t>(1, std::min(num_threads, data_size / LOAD_MIN_CHUNK_SIZE));
+
+    std::vector<const char *> bounds{data_begin};
+    for (size_t i = 1; i < num_threads; ++i) {
+        const char *pos = std::max(bounds.back(), data_begin + data_size * i / num_threads);
+        pos = std::find(pos, data_end, '\n');
+        bounds.push_back(pos == data_end ? data_end : pos + 1);
+    }
+    bounds.push_back(data_end);
+
+    size_t num_chunks = bounds.size() - 1;
+    std::vector<std::vector<char>> chunk_records(num_chunks);
+    std::vector<std::exception_ptr> chunk_errors(num_chunks);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < num_chunks; ++i) {
+        workers.emplace_back([&, i]() {
+            try {
+                parse_chunk(bounds[i], bounds[i + 1], tab, record_size, &chunk_records[i]);
+            } catch (...) {
+                chunk_errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (auto &error : chunk_errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<char> records;
+    if (num_chunks == 1) {
+        records.swap(chunk_records[0]);
+    } else {
+        size_t tot_size = 0;
+        for (auto &chunk : chunk_records) {
+            tot_size += chunk.size();
+        }
+        records.reserve(tot_size);
+        for (auto &chunk : chunk_records) {
+            records.insert(records.end(), chunk.begin(), chunk.end());
+            std::vector<char>().swap(chunk);
+        }
+    }
+    size_t num_records = records.size() / record_size;
+    if (num_records == 0) {
+        return 0;
+    }
+
+    // 唯一索引在写入之前检查，违反时整个文件都不导入
+    for (auto &index : tab.indexes) {
+        if (index.unique) {
+            check_unique_keys(records, record_size, index);
+        }
+    }
+
+    // 3. 直接写入表的数据页
+    std::vector<Rid> rids(num_records);
+    fh->append_records(records.data(), num_records, rids.data());
+
+    // 4. 各个B+树索引并行抽取key并排序，然后自底向上构建B+树；每个哈希索引和ART索引由一个线程逐条插入
+    size_t num_indexes = tab.indexes.size();
+    std::vector<std::vector<char>> sorted_keys(num_indexes);
+    std::vector<std::vector<Rid>> sorted_rids(num_indexes);
+    workers.clear();
+    for (size_t i = 0; i < num_indexes; ++i) {
+        auto &index = tab.indexes[i];
+        std::string index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name, index.cols);
+        if (index.type == INDEX_HASH) {
+            auto ih = sm_manager_->hash_ihs_.at(index_name).get();
+            workers.emplace_back([&, ih]() {
+                std::vector<char> key(index.col_tot_len);
+                for (size_t j = 0; j < num_records; ++j) {
+                    SmManager::get_index_key(index, records.data() + j * record_size, key.data());
+                    ih->insert_entry(key.data(), rids[j], nullptr);
+                }
+            });
+            continue;
+        }
+        if (index.type == INDEX_ART) {
+            auto ih = sm_manager_->art_ihs_.at(index_name).get();
+            workers.emplace_back([&, ih]() {
+                std::vector<char> key(index.col_tot_len);
+                for (size_t j = 0; j < num_records; ++j) {
+                    SmManager::get_index_key(index, records.data() + j * record_size, key.data());
+                    ih->insert_entry(key.data(), rids[j]);
+                }
+            });
+            continue;
+        }
+        workers.emplace_back([&, i]() {
+            sort_index_keys(records, record_size, rids, tab.indexes[i], &sorted_keys[i], &sorted_rids[i]);
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (size_t i = 0; i < num_indexes; ++i) {
+        auto &index = tab.indexes[i];
+        if (index.type != INDEX_BTREE) {
+            continue;
+        }
+        sm_manager_->bulk_load_index(index, sorted_keys[i].data(), sorted_rids[i].data(), sorted_rids[i].size());
+    }
+    return num_records;
+}
+
+/**
+ * @description: 为表中已有的记录批量构建索引
+ * 多个线程从共享的游标上按morsel领取数据页并行扫描，从页面上直接抽取key，编码后交给外部排序，内存不够时有序段写入临时文件；
+ * 归并得到的有序键值对按填充因子自底向上装入空的B+树，不经过逐条insert_entry
+ * @return {size_t} 索引中的键值对个数，唯一索引中key重复的记录只保留第一条，非唯一索引的key附加了rid，不会重复
+ * @param {string&} tab_name 表名称
+ * @param {vector<ColMeta>&} cols 索引包含的字段
+ * @param {IxIndexHandle*} ih 刚创建的空索引
+ * @param {int} fill_factor 填充因子（百分比）
+ * @param {bool} unique 是否为唯一索引，有重复的key时在构建完成后抛出UniqueConstraintError，由调用者删除索引
+ * @param {Context*} context 为nullptr时不加表锁，用于在线的REINDEX
+ */
+size_t BulkLoader::build_index(const std::string &tab_name, const std::vector<ColMeta> &cols, IxIndexHandle *ih,
+                               int fill_factor, bool unique, Context *context) {
+    RmFileHandle *fh = sm_manager_->fhs_.at(tab_name).get();
+    // CREATE INDEX期间不允许其他事务修改表；REINDEX不传context，与对表的修改并发执行，
+    // 两种情况下都在页面读锁下拷贝出每个页面再抽取key，不会读到修改了一半的记录
+    if (context != nullptr && context->txn_ != nullptr) {
+        context->lock_mgr_->lock_shared_on_table(context->txn_, fh->GetFd());
+    }
+    RmFileHdr file_hdr = fh->get_file_hdr();
+    int num_pages = file_hdr.num_pages;
+    int num_morsels = (std::max(num_pages - RM_FIRST_RECORD_PAGE, 0) + BUILD_MORSEL_PAGES - 1) / BUILD_MORSEL_PAGES;
+    size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::max<size_t>(1, std::min<size_t>(num_threads, num_morsels));
+
+    int key_len = ih->user_key_len();
+    IxExternalSorter sorter(sm_manager_->get_ix_manager()->get_index_name(tab_name, cols),
+                            ih->get_key_codec().key_len(), BUILD_SORT_MEMORY, num_threads);
+
+    // 1. 并行扫描，抽取并编码key
+    std::atomic<int> next_page{RM_FIRST_RECORD_PAGE};
+    std::vector<std::exception_ptr> errors(num_threads);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers.emplace_back([&, i]() {
+            try {
+                IxSortWriter writer(&sorter);
+                std::vector<char> key(key_len), encoded_key(ih->get_key_codec().key_len()), rec(file_hdr.record_size);
+                auto snapshot = std::make_unique<Page>();
+                auto add_key = [&](const Rid &rid, auto get_field) {
+                    int offset = 0;
+                    for (auto &col : cols) {
+                        memcpy(key.data() + offset, get_field(col), col.len);
+                        offset += col.len;
+                    }
+                    ih->encode_key(key.data(), rid, encoded_key.data());
+                    writer.add(encoded_key.data(), rid);
+                };
+                while (true) {
+                    int start_page = next_page.fetch_add(BUILD_MORSEL_PAGES);
+                    if (start_page >= num_pages) {
+                        break;
+                    }
+                    int end_page = std::min(start_page + BUILD_MORSEL_PAGES, num_pages);
+                    for (int page_no = start_page; page_no < end_page; ++page_no) {
+                        fh->snapshot_page(page_no, snapshot.get());
+                        if (file_hdr.layout == RM_LAYOUT_SLOTTED) {
+                            // 变长记录需要解码，搬到其他页面的记录顺着转发slot读取
+                            RmSlottedPageHandle slotted_page(snapshot.get());
+                            for (int slot_no = slotted_page.next_record(-1); slot_no < slotted_page.hdr->num_slots;
+                                 slot_no = slotted_page.next_record(slot_no)) {
+                                Rid rid{page_no, slot_no};
+                                if (fh->read_snapshot_record(snapshot.get(), rid, rec.data())) {
+                                    add_key(rid, [&](const ColMeta &col) { return rec.data() + col.offset; });
+                                }
+                            }
+                            continue;
+                        }
+                        // 定长记录直接从页面拷贝上读取索引字段
+                        RmPageHandle page_handle(&file_hdr, snapshot.get());
+                        int num_slots = file_hdr.num_records_per_page;
+                        for (int slot_no = Bitmap::next_bit(1, page_handle.bitmap, num_slots, -1); slot_no < num_slots;
+                             slot_no = Bitmap::next_bit(1, page_handle.bitmap, num_slots, slot_no)) {
+                            add_key(Rid{page_no, slot_no}, [&](const ColMeta &col) {
+                                return page_handle.get_field(slot_no, col.offset, col.len);
+                            });
+                        }
+                    }
+                }
+                writer.finish();
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // 2. 多路归并，自底向上构建B+树
+    IxBulkBuilder builder(ih, fill_factor);
+    sorter.start_merge();
+    const char *encoded_key;
+    Rid rid;
+    bool has_duplicate = false;
+    while (sorter.next(&encoded_key, &rid)) {
+        has_duplicate |= !builder.append(encoded_key, rid);
+    }
+    builder.finish();
+    if (unique && has_duplicate) {
+        throw UniqueConstraintError(tab_name, get_col_names(cols));
+    }
+    return builder.num_entries();
+}
+
+/**
+ * @description: 为表中已有的记录构建哈希索引，逐条插入
+ * @return {size_t} 索引中的键值对个数
+ * @param {string&} tab_name 表名称
+ * @param {vector<ColMeta>&} cols 索引包含的字段
+ * @param {IxHashIndexHandle*} ih 刚创建的空索引
+ * @param {bool} unique 是否为唯一索引，有重复的key时抛出UniqueConstraintError，由调用者删除索引
+ * @param {Context*} context
+ */
+size_t BulkLoader::build_hash_index(const std::string &tab_name, const std::vector<ColMeta> &cols,
+                                    IxHashIndexHandle *ih, bool unique, Context *context) {
+    RmFileHandle *fh = sm_manager_->fhs_.at(tab_name).get();
+    if (context != nullptr && context->txn_ != nullptr) {
+        context->lock_mgr_->lock_shared_on_table(context->txn_, fh->GetFd());
+    }
+    int key_len = 0;
+    for (auto &col : cols) {
+        key_len += col.len;
+    }
+    std::vector<char> key(key_len);
+    size_t num_entries = 0;
+    for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+        auto rec = fh->get_record(scan.rid(), nullptr);
+        int offset = 0;
+        for (auto &col : cols) {
+            memcpy(key.data() + offset, rec->data + col.offset, col.len);
+            offset += col.len;
+        }
+        if (ih->insert_entry(key.data(), scan.rid(), nullptr)) {
+            num_entries++;
+        } else if (unique) {
+            throw UniqueConstraintError(tab_name, get_col_names(cols));
+        }
+    }
+    return num_entries;
+}
+
+/**
+ * @description: 扫描一遍表，逐条插入填充表上的若干个ART索引，有重复的key时抛出UniqueConstraintError
+ * 打开数据库时用于重建ART索引，create index时用于填充新建的ART索引
+ * @param {string&} tab_name 表名称
+ * @param {vector<const IndexMeta*>&} indexes 各个ART索引的元数据
+ * @param {vector<IxArtIndex*>&} ihs 与indexes一一对应的空索引
+ * @param {Context*} context
+ */
+void BulkLoader::build_art_indexes(const std::string &tab_name, const std::vector<const IndexMeta *> &indexes,
+                                   const std::vector<IxArtIndex *> &ihs, Context *context) {
+    RmFileHandle *fh = sm_manager_->fhs_.at(tab_name).get();
+    if (context != nullptr && context->txn_ != nullptr) {
+        context->lock_mgr_->lock_shared_on_table(context->txn_, fh->GetFd());
+    }
+    std::vector<std::vector<char>> keys(indexes.size());
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        keys[i].resize(ihs[i]->get_key_codec().key_len());
+    }
+    for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+        auto rec = fh->get_record(scan.rid(), nullptr);
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            SmManager::get_index_key(*indexes[i], rec->data, keys[i].data());
+            if (!ihs[i]->insert_entry(keys[i].data(), scan.rid()) && indexes[i]->unique) {
+                throw UniqueConstraintError(tab_name, indexes[i]->col_names());
+            }
+        }
+    }
+}
+
+/**
+ * @description: 导入前检查唯一索引：导入的记录之间、导入的记录与表中已有的记录之间key都不能重复，违反时抛出UniqueConstraintError
+ * 表中已有的key逐条在索引中查找；导入的key编码后排序，比较相邻的key
+ * @param {vector<char>&} records 连续存放的待导入记录
+ * @param {int} record_size 记录长度
+ * @param {IndexMeta&} index 唯一索引的元数据
+ */
+void BulkLoader::check_unique_keys(const std::vector<char> &records, int record_size, const IndexMeta &index) {
+    size_t num_records = records.size() / record_size;
+    int key_len = index.col_tot_len;
+    std::vector<ColType> col_types;
+    std::vector<int> col_lens;
+    for (auto &col : index.cols) {
+        col_types.push_back(col.type);
+        col_lens.push_back(col.len);
+    }
+    IxKeyCodec codec;
+    codec.init(col_types, col_lens);
+
+    std::vector<char> keys(num_records * key_len);
+    std::vector<char> key(key_len);
+    std::vector<Rid> found;
+    for (size_t i = 0; i < num_records; ++i) {
+        SmManager::get_index_key(index, records.data() + i * record_size, key.data());
+        if (sm_manager_->get_index_value(index, key.data(), &found, nullptr)) {
+            throw UniqueConstraintError(index.tab_name, index.col_names());
+        }
+        codec.encode(key.data(), keys.data() + i * key_len);
+    }
+
+    std::vector<size_t> order(num_records);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return memcmp(keys.data() + a * key_len, keys.data() + b * key_len, key_len) < 0;
+    });
+    for (size_t i = 1; i < num_records; ++i) {
+        if (memcmp(keys.data() + order[i] * key_len, keys.data() + order[i - 1] * key_len, key_len) == 0) {
+            throw UniqueConstraintError(index.tab_name, index.col_names());
+        }
+    }
+}
+
+/**
+ * @description: 解析CSV文件中[begin, end)范围内的若干行，每行转换成一条定长记录追加到records中
+ * @param {char*} begin 起始位置，必须是某一行的行首
+ * @param {char*} end 结束位置，必须是某一行的行尾的下一个字符或文件末尾
+ * @param {TabMeta&} tab 目标表的元数据
+ * @param {int} record_size 记录长度
+ * @param {vector<char>*} records 传出参数，连续存放解析得到的记录
+ */
+void BulkLoader::parse_chunk(const char *begin, const char *end, const TabMeta &tab, int record_size,
+                             std::vector<char> *records) {
+    // 按平均行长预估记录条数，减少扩容
+    size_t num_lines = std::count(begin, end, '\n') + 1;
+    records->reserve(num_lines * record_size);
+
+    const char *line = begin;
+    while (line < end) {
+        const char *line_end = std::find(line, end, '\n');
+        const char *next_line = line_end == end ? end : line_end + 1;
+        if (line_end > line && *(line_end - 1) == '\r') {
+            --line_end;
+        }
+        if (line_end == line) {
+            line = next_line;
+            continue;
+        }
+
+        size_t rec_offset = records->size();
+        records->resize(rec_offset + record_size, 0);
+        char *rec = records->data() + rec_offset;
+
+        const char *field = line;
+        for (size_t i = 0; i < tab.cols.size(); ++i) {
+            if (field > line_end) {
+                throw InvalidValueCountError();
+            }
+            const char *field_end = std::find(field, line_end, ',');
+            auto &col = tab.cols[i];
+            char *dest = rec + col.offset;
+            size_t field_len = field_end - field;
+            switch (col.type) {
+                case TYPE_INT: {
+                    int int_val;
+                    auto res = std::from_chars(field, field_end, int_val);
+                    if (res.ec != std::errc() || res.ptr != field_end) {
+                        throw IncompatibleTypeError(coltype2str(col.type), std::string(field, field_end));
+                    }
+                    memcpy(dest, &int_val, sizeof(int));
+                    break;
+                }
+                case TYPE_FLOAT: {
+                    // strtof需要以'\0'结尾的字符串
+                    char buf[64];
+                    if (field_len == 0 || field_len >= sizeof(buf)) {
+                        throw IncompatibleTypeError(coltype2str(col.type), std::string(field, field_end));
+                    }
+                    memcpy(buf, field, field_len);
+                    buf[field_len] = '\0';
+                    char *parse_end;
+                    float float_val = strtof(buf, &parse_end);
+                    if (parse_end != buf + field_len) {
+                        throw IncompatibleTypeError(coltype2str(col.type), std::string(field, field_end));
+                    }
+                    memcpy(dest, &float_val, sizeof(float));
+                    break;
+                }
+                case TYPE_STRING:
+                case TYPE_VARCHAR: {
+                    if (field_len > static_cast<size_t>(col.len)) {
+                        throw StringOverflowError();
+                    }
+                    memcpy(dest, field, field_len);
+                    break;
+                }
+                case TYPE_DATETIME: {
+                    int64_t datetime_val;
+                    if (!parse_datetime(field, field_len, &datetime_val)) {
+                        throw DateTimeAbsurdError("", std::string(field, field_end));
+                    }
+                    memcpy(dest, &datetime_val, sizeof(int64_t));
+                    break;
+                }
+                default:
+                    throw InternalError("Unexpected data type");
+            }
+            field = field_end + 1;
+        }
+        if (field <= line_end) {
+            throw InvalidValueCountError();
+        }
+        line = next_line;
+    }
+}
+
+/**
+ * @description: 从所有记录中抽取指定索引的key，按ix_compare排序
+ * 唯一索引中重复的key只保留第一条；非唯一索引保留所有记录，key相同时按rid排序，与B+树中附加了rid的key顺序一致
+ * @param {vector<char>&} records 连续存放的记录
+ * @param {int} record_size 记录长度
+ * @param {vector<Rid>&} rids 每条记录的位置
+ * @param {IndexMeta&} index 索引元数据
+ * @param {vector<char>*} sorted_keys 传出参数，排好序的key，连续存放
+ * @param {vector<Rid>*} sorted_rids 传出参数，与sorted_keys一一对应的rid
+ */
+void BulkLoader::sort_index_keys(const std::vector<char> &records, int record_size, const std::vector<Rid> &rids,
+                                 const IndexMeta &index, std::vector<char> *sorted_keys,
+                                 std::vector<Rid> *sorted_rids) {
+    size_t num_records = rids.size();
+    int key_len = index.col_tot_len;
+    std::vector<ColType> col_types;
+    std::vector<int> col_lens;
+    for (auto &col : index.cols) {
+        col_types.push_back(col.type);
+        col_lens.push_back(col.len);
+    }
+
+    std::vector<char> keys(num_records * key_len);
+    for (size_t i = 0; i < num_records; ++i) {
+        const char *rec = records.data() + i * record_size;
+        char *key = keys.data() + i * key_len;
+        for (auto &col : index.cols) {
+            memcpy(key, rec + col.offset, col.len);
+            key += col.len;
+        }
+    }
+
+    std::vector<size_t> order(num_records);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        int cmp = ix_compare(keys.data() + a * key_len, keys.data() + b * key_len, col_types, col_lens);
+        if (cmp != 0 || index.unique) {
+            return cmp < 0;
+        }
+        return rids[a].page_no != rids[b].page_no ? rids[a].page_no < rids[b].page_no
+                                                  : rids[a].slot_no < rids[b].slot_no;
+    });
+
+    // 与IxNodeHandle::insert()保持一致，唯一索引中重复的key只保留第一条
+    sorted_keys->reserve(num_records * key_len);
+    sorted_rids->reserve(num_records);
+    for (size_t i = 0; i < num_records; ++i) {
+        const char *key = keys.data() + order[i] * key_len;
+        if (index.unique && i > 0 &&
+            ix_compare(key, keys.data() + order[i - 1] * key_len, col_types, col_lens) == 0) {
+            continue;
+        }
+        sorted_keys->insert(sorted_keys->end(), key, key + key_len);
+        sorted_rids->push_back(rids[order[i]]);
+    }
+}
@@ -0,0 +1,50 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "sm_manager.h"
+
+/* 批量导入器，负责执行load data infile语句：
+ * 1. 把CSV文件按行边界切分成若干块，由多个线程并行解析成定长记录
+ * 2. 不经过逐条insert，直接把记录按顺序写满表的数据页
+ * 3. 对表上的每个B+树索引，抽取key并排序后自底向上构建B+树；哈希索引和ART索引逐条插入
+ * 也负责在已有数据的表上create index时，扫描全表批量构建索引 */
+class BulkLoader {
+   private:
+    SmManager *sm_manager_;
+
+   public:
+    BulkLoader(SmManager *sm_manager) : sm_manager_(sm_manager) {}
+
+    size_t load(const std::string &file_name, const std::string &tab_name, Context *context);
+
+    size_t build_index(const std::string &tab_name, const std::vector<ColMeta> &cols, IxIndexHandle *ih,
+                       int fill_factor, bool unique, Context *context);
+
+    size_t build_hash_index(const std::string &tab_name, const std::vector<ColMeta> &cols, IxHashIndexHandle *ih,
+                            bool unique, Context *context);
+
+    void build_art_indexes(const std::string &tab_name, const std::vector<const IndexMeta *> &indexes,
+                           const std::vector<IxArtIndex *> &ihs, Context *context);
+
+   private:
+    void check_unique_keys(const std::vector<char> &records, int record_size, const IndexMeta &index);
+
+    static void parse_chunk(const char *begin, const char *end, const TabMeta &tab, int record_size,
+                            std::vector<char> *records);
+
+    static void sort_index_keys(const std::vector<char> &records, int record_size, const std::vector<Rid> &rids,
+                                const IndexMeta &index, std::vector<char> *sorted_keys,
+                                std::vector<Rid> *sorted_rids);
+};
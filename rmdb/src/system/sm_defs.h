@@ -11,3 +11,6 @@ See the Mulan PSL v2 for more details. */
 
 #include "defs.h"
 #include <string>
+
+// REINDEX分批回放旁路日志，一批不超过这么多条时才独占index_latch_回放剩下的日志并换入新索引
+constexpr size_t REINDEX_PAUSE_ENTRIES = 1024;
@@ -13,8 +13,12 @@ See the Mulan PSL v2 for more details. */
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <chrono>
+#include <exception>
 #include <fstream>
+#include <thread>
 
+#include "bulk_loader.h"
 #include "index/ix.h"
 #include "record/rm.h"
 #include "record_printer.h"
@@ -106,8 +110,66 @@ void SmManager::open_db(const std::string& db_name) {
 
         for (auto& index : tab.indexes) {
             // 插入进索引文件表
-            ihs_.emplace(tab.name,
-                         ix_manager_->open_index(index.tab_name, index.cols));
+            std::string index_name = ix_manager_->get_index_name(index.tab_name, index.cols);
+            if (index.type == INDEX_HASH) {
+                hash_ihs_.emplace(index_name, ix_manager_->open_hash_index(index.tab_name, index.cols));
+            } else if (index.type == INDEX_ART) {
+                art_ihs_.emplace(index_name, make_art_index(index.cols));
+            } else {
+                ihs_.emplace(index_name, ix_manager_->open_index(index.tab_name, index.cols));
+            }
+        }
+    }
+
+    // ART索引不落盘，从表中重建
+    rebuild_art_indexes();
+}
+
+/* 创建一个空的ART索引，key由cols中的字段拼接而成 */
+std::unique_ptr<IxArtIndex> SmManager::make_art_index(const std::vector<ColMeta>& cols) {
+    std::vector<ColType> col_types;
+    std::vector<int> col_lens;
+    for (auto& col : cols) {
+        col_types.push_back(col.type);
+        col_lens.push_back(col.len);
+    }
+    return std::make_unique<IxArtIndex>(col_types, col_lens);
+}
+
+/**
+ * @description: 为所有表上的ART索引从表中重建内容，每张表由一个线程扫描一遍，同时填充该表上的所有ART索引
+ */
+void SmManager::rebuild_art_indexes() {
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(db_.tabs_.size());
+    size_t i = 0;
+    for (auto& entry : db_.tabs_) {
+        auto& tab = entry.second;
+        std::vector<const IndexMeta*> indexes;
+        std::vector<IxArtIndex*> ihs;
+        for (auto& index : tab.indexes) {
+            if (index.type == INDEX_ART) {
+                indexes.push_back(&index);
+                ihs.push_back(art_ihs_.at(ix_manager_->get_index_name(tab.name, index.cols)).get());
+            }
+        }
+        if (!indexes.empty()) {
+            workers.emplace_back([this, &tab, indexes, ihs, &error = errors[i]]() {
+                try {
+                    BulkLoader(this).build_art_indexes(tab.name, indexes, ihs, nullptr);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            });
+        }
+        ++i;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
         }
     }
 }
@@ -135,6 +197,15 @@ void SmManager::close_db() {
     for (auto& entry : ihs_) {
         ix_manager_->close_index(entry.second.get());
     }
+    for (auto& entry : hash_ihs_) {
+        ix_manager_->close_hash_index(entry.second.get());
+    }
+    // REINDEX替换下来的旧索引已经没有人使用，关闭后删除文件
+    for (auto& [file_name, ih] : retired_ihs_) {
+        ix_manager_->close_index(ih.get());
+        disk_manager_->destroy_file(file_name);
+    }
+    retired_ihs_.clear();
 
     // 将数据库元数据刷入磁盘
     flush_meta();
@@ -142,6 +213,8 @@ void SmManager::close_db() {
     // 清空数据
     fhs_.clear();
     ihs_.clear();
+    hash_ihs_.clear();
+    art_ihs_.clear();
     
     // 回到根目录
     if (chdir("..") < 0) {
@@ -196,18 +269,97 @@ void SmManager::desc_table(const std::string& tab_name, Context* context) {
     printer.print_separator(context);
 }
 
+/**
+ * @description: 显示表上每个索引的统计信息。B+树索引显示增量维护的统计信息，不扫描叶结点，
+ * 前缀取值个数在REINDEX时重新计算；哈希索引没有维护统计信息，ART索引只有键值对数量
+ * @param {string&} tab_name 表名称
+ * @param {Context*} context
+ */
+void SmManager::show_index_stats(const std::string& tab_name, Context* context) {
+    TabMeta& tab = db_.get_table(tab_name);
+    auto percent = [](double ratio) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.2f%%", ratio * 100);
+        return std::string(buf);
+    };
+
+    std::vector<std::string> captions = {"Index", "Type", "Entries", "Leaves", "Height", "Fill", "Distinct",
+                                         "Bloom FPR"};
+    RecordPrinter printer(captions.size());
+    printer.print_separator(context);
+    printer.print_record(captions, context);
+    printer.print_separator(context);
+    for (auto& index : tab.indexes) {
+        std::string cols;
+        for (auto& col : index.cols) {
+            cols += (cols.empty() ? "" : ",") + col.name;
+        }
+        std::string index_name = ix_manager_->get_index_name(tab_name, index.cols);
+        std::vector<std::string> info(captions.size(), "-");
+        info[0] = "(" + cols + ")";
+        if (index.type == INDEX_HASH) {
+            info[1] = "HASH";
+        } else if (index.type == INDEX_ART) {
+            info[1] = "ART";
+            info[2] = std::to_string(art_ihs_.at(index_name)->size());
+        } else {
+            info[1] = "BTREE";
+            auto& ih = ihs_.at(index_name);
+            IxIndexStats stats = ih->get_stats();
+            info[2] = std::to_string(stats.num_entries);
+            info[3] = std::to_string(stats.num_leaves);
+            info[4] = std::to_string(stats.height);
+            info[5] = percent(stats.avg_fill);
+            info[6].clear();
+            for (int64_t distinct : stats.distinct_prefixes) {
+                info[6] += (info[6].empty() ? "" : "/") + std::to_string(distinct);
+            }
+            if (ih->has_bloom()) {
+                // 观察到的误判率：不存在的key中被过滤器放行的比例
+                IxBloomStats bloom = ih->get_bloom_stats();
+                info[7] = "est " + percent(bloom.estimated_fpr);
+                uint64_t absent = bloom.negatives + bloom.false_positives;
+                if (absent > 0) {
+                    info[7] += ", obs " + percent((double)bloom.false_positives / absent);
+                }
+            }
+        }
+        if (index.unique) {
+            info[1] += " UNIQUE";
+        }
+        printer.print_record(info, context);
+    }
+    printer.print_separator(context);
+}
+
 /**
  * @description: 创建表
  * @param {string&} tab_name 表的名称
  * @param {vector<ColDef>&} col_defs 表的字段
+ * @param {string&} storage 数据文件的存储格式，FIXED、SLOTTED或PAX，为空时有VARCHAR字段就用SLOTTED，否则用FIXED
  * @param {Context*} context
  */
 void SmManager::create_table(const std::string& tab_name,
                              const std::vector<ColDef>& col_defs,
+                             const std::string& storage,
                              Context* context) {
     if (db_.is_table(tab_name)) {
         throw TableExistsError(tab_name);
     }
+    bool has_varchar = std::any_of(col_defs.begin(), col_defs.end(),
+                                   [](const ColDef& col_def) { return col_def.type == TYPE_VARCHAR; });
+    std::string storage_upper = storage;
+    std::transform(storage_upper.begin(), storage_upper.end(), storage_upper.begin(), ::toupper);
+    RmLayout layout;
+    if (storage_upper == "SLOTTED" || (storage_upper.empty() && has_varchar)) {
+        layout = RM_LAYOUT_SLOTTED;
+    } else if (storage_upper == "PAX") {
+        layout = RM_LAYOUT_PAX;
+    } else if (storage_upper == "FIXED" || storage_upper.empty()) {
+        layout = RM_LAYOUT_FIXED;
+    } else {
+        throw InvalidStorageFormatError(storage);
+    }
     // Create table meta
     int curr_offset = 0;
     TabMeta tab;
@@ -226,7 +378,12 @@ void SmManager::create_table(const std::string& tab_name,
     int record_size =
         curr_offset;  // record_size就是col
                       // meta所占的大小（表的元数据也是以记录的形式进行存储的）
-    rm_manager_->create_file(tab_name, record_size);
+    // 定长和pax格式下VARCHAR按最大长度存储，slotted格式下只存实际长度
+    std::vector<RmColDesc> rm_cols;
+    for (auto& col : tab.cols) {
+        rm_cols.push_back({.offset = col.offset, .len = col.len, .type = col.type});
+    }
+    rm_manager_->create_file(tab_name, record_size, layout, rm_cols);
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
     fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
@@ -270,16 +427,29 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {int} fill_factor B+树批量构建时的填充因子
+ * @param {IndexType} type 索引类型
+ * @param {bool} unique 是否为唯一索引，表中已有重复的key时创建失败；
+ * 非唯一的B+树索引在key后附加rid保存每一条记录；哈希和ART索引中每个key只保存一个rid，只能是唯一索引
+ * @param {bool} bloom 是否为B+树索引维护Bloom过滤器，其他类型的索引忽略
  */
 void SmManager::create_index(const std::string& tab_name,
                              const std::vector<std::string>& col_names,
-                             Context* context) {
+                             Context* context, int fill_factor, IndexType type, bool unique,
+                             bool bloom) {
     TabMeta& tab = db_.get_table(tab_name);
 
-    // 判断索引是否已经存在
-    if (ix_manager_->exists(tab_name, col_names)) {
+    // 判断索引是否已经存在，ART索引没有文件，还要检查元数据
+    if (tab.is_index(col_names) || ix_manager_->exists(tab_name, col_names)) {
         throw IndexExistsError(tab_name, col_names);
     }
+    if (fill_factor < IX_MIN_FILL_FACTOR || fill_factor > IX_MAX_FILL_FACTOR) {
+        throw InvalidFillFactorError(fill_factor);
+    }
+    if (type != INDEX_BTREE && !unique) {
+        throw InvalidIndexError(tab_name, col_names,
+                                std::string(type == INDEX_HASH ? "hash" : "ART") + " indexes must be unique");
+    }
 
     std::vector<ColMeta> cols;
     for (auto& col_name : col_names) {
@@ -295,9 +465,37 @@ void SmManager::create_index(const std::string& tab_name,
             throw ColumnNotFoundError(col_name);
         }
     }
-    // 创建索引文件
+    // 创建索引文件，为表中已有的记录构建索引，失败时删除索引文件
     std::string index_name = ix_manager_->get_index_name(tab_name, cols);
-    ix_manager_->create_index(index_name, cols);
+    BulkLoader loader(this);
+    if (type == INDEX_HASH) {
+        ix_manager_->create_hash_index(tab_name, cols);
+        auto ih = ix_manager_->open_hash_index(tab_name, cols);
+        try {
+            loader.build_hash_index(tab_name, cols, ih.get(), unique, context);
+        } catch (...) {
+            ix_manager_->close_hash_index(ih.get());
+            ix_manager_->destroy_index(tab_name, cols);
+            throw;
+        }
+        hash_ihs_.emplace(index_name, std::move(ih));
+    } else if (type == INDEX_ART) {
+        auto ih = make_art_index(cols);
+        IndexMeta index{tab_name, ih->get_key_codec().key_len(), (int)cols.size(), cols, type, unique};
+        loader.build_art_indexes(tab_name, {&index}, {ih.get()}, context);
+        art_ihs_.emplace(index_name, std::move(ih));
+    } else {
+        ix_manager_->create_index(tab_name, cols, bloom, unique);
+        auto ih = ix_manager_->open_index(tab_name, cols);
+        try {
+            loader.build_index(tab_name, cols, ih.get(), fill_factor, unique, context);
+        } catch (...) {
+            ix_manager_->close_index(ih.get());
+            ix_manager_->destroy_index(tab_name, cols);
+            throw;
+        }
+        ihs_.emplace(index_name, std::move(ih));
+    }
 
     // 更新表的元数据
     int col_tot_len = 0;
@@ -305,10 +503,7 @@ void SmManager::create_index(const std::string& tab_name,
         col_tot_len += col.len;
     }
     tab.indexes.push_back(
-        IndexMeta{tab_name, col_tot_len, (int)cols.size(), cols});
-
-    // 更新系统元数据
-    ihs_.emplace(index_name, ix_manager_->open_index(tab_name, cols));
+        IndexMeta{tab_name, col_tot_len, (int)cols.size(), cols, type, unique});
 
     // 刷入磁盘
     flush_meta();
@@ -331,17 +526,23 @@ void SmManager::drop_index(const std::string& tab_name,
     }
 
     // 删除索引文件
+    auto index = tab.get_index_meta(col_names);
     std::string index_name = ix_manager_->get_index_name(tab_name, col_names);
-    ix_manager_->close_index(ihs_.at(index_name).get());
-    ix_manager_->destroy_index(tab_name, col_names);
+    if (index->type == INDEX_HASH) {
+        ix_manager_->close_hash_index(hash_ihs_.at(index_name).get());
+        hash_ihs_.erase(index_name);
+        ix_manager_->destroy_index(tab_name, col_names);
+    } else if (index->type == INDEX_ART) {
+        art_ihs_.erase(index_name);
+    } else {
+        ix_manager_->close_index(ihs_.at(index_name).get());
+        ihs_.erase(index_name);
+        ix_manager_->destroy_index(tab_name, col_names);
+    }
 
     // 更新表的元数据
-    auto index = tab.get_index_meta(col_names);
     tab.indexes.erase(index);
 
-    // 更新系统元数据
-    ihs_.erase(index_name);
-
     // 刷入磁盘
     flush_meta();
 }
@@ -360,4 +561,329 @@ void SmManager::drop_index(const std::string& tab_name,
         col_names.push_back(col.name);
     }
     drop_index(tab_name, col_names, context);
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 把CSV文件中的数据批量导入到表中，并向客户端输出导入的记录条数和速度
+ * @param {string&} file_name CSV文件路径
+ * @param {string&} tab_name 表名称
+ * @param {Context*} context
+ */
+void SmManager::load_data(const std::string& file_name,
+                          const std::string& tab_name, Context* context) {
+    auto start = std::chrono::steady_clock::now();
+    BulkLoader loader(this);
+    size_t num_records = loader.load(file_name, tab_name, context);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (context == nullptr || context->data_send_ == nullptr) {
+        return;
+    }
+
+    double rows_per_sec = elapsed.count() > 0 ? num_records / elapsed.count() : 0;
+    char seconds[32];
+    snprintf(seconds, sizeof(seconds), "%.3f", elapsed.count());
+    std::vector<std::string> captions = {"Table", "Rows", "Seconds", "Rows/s"};
+    RecordPrinter printer(captions.size());
+    printer.print_separator(context);
+    printer.print_record(captions, context);
+    printer.print_separator(context);
+    printer.print_record({tab_name, std::to_string(num_records), seconds,
+                          std::to_string(static_cast<size_t>(rows_per_sec))},
+                         context);
+    printer.print_separator(context);
+}
+
+/**
+ * @description: 从记录中抽取索引的key（原始格式），各字段按索引中的顺序拼接
+ * @param {IndexMeta&} index 索引元数据
+ * @param {char*} rec 记录数据
+ * @param {char*} key 传出参数，长度为index.col_tot_len
+ */
+void SmManager::get_index_key(const IndexMeta& index, const char* rec, char* key) {
+    for (auto& col : index.cols) {
+        memcpy(key, rec + col.offset, col.len);
+        key += col.len;
+    }
+}
+
+/**
+ * @description: 在索引中查找key对应的rid，按索引类型分派
+ * @return {bool} 找到时返回true，rid追加到result中
+ * @param {IndexMeta&} index 索引元数据
+ * @param {char*} key 原始格式的key
+ * @param {vector<Rid>*} result 查找结果
+ * @param {Transaction*} txn
+ */
+bool SmManager::get_index_value(const IndexMeta& index, const char* key, std::vector<Rid>* result, Transaction* txn) {
+    std::string index_name = ix_manager_->get_index_name(index.tab_name, index.cols);
+    switch (index.type) {
+        case INDEX_HASH:
+            return hash_ihs_.at(index_name)->get_value(key, result, txn);
+        case INDEX_ART:
+            return art_ihs_.at(index_name)->get_value(key, result);
+        default: {
+            std::shared_lock<std::shared_mutex> lock(index_latch_);
+            return ihs_.at(index_name)->get_value(key, result, txn);
+        }
+    }
+}
+
+/**
+ * @description: 在索引中插入键值对，按索引类型分派；重复的key在插入的同一次查找中发现，不需要额外查找
+ * @return {bool} key已经存在时返回false
+ * @param {IndexMeta&} index 索引元数据
+ * @param {char*} key 原始格式的key
+ * @param {Rid&} rid 记录的位置
+ * @param {Transaction*} txn
+ */
+bool SmManager::insert_index_entry(const IndexMeta& index, const char* key, const Rid& rid, Transaction* txn) {
+    std::string index_name = ix_manager_->get_index_name(index.tab_name, index.cols);
+    switch (index.type) {
+        case INDEX_HASH:
+            return hash_ihs_.at(index_name)->insert_entry(key, rid, txn);
+        case INDEX_ART:
+            return art_ihs_.at(index_name)->insert_entry(key, rid);
+        default: {
+            std::shared_lock<std::shared_mutex> lock(index_latch_);
+            log_index_changes(index_name, true, key, index.col_tot_len, &rid, 1);
+            return ihs_.at(index_name)->insert_entry(key, rid, txn) != IX_NO_PAGE;
+        }
+    }
+}
+
+/**
+ * @description: 删除索引中key指向rid的键值对，按索引类型分派
+ * 哈希和ART索引中的key不重复，key重复的记录只有第一条在索引中，因此只有key指向的正是这条记录时才删除；
+ * B+树中由IxIndexHandle::delete_entry()按同样的规则处理，非唯一的B+树索引保存了每条记录，直接删除(key, rid)
+ * @return {bool} 是否删除了键值对
+ * @param {IndexMeta&} index 索引元数据
+ * @param {char*} key 原始格式的key
+ * @param {Rid&} rid 记录的位置
+ * @param {Transaction*} txn
+ */
+bool SmManager::delete_index_entry(const IndexMeta& index, const char* key, const Rid& rid, Transaction* txn) {
+    std::string index_name = ix_manager_->get_index_name(index.tab_name, index.cols);
+    std::vector<Rid> found;
+    switch (index.type) {
+        case INDEX_HASH: {
+            auto& ih = hash_ihs_.at(index_name);
+            return ih->get_value(key, &found, txn) && found[0] == rid && ih->delete_entry(key, txn);
+        }
+        case INDEX_ART: {
+            auto& ih = art_ihs_.at(index_name);
+            return ih->get_value(key, &found) && found[0] == rid && ih->delete_entry(key);
+        }
+        default: {
+            // 旧索引中key可能指向另一条记录，新索引中却指向这一条，因此不论旧索引中是否删除都要记入旁路日志
+            std::shared_lock<std::shared_mutex> lock(index_latch_);
+            log_index_changes(index_name, false, key, index.col_tot_len, &rid, 1);
+            return ihs_.at(index_name)->delete_entry(key, rid, txn);
+        }
+    }
+}
+
+/**
+ * @description: 在表的所有索引中插入记录对应的键值对
+ * 唯一索引中key已经存在时，删除已经插入其他索引的键值对后抛出UniqueConstraintError，由调用者撤销对记录的修改
+ * @param {TabMeta&} tab 表的元数据
+ * @param {char*} rec 记录数据
+ * @param {Rid&} rid 记录的位置
+ * @param {Transaction*} txn
+ */
+void SmManager::insert_index_entries(const TabMeta& tab, const char* rec, const Rid& rid, Transaction* txn) {
+    std::vector<const IndexMeta*> indexes;
+    for (auto& index : tab.indexes) {
+        indexes.push_back(&index);
+    }
+    insert_index_entries(indexes, rec, rid, txn);
+}
+
+/**
+ * @description: 在指定的若干个索引中插入记录对应的键值对，唯一索引冲突时的处理同上
+ * @param {vector<const IndexMeta*>&} indexes 同一张表上的索引
+ * @param {char*} rec 记录数据
+ * @param {Rid&} rid 记录的位置
+ * @param {Transaction*} txn
+ */
+void SmManager::insert_index_entries(const std::vector<const IndexMeta*>& indexes, const char* rec, const Rid& rid,
+                                     Transaction* txn) {
+    std::vector<char> key;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        auto& index = *indexes[i];
+        key.resize(index.col_tot_len);
+        get_index_key(index, rec, key.data());
+        if (insert_index_entry(index, key.data(), rid, txn) || !index.unique) {
+            continue;
+        }
+        for (size_t j = 0; j < i; ++j) {
+            key.resize(indexes[j]->col_tot_len);
+            get_index_key(*indexes[j], rec, key.data());
+            delete_index_entry(*indexes[j], key.data(), rid, txn);
+        }
+        throw UniqueConstraintError(index.tab_name, index.col_names());
+    }
+}
+
+/**
+ * @description: 在表的所有索引中删除记录对应的键值对
+ * @param {TabMeta&} tab 表的元数据
+ * @param {char*} rec 记录数据
+ * @param {Rid&} rid 记录的位置
+ * @param {Transaction*} txn
+ */
+void SmManager::delete_index_entries(const TabMeta& tab, const char* rec, const Rid& rid, Transaction* txn) {
+    std::vector<const IndexMeta*> indexes;
+    for (auto& index : tab.indexes) {
+        indexes.push_back(&index);
+    }
+    delete_index_entries(indexes, rec, rid, txn);
+}
+
+/**
+ * @description: 在指定的若干个索引中删除记录对应的键值对
+ * @param {vector<const IndexMeta*>&} indexes 同一张表上的索引
+ * @param {char*} rec 记录数据
+ * @param {Rid&} rid 记录的位置
+ * @param {Transaction*} txn
+ */
+void SmManager::delete_index_entries(const std::vector<const IndexMeta*>& indexes, const char* rec, const Rid& rid,
+                                     Transaction* txn) {
+    std::vector<char> key;
+    for (auto index : indexes) {
+        key.resize(index->col_tot_len);
+        get_index_key(*index, rec, key.data());
+        delete_index_entry(*index, key.data(), rid, txn);
+    }
+}
+
+/**
+ * @description: 向B+树索引批量导入键值对，正在REINDEX时同时记入旁路日志
+ * @param {IndexMeta&} index 索引元数据
+ * @param {char*} keys 连续存放的原始格式的key，按索引顺序排列
+ * @param {Rid*} rids 与keys一一对应的rid
+ * @param {size_t} num_keys 键值对数量
+ */
+void SmManager::bulk_load_index(const IndexMeta& index, const char* keys, const Rid* rids, size_t num_keys) {
+    std::string index_name = ix_manager_->get_index_name(index.tab_name, index.cols);
+    std::shared_lock<std::shared_mutex> lock(index_latch_);
+    log_index_changes(index_name, true, keys, index.col_tot_len, rids, num_keys);
+    ihs_.at(index_name)->bulk_load(keys, rids, num_keys);
+}
+
+/**
+ * @description: 索引正在REINDEX时，把对它的修改追加到旁路日志；调用者共享持有index_latch_
+ */
+void SmManager::log_index_changes(const std::string& index_name, bool is_insert, const char* keys, int key_len,
+                                  const Rid* rids, size_t num_keys) {
+    if (num_reindexing_.load() == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(reindex_latch_);
+    auto it = reindex_logs_.find(index_name);
+    if (it == reindex_logs_.end()) {
+        return;
+    }
+    for (size_t i = 0; i < num_keys; ++i) {
+        const char* key = keys + i * key_len;
+        it->second.push_back(ReindexLogEntry{is_insert, rids[i], std::vector<char>(key, key + key_len)});
+    }
+}
+
+/**
+ * @description: 取出目前为止的旁路日志，按顺序回放到新索引
+ * 新索引是并发扫描表得到的，某条记录的key可能是日志中任意一次修改之前或之后的值，按顺序回放后都与表一致：
+ * 插入已经存在的key不生效，删除只在key指向同一条记录时生效
+ * @return {size_t} 回放的日志条数
+ */
+size_t SmManager::replay_reindex_log(const std::string& index_name, IxIndexHandle* ih) {
+    std::vector<ReindexLogEntry> entries;
+    {
+        std::lock_guard<std::mutex> lock(reindex_latch_);
+        entries.swap(reindex_logs_.at(index_name));
+    }
+    for (auto& entry : entries) {
+        if (entry.is_insert) {
+            ih->insert_entry(entry.key.data(), entry.rid, nullptr);
+        } else {
+            ih->delete_entry(entry.key.data(), entry.rid, nullptr);
+        }
+    }
+    return entries.size();
+}
+
+/**
+ * @description: 在线重建B+树索引，不阻塞对表的修改
+ * 1. 独占index_latch_开始记录旁路日志，此后对该索引的修改都会记入日志，之前的修改都已经写入表中
+ * 2. 扫描表，按默认填充因子批量构建一个紧凑的新索引文件，期间并发的修改只写旧索引和日志
+ * 3. 分批回放日志直到剩下的日志足够少，扫描新索引重新计算统计信息
+ * 4. 独占index_latch_回放剩下的日志，用新索引替换ihs_中的旧索引
+ * 正在执行的扫描可能还持有旧索引，旧索引的文件改名后保留到关闭数据库时再删除
+ * @param {string&} tab_name 表名称
+ * @param {vector<string>&} col_names 索引包含的字段名称
+ * @param {Context*} context
+ */
+void SmManager::reindex(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+    TabMeta& tab = db_.get_table(tab_name);
+    if (!tab.is_index(col_names)) {
+        throw IndexNotFoundError(tab_name, col_names);
+    }
+    auto index = tab.get_index_meta(col_names);
+    if (index->type != INDEX_BTREE) {
+        throw InvalidReindexError(tab_name, col_names, "only B+ tree indexes can be rebuilt");
+    }
+    std::vector<ColMeta> cols = index->cols;
+    std::string index_name = ix_manager_->get_index_name(tab_name, cols);
+    std::string new_prefix = tab_name + ".reindex";
+    std::string new_name = ix_manager_->get_index_name(new_prefix, cols);
+    bool bloom = ihs_.at(index_name)->has_bloom();
+    bool unique = index->unique;
+
+    {
+        std::unique_lock<std::shared_mutex> lock(index_latch_);
+        std::lock_guard<std::mutex> log_lock(reindex_latch_);
+        if (reindex_logs_.count(index_name) > 0) {
+            throw InvalidReindexError(tab_name, col_names, "the index is already being rebuilt");
+        }
+        reindex_logs_[index_name];
+        num_reindexing_++;
+    }
+    auto stop_logging = [&]() {
+        std::lock_guard<std::mutex> log_lock(reindex_latch_);
+        reindex_logs_.erase(index_name);
+        num_reindexing_--;
+    };
+
+    // 上次重建中途退出时可能留下了新索引文件
+    if (disk_manager_->is_file(new_name)) {
+        disk_manager_->destroy_file(new_name);
+    }
+    ix_manager_->create_index(new_prefix, cols, bloom, unique);
+    auto ih = ix_manager_->open_index(new_prefix, cols);
+    try {
+        BulkLoader loader(this);
+        // 不加表锁，扫描与对表的修改并发执行；并发删除和插入同一个key时扫描可能同时看到两条记录，
+        // 唯一性由旧索引保证，这里不检查
+        loader.build_index(tab_name, cols, ih.get(), IX_DEFAULT_FILL_FACTOR, false, nullptr);
+        while (replay_reindex_log(index_name, ih.get()) > REINDEX_PAUSE_ENTRIES) {
+        }
+        // 新索引还不可见，扫描它不会阻塞对表的修改
+        ih->refresh_stats();
+    } catch (...) {
+        stop_logging();
+        ix_manager_->close_index(ih.get());
+        ix_manager_->destroy_index(new_prefix, cols);
+        throw;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(index_latch_);
+    replay_reindex_log(index_name, ih.get());
+    stop_logging();
+    std::string retired_name;
+    for (int i = 0; retired_name.empty() || disk_manager_->is_file(retired_name); ++i) {
+        retired_name = index_name + ".retired" + std::to_string(i);
+    }
+    disk_manager_->rename_file(index_name, retired_name);
+    disk_manager_->rename_file(new_name, index_name);
+    retired_ihs_.emplace_back(retired_name, std::move(ihs_.at(index_name)));
+    ihs_.at(index_name) = std::move(ih);
+}
@@ -10,7 +10,12 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
 #include "index/ix.h"
+#include "index/ix_art.h"
 #include "record/rm_file_handle.h"
 #include "sm_defs.h"
 #include "sm_meta.h"
@@ -30,12 +35,29 @@ class SmManager {
     DbMeta db_;             // 当前打开的数据库的元数据
     std::unordered_map<std::string, std::unique_ptr<RmFileHandle>> fhs_;    // file name -> record file handle, 当前数据库中每张表的数据文件
     std::unordered_map<std::string, std::unique_ptr<IxIndexHandle>> ihs_;   // file name -> index file handle, 当前数据库中每个索引的文件
+    std::unordered_map<std::string, std::unique_ptr<IxHashIndexHandle>> hash_ihs_;  // file name -> hash index file handle, 当前数据库中每个哈希索引的文件
+    std::unordered_map<std::string, std::unique_ptr<IxArtIndex>> art_ihs_;          // index name -> ART index, 当前数据库中每个内存ART索引
    private:
     DiskManager* disk_manager_;
     BufferPoolManager* buffer_pool_manager_;
     RmManager* rm_manager_;
     IxManager* ix_manager_;
 
+    /* REINDEX期间对该索引的一次修改，重建完成后按顺序回放到新索引 */
+    struct ReindexLogEntry {
+        bool is_insert;
+        Rid rid;
+        std::vector<char> key;      // 原始格式的key
+    };
+
+    // 维护B+树索引时共享持有，REINDEX开始记录旁路日志和换入新索引时独占持有
+    std::shared_mutex index_latch_;
+    std::mutex reindex_latch_;                  // 保护reindex_logs_
+    std::unordered_map<std::string, std::vector<ReindexLogEntry>> reindex_logs_;  // 正在重建的索引 -> 旁路日志
+    std::atomic<int> num_reindexing_{0};        // 为0时维护索引不需要查reindex_logs_
+    // 被REINDEX替换下来的旧索引，可能还有正在执行的扫描在使用，文件改名后保留到关闭数据库时再删除
+    std::vector<std::pair<std::string, std::unique_ptr<IxIndexHandle>>> retired_ihs_;
+
    public:
     SmManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, RmManager* rm_manager,
               IxManager* ix_manager)
@@ -68,13 +90,52 @@ class SmManager {
 
     void desc_table(const std::string& tab_name, Context* context);
 
-    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
+    void show_index_stats(const std::string& tab_name, Context* context);
+
+    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, const std::string& storage,
+                      Context* context);
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      int fill_factor = IX_DEFAULT_FILL_FACTOR, IndexType type = INDEX_BTREE, bool unique = false,
+                      bool bloom = false);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+    void reindex(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+
+    void load_data(const std::string& file_name, const std::string& tab_name, Context* context);
+
+    static void get_index_key(const IndexMeta& index, const char* rec, char* key);
+
+    bool get_index_value(const IndexMeta& index, const char* key, std::vector<Rid>* result, Transaction* txn);
+
+    bool insert_index_entry(const IndexMeta& index, const char* key, const Rid& rid, Transaction* txn);
+
+    bool delete_index_entry(const IndexMeta& index, const char* key, const Rid& rid, Transaction* txn);
+
+    void insert_index_entries(const TabMeta& tab, const char* rec, const Rid& rid, Transaction* txn);
+
+    void insert_index_entries(const std::vector<const IndexMeta*>& indexes, const char* rec, const Rid& rid,
+                              Transaction* txn);
+
+    void delete_index_entries(const TabMeta& tab, const char* rec, const Rid& rid, Transaction* txn);
+
+    void delete_index_entries(const std::vector<const IndexMeta*>& indexes, const char* rec, const Rid& rid,
+                              Transaction* txn);
+
+    void bulk_load_index(const IndexMeta& index, const char* keys, const Rid* rids, size_t num_keys);
+
+   private:
+    static std::unique_ptr<IxArtIndex> make_art_index(const std::vector<ColMeta>& cols);
+
+    void rebuild_art_indexes();
+
+    void log_index_changes(const std::string& index_name, bool is_insert, const char* keys, int key_len,
+                           const Rid* rids, size_t num_keys);
+
+    size_t replay_reindex_log(const std::string& index_name, IxIndexHandle* ih);
 };
\ No newline at end of file
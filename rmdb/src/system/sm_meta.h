@@ -39,15 +39,29 @@ struct ColMeta {
     }
 };
 
+/* 索引的类型：B+树支持范围查询，哈希索引只支持等值查询；ART索引只在内存中，打开数据库时从表中重建 */
+enum IndexType { INDEX_BTREE = 0, INDEX_HASH = 1, INDEX_ART = 2 };
+
 /* 索引元数据 */
 struct IndexMeta {
     std::string tab_name;           // 索引所属表名称
     int col_tot_len;                // 索引字段长度总和
     int col_num;                    // 索引字段数量
     std::vector<ColMeta> cols;      // 索引包含的字段
+    IndexType type = INDEX_BTREE;   // 索引的类型
+    bool unique = false;            // 唯一索引（UNIQUE / PRIMARY KEY），插入重复的key时报错；否则重复的key只保留第一条
+
+    std::vector<std::string> col_names() const {
+        std::vector<std::string> names;
+        for (auto &col : cols) {
+            names.push_back(col.name);
+        }
+        return names;
+    }
 
     friend std::ostream &operator<<(std::ostream &os, const IndexMeta &index) {
-        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num;
+        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num << " " << index.type << " "
+           << index.unique;
         for(auto& col: index.cols) {
             os << "\n" << col;
         }
@@ -55,7 +69,9 @@ struct IndexMeta {
     }
 
     friend std::istream &operator>>(std::istream &is, IndexMeta &index) {
-        is >> index.tab_name >> index.col_tot_len >> index.col_num;
+        int type;
+        is >> index.tab_name >> index.col_tot_len >> index.col_num >> type >> index.unique;
+        index.type = static_cast<IndexType>(type);
         for(int i = 0; i < index.col_num; ++i) {
             ColMeta col;
             is >> col;
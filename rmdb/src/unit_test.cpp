@@ -12,19 +12,26 @@ See the Mulan PSL v2 for more details. */
 
 #define private public
 
+#include "index/ix.h"
+#include "index/ix_art.h"
 #include "record/rm.h"
 #include "storage/buffer_pool_manager.h"
 
 #undef private
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <set>
 #include <string>
@@ -32,9 +39,17 @@ See the Mulan PSL v2 for more details. */
 #include <unordered_map>
 #include <vector>
 
+#include "analyze/analyze.h"
+#include "execution/exchange_queue.h"
+#include "execution/executor_index_scan.h"
+#include "execution/executor_parallel_seq_scan.h"
+#include "execution/predicate.h"
 #include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
+#include "portal.h"
 #include "replacer/lru_replacer.h"
 #include "storage/disk_manager.h"
+#include "system/sm.h"
 
 const std::string TEST_DB_NAME = "BufferPoolManagerTest_db";  // 以数据库名作为根目录
 const std::string TEST_FILE_NAME = "basic";                   // 测试文件的名字
@@ -661,3 +676,2375 @@ TEST(RecordManagerTest, SimpleTest) {
     rm_manager->close_file(file_handle.get());
     rm_manager->destroy_file(filename);
 }
+
+// 生成一条含有变长字段的记录，变长字段的实际长度随机，剩余部分以'\0'补齐
+void rand_var_buf(const std::vector<RmVarCol> &var_cols, int record_size, char *buf) {
+    rand_buf(record_size, buf);
+    for (auto &col : var_cols) {
+        int len = rand() % (col.len + 1);
+        for (int i = 0; i < len; i++) {
+            buf[col.offset + i] = 'a' + rand() % 26;
+        }
+        memset(buf + col.offset + len, 0, col.len - len);
+    }
+}
+
+TEST(RecordManagerTest, SlottedTest) {
+    srand((unsigned)time(nullptr));
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+
+    std::string filename = "abc_slotted.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+
+    // int, varchar(100), int, varchar(300)
+    std::vector<RmColDesc> cols = {{.offset = 0, .len = 4, .type = TYPE_INT},
+                                   {.offset = 4, .len = 100, .type = TYPE_VARCHAR},
+                                   {.offset = 104, .len = 4, .type = TYPE_INT},
+                                   {.offset = 108, .len = 300, .type = TYPE_VARCHAR}};
+    std::vector<RmVarCol> var_cols = {{.offset = 4, .len = 100}, {.offset = 108, .len = 300}};
+    int record_size = 408;
+    rm_manager->create_file(filename, record_size, RM_LAYOUT_SLOTTED, cols);
+    auto file_handle = rm_manager->open_file(filename);
+    assert(file_handle->file_hdr_.layout == RM_LAYOUT_SLOTTED);
+    assert(file_handle->file_hdr_.num_var_cols == 2);
+
+    char write_buf[PAGE_SIZE];
+    for (int round = 0; round < 2000; round++) {
+        double insert_prob = 1. - mock.size() / 500.;
+        double dice = rand() * 1. / RAND_MAX;
+        if (mock.empty() || dice < insert_prob) {
+            rand_var_buf(var_cols, record_size, write_buf);
+            Rid rid = file_handle->insert_record(write_buf, nullptr);
+            mock[rid] = std::string((char *)write_buf, record_size);
+        } else {
+            int rid_idx = rand() % mock.size();
+            auto it = mock.begin();
+            for (int i = 0; i < rid_idx; i++) {
+                it++;
+            }
+            auto rid = it->first;
+            if (rand() % 2 == 0) {
+                // 更新后的记录可能变长，放不下时会搬到其他页面，但rid保持不变
+                rand_var_buf(var_cols, record_size, write_buf);
+                file_handle->update_record(rid, write_buf, nullptr);
+                mock[rid] = std::string((char *)write_buf, record_size);
+            } else {
+                file_handle->delete_record(rid, nullptr);
+                mock.erase(rid);
+            }
+        }
+        if (round % 100 == 0) {
+            rm_manager->close_file(file_handle.get());
+            file_handle = rm_manager->open_file(filename);
+        }
+        check_equal(file_handle.get(), mock);
+    }
+
+    // 删除后按原rid恢复（事务回滚），恢复的记录可以比原记录更长
+    auto rid = mock.begin()->first;
+    file_handle->delete_record(rid, nullptr);
+    rand_var_buf(var_cols, record_size, write_buf);
+    file_handle->insert_record(rid, write_buf);
+    mock[rid] = std::string((char *)write_buf, record_size);
+    check_equal(file_handle.get(), mock);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+TEST(RecordManagerTest, PaxTest) {
+    srand((unsigned)time(nullptr));
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+
+    std::string filename = "abc_pax.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+
+    // int, char(20), float, datetime
+    std::vector<RmColDesc> cols = {{.offset = 0, .len = 4, .type = TYPE_INT},
+                                   {.offset = 4, .len = 20, .type = TYPE_STRING},
+                                   {.offset = 24, .len = 4, .type = TYPE_FLOAT},
+                                   {.offset = 28, .len = 8, .type = TYPE_DATETIME}};
+    int record_size = 36;
+    rm_manager->create_file(filename, record_size, RM_LAYOUT_PAX, cols);
+    auto file_handle = rm_manager->open_file(filename);
+    assert(file_handle->file_hdr_.layout == RM_LAYOUT_PAX);
+    assert(file_handle->file_hdr_.num_cols == 4);
+
+    char write_buf[PAGE_SIZE];
+    for (int round = 0; round < 2000; round++) {
+        double insert_prob = 1. - mock.size() / 1000.;
+        double dice = rand() * 1. / RAND_MAX;
+        if (mock.empty() || dice < insert_prob) {
+            rand_buf(record_size, write_buf);
+            Rid rid = file_handle->insert_record(write_buf, nullptr);
+            mock[rid] = std::string((char *)write_buf, record_size);
+        } else {
+            int rid_idx = rand() % mock.size();
+            auto it = mock.begin();
+            for (int i = 0; i < rid_idx; i++) {
+                it++;
+            }
+            auto rid = it->first;
+            if (rand() % 2 == 0) {
+                rand_buf(record_size, write_buf);
+                file_handle->update_record(rid, write_buf, nullptr);
+                mock[rid] = std::string((char *)write_buf, record_size);
+            } else {
+                file_handle->delete_record(rid, nullptr);
+                mock.erase(rid);
+            }
+        }
+        if (round % 100 == 0) {
+            rm_manager->close_file(file_handle.get());
+            file_handle = rm_manager->open_file(filename);
+        }
+    }
+    check_equal(file_handle.get(), mock);
+
+    // 扫描时在第一个字段的mini page上直接过滤
+    size_t expect = std::count_if(mock.begin(), mock.end(),
+                                  [](auto &entry) { return *(const int *)entry.second.c_str() < 0; });
+    std::vector<RmScanFilter> filters = {
+        {.offset = 0, .len = 4, .pred = [](const char *field) { return *(const int *)field < 0; }}};
+    size_t num_records = 0;
+    for (RmScan scan(file_handle.get(), filters); !scan.is_end(); scan.next()) {
+        auto rec = file_handle->get_record(scan.rid(), nullptr);
+        assert(*(int *)rec->data < 0);
+        num_records++;
+    }
+    assert(num_records == expect);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+TEST(RecordManagerTest, ZoneMapTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "abc_zone.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+
+    // int(按插入顺序递增), float, char(24)
+    std::vector<RmColDesc> cols = {{.offset = 0, .len = 4, .type = TYPE_INT},
+                                   {.offset = 4, .len = 4, .type = TYPE_FLOAT},
+                                   {.offset = 8, .len = 24, .type = TYPE_STRING}};
+    int record_size = 32;
+    rm_manager->create_file(filename, record_size, RM_LAYOUT_FIXED, cols);
+    auto file_handle = rm_manager->open_file(filename);
+
+    char write_buf[PAGE_SIZE];
+    std::vector<Rid> rids;
+    for (int i = 0; i < 10000; i++) {
+        rand_buf(record_size, write_buf);
+        *(int *)write_buf = i;
+        rids.push_back(file_handle->insert_record(write_buf, nullptr));
+    }
+
+    auto count_range = [&](int lo, int hi) {
+        std::vector<RmZoneRange> ranges = {{.offset = 0, .lo = (double)lo, .hi = (double)hi}};
+        std::vector<RmScanFilter> filters = {
+            {.offset = 0, .len = 4, .pred = [&](const char *field) { return *(int *)field >= lo && *(int *)field <= hi; }}};
+        int num_records = 0;
+        for (RmScan scan(file_handle.get(), filters, ranges); !scan.is_end(); scan.next()) {
+            num_records++;
+        }
+        return num_records;
+    };
+    assert(count_range(5000, 5099) == 100);
+    // 第一页的记录都小于5000，可以整页跳过
+    std::vector<RmZoneRange> ranges = {{.offset = 0, .lo = 5000, .hi = 5099}};
+    assert(!file_handle->get_zone_map().may_contain(RM_FIRST_RECORD_PAGE, ranges));
+    assert(file_handle->get_zone_map().may_contain(rids[5000].page_no, ranges));
+
+    // 关闭后重新打开，zone map从文件中读出
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    assert(!file_handle->get_zone_map().may_contain(RM_FIRST_RECORD_PAGE, ranges));
+    assert(count_range(5000, 5099) == 100);
+
+    // 更新只会放宽范围，删空的页面会被整体跳过
+    *(int *)write_buf = 5050;
+    file_handle->update_record(rids[0], write_buf, nullptr);
+    assert(file_handle->get_zone_map().may_contain(RM_FIRST_RECORD_PAGE, ranges));
+    assert(count_range(5000, 5099) == 101);
+    for (auto &rid : rids) {
+        if (rid.page_no == RM_FIRST_RECORD_PAGE) {
+            file_handle->delete_record(rid, nullptr);
+        }
+    }
+    std::vector<RmZoneRange> all = {{.offset = 0, .lo = -1e9, .hi = 1e9}};
+    assert(!file_handle->get_zone_map().may_contain(RM_FIRST_RECORD_PAGE, all));
+    assert(count_range(5000, 5099) == 100);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 按批扫描：三种布局下，next_batch每次最多取出一批记录，过滤后得到的记录和位置必须与逐条扫描完全相同
+ */
+TEST(RecordManagerTest, BatchScanTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::vector<RmColDesc> cols = {{.offset = 0, .len = 4, .type = TYPE_INT},
+                                   {.offset = 4, .len = 28, .type = TYPE_STRING}};
+    int record_size = 32;
+    for (RmLayout layout : {RM_LAYOUT_FIXED, RM_LAYOUT_PAX, RM_LAYOUT_SLOTTED}) {
+        std::string filename = "abc_batch.txt";
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        rm_manager->create_file(filename, record_size, layout, cols);
+        auto file_handle = rm_manager->open_file(filename);
+
+        char write_buf[PAGE_SIZE];
+        for (int i = 0; i < 5000; i++) {
+            rand_buf(record_size, write_buf);
+            *(int *)write_buf = i;
+            Rid rid = file_handle->insert_record(write_buf, nullptr);
+            if (i % 3 == 0) {
+                file_handle->delete_record(rid, nullptr);
+            }
+        }
+
+        std::vector<RmScanFilter> filters = {
+            {.offset = 0, .len = 4, .pred = [](const char *field) { return *(const int *)field % 5 != 0; }}};
+        std::vector<Rid> expect_rids;
+        std::string expect_data;
+        for (RmScan scan(file_handle.get(), filters); !scan.is_end(); scan.next()) {
+            auto rec = file_handle->get_record(scan.rid(), nullptr);
+            if (layout == RM_LAYOUT_SLOTTED && *(int *)rec->data % 5 == 0) {
+                continue;   // slotted布局扫描时不过滤
+            }
+            expect_rids.push_back(scan.rid());
+            expect_data.append(rec->data, record_size);
+        }
+        assert(expect_rids.size() == 5000 - 1667 - 666);
+
+        constexpr int batch_size = 100;
+        std::vector<char> buf(batch_size * record_size);
+        Rid rids[batch_size];
+        std::vector<Rid> batch_rids;
+        std::string batch_data;
+        RmScan scan(file_handle.get(), filters);
+        while (!scan.is_end()) {
+            int n = scan.next_batch(buf.data(), rids, batch_size);
+            assert(n > 0 && n <= batch_size);
+            for (int i = 0; i < n; i++) {
+                if (layout == RM_LAYOUT_SLOTTED && *(int *)(buf.data() + i * record_size) % 5 == 0) {
+                    continue;
+                }
+                batch_rids.push_back(rids[i]);
+                batch_data.append(buf.data() + i * record_size, record_size);
+            }
+        }
+        assert(batch_rids == expect_rids && batch_data == expect_data);
+
+        rm_manager->close_file(file_handle.get());
+        rm_manager->destroy_file(filename);
+    }
+}
+
+/**
+ * @brief 多个线程并发地插入、查找和删除，检查B+树的结构和内容；
+ * 插入引起分裂、删除引起合并的同时，另一个线程不断地做范围扫描，输出按key升序且不越过上下界
+ */
+TEST(IndexManagerTest, ConcurrencyTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "abc_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "a", .type = TYPE_INT, .len = 4, .offset = 0},
+                                       {.tab_name = filename, .name = "b", .type = TYPE_INT, .len = 4, .offset = 4}};
+    if (ix_manager->exists(filename, index_cols)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols);
+    auto ih = ix_manager->open_index(filename, index_cols);
+
+    constexpr int num_threads = 4;
+    constexpr int num_keys = 20000;
+    std::vector<int> keys(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+    auto make_key = [](int k, char *key) {
+        *(int *)key = k % 100;
+        *(int *)(key + 4) = k / 100;
+    };
+    auto key_order = [](int k) { return (k % 100) * 1000 + k / 100; };
+    // 扫描第一个字段等于w的键值对，检查输出的key在范围内且升序，返回输出的个数
+    auto scan_range = [&](int w) {
+        int raw[2] = {w, 0};
+        char lower[8], upper[8];
+        ih->get_key_codec().encode((const char *)raw, lower);
+        raw[1] = num_keys / 100 - 1;
+        ih->get_key_codec().encode((const char *)raw, upper);
+        int n = 0, prev = -1;
+        for (IxScan scan(ih.get(), lower, false, upper, false, buffer_pool_manager.get()); !scan.is_end(); scan.next()) {
+            int k = scan.rid().page_no;
+            assert(k % 100 == w && key_order(k) > prev);
+            prev = key_order(k);
+            n++;
+        }
+        return n;
+    };
+    auto run = [&](const std::function<void(int)> &op) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                for (int i = t; i < num_keys; i += num_threads) {
+                    op(keys[i]);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    };
+
+    // 并发插入，同时查找已经插入的key，另一个线程做范围扫描
+    std::atomic<bool> inserting{true};
+    std::thread insert_scanner([&]() {
+        for (int w = 0; inserting; w = (w + 1) % 100) {
+            scan_range(w);
+        }
+    });
+    run([&](int k) {
+        char key[8];
+        make_key(k, key);
+        page_id_t leaf = ih->insert_entry(key, Rid{k, k}, nullptr);
+        assert(leaf != IX_NO_PAGE);
+        std::vector<Rid> result;
+        bool found = ih->get_value(key, &result, nullptr);
+        assert(found && result[0].page_no == k);
+    });
+    inserting = false;
+    insert_scanner.join();
+    char key[8];
+    make_key(0, key);
+    page_id_t leaf = ih->insert_entry(key, Rid{0, 0}, nullptr);
+    assert(leaf == IX_NO_PAGE);
+
+    // 并发删除一半的key，同时不加latch coupling的读者始终能找到另一半key
+    std::atomic<bool> deleting{true};
+    std::thread reader([&]() {
+        while (deleting) {
+            for (int k = 1; k < num_keys; k += 2) {
+                char key[8];
+                make_key(k, key);
+                std::vector<Rid> result;
+                bool found = ih->get_value(key, &result, nullptr);
+                assert(found && result[0].page_no == k);
+            }
+        }
+    });
+    // 范围扫描不会读到被合并回收的叶结点，第一个字段为奇数的key都不删除，始终全部输出
+    std::thread delete_scanner([&]() {
+        for (int w = 0; deleting; w = (w + 1) % 100) {
+            int n = scan_range(w);
+            assert(w % 2 == 0 || n == num_keys / 100);
+        }
+    });
+    run([&](int k) {
+        if (k % 2 == 0) {
+            char key[8];
+            make_key(k, key);
+            bool deleted = ih->delete_entry(key, nullptr);
+            assert(deleted);
+        }
+    });
+    deleting = false;
+    reader.join();
+    delete_scanner.join();
+    for (int k = 0; k < num_keys; k++) {
+        make_key(k, key);
+        std::vector<Rid> result;
+        bool found = ih->get_value(key, &result, nullptr);
+        assert(found == (k % 2 == 1));
+    }
+
+    // 叶子链表按key升序排列
+    int num_scanned = 0, prev = -1;
+    for (IxScan scan(ih.get(), buffer_pool_manager.get()); !scan.is_end(); scan.next()) {
+        int k = scan.rid().page_no;
+        assert(k % 2 == 1 && key_order(k) > prev);
+        prev = key_order(k);
+        num_scanned++;
+    }
+    assert(num_scanned == num_keys / 2);
+
+    // 删空后重新插入
+    run([&](int k) {
+        if (k % 2 == 1) {
+            char key[8];
+            make_key(k, key);
+            bool deleted = ih->delete_entry(key, nullptr);
+            assert(deleted);
+        }
+    });
+    assert(ih->leaf_begin() == ih->leaf_end());
+    make_key(42, key);
+    leaf = ih->insert_entry(key, Rid{42, 42}, nullptr);
+    assert(leaf != IX_NO_PAGE);
+    assert(ih->lower_bound(key) == ih->leaf_begin());
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief B+树并发读写的吞吐量，默认不运行：--gtest_also_run_disabled_tests --gtest_filter=*ConcurrencyBench*
+ * 每个线程各自插入不相交的一组key，每插入一个key做若干次随机点查
+ */
+TEST(IndexManagerTest, DISABLED_ConcurrencyBench) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "bench_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "a", .type = TYPE_INT, .len = 4, .offset = 0}};
+    constexpr int num_keys = 200000;
+    constexpr int reads_per_insert = 4;
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        if (ix_manager->exists(filename, index_cols)) {
+            ix_manager->destroy_index(filename, index_cols);
+        }
+        ix_manager->create_index(filename, index_cols);
+        auto ih = ix_manager->open_index(filename, index_cols);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 rng(t);
+                std::vector<Rid> result;
+                for (int k = t; k < num_keys; k += num_threads) {
+                    ih->insert_entry((const char *)&k, Rid{k, 0}, nullptr);
+                    for (int r = 0; r < reads_per_insert; r++) {
+                        int target = rng() % (k + 1);
+                        result.clear();
+                        ih->get_value((const char *)&target, &result, nullptr);
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double num_ops = (double)num_keys * (1 + reads_per_insert);
+        std::cout << "threads=" << num_threads << " ops/s=" << static_cast<size_t>(num_ops / elapsed.count()) << "\n";
+
+        ix_manager->close_index(ih.get());
+        ix_manager->destroy_index(filename, index_cols);
+    }
+}
+
+/**
+ * @brief 编码后的key按memcmp的顺序必须与原始key按ix_compare的顺序一致，且能解码回原始key；
+ * 针对不同key长度选择的结点内查找函数，结果必须与逐个比较的查找一致
+ */
+TEST(IndexManagerTest, KeyCodecTest) {
+    std::mt19937 rng(233);
+    auto check = [&](const std::vector<ColType> &col_types, const std::vector<int> &col_lens, auto gen_key) {
+        IxKeyCodec codec;
+        codec.init(col_types, col_lens);
+        int key_len = codec.key_len();
+        IxKeySearch fast, generic;
+        fast.init(key_len);
+        generic.init(key_len);
+        generic.set_generic();
+        for (int n : {0, 1, 3, 15, 16, 17, 100, 400}) {
+            std::vector<std::vector<char>> sorted(n, std::vector<char>(key_len));
+            for (auto &key : sorted) gen_key(key.data());
+            std::sort(sorted.begin(), sorted.end(), [&](const auto &a, const auto &b) {
+                return ix_compare(a.data(), b.data(), col_types, col_lens) < 0;
+            });
+            std::vector<char> keys(n * key_len + 1);
+            std::vector<char> decoded(key_len);
+            for (int i = 0; i < n; ++i) {
+                codec.encode(sorted[i].data(), keys.data() + i * key_len);
+                codec.decode(keys.data() + i * key_len, decoded.data());
+                assert(memcmp(decoded.data(), sorted[i].data(), key_len) == 0);
+            }
+            std::vector<char> raw(key_len), target(key_len);
+            for (int q = 0; q < 200; ++q) {
+                if (n > 0 && q % 2 == 0) {
+                    raw = sorted[rng() % n];
+                } else {
+                    gen_key(raw.data());
+                }
+                codec.encode(raw.data(), target.data());
+                int lower = 0, upper = 0;
+                for (int i = 0; i < n; ++i) {
+                    int res = ix_compare(sorted[i].data(), raw.data(), col_types, col_lens);
+                    lower += res < 0;
+                    upper += res <= 0;
+                }
+                for (auto *ks : {&fast, &generic}) {
+                    assert(ks->lower_bound(keys.data(), 0, n, target.data()) == lower);
+                    assert(ks->upper_bound(keys.data(), std::min(n, 1), n, target.data()) == std::max(upper, std::min(n, 1)));
+                }
+            }
+        }
+    };
+    check({TYPE_INT}, {4}, [&](char *key) { *(int *)key = (int)(rng() % 1000) - 500; });
+    check({TYPE_FLOAT}, {4}, [&](char *key) { *(float *)key = (float)(rng() % 1000) / 8 - 60.5f; });
+    check({TYPE_DATETIME}, {8}, [&](char *key) { *(int64_t *)key = (int64_t)(rng() % 1000) * 1000000007LL; });
+    check({TYPE_STRING}, {6}, [&](char *key) { for (int i = 0; i < 6; ++i) key[i] = 'a' + rng() % 3; });
+    check({TYPE_INT, TYPE_INT, TYPE_INT}, {4, 4, 4}, [&](char *key) {
+        for (int i = 0; i < 3; ++i) ((int *)key)[i] = (int)(rng() % 5) - 2;
+    });
+    check({TYPE_INT, TYPE_DATETIME, TYPE_INT}, {4, 8, 4}, [&](char *key) {
+        *(int *)key = (int)(rng() % 3) - 1;
+        *(int64_t *)(key + 4) = (int64_t)(rng() % 3) << 40;
+        *(int *)(key + 12) = (int)(rng() % 100) - 50;
+    });
+    check({TYPE_INT, TYPE_STRING, TYPE_FLOAT}, {4, 3, 4}, [&](char *key) {
+        *(int *)key = (int)(rng() % 10) - 5;
+        for (int i = 0; i < 3; ++i) key[4 + i] = 'x' + rng() % 2;
+        *(float *)(key + 7) = (float)(rng() % 7) - 3.5f;
+    });
+}
+
+/**
+ * @brief 较长的字符串key：内部结点中只存放截断后的分隔key和公共前缀之外的部分，
+ * 插入、删除引起的分裂、合并和重分配，以及批量加载之后，查找和叶子链表的顺序都必须正确
+ */
+TEST(IndexManagerTest, PrefixCompressionTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    constexpr int key_len = 64;
+    constexpr int num_keys = 20000;
+    std::string filename = "prefix_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "s", .type = TYPE_STRING, .len = key_len, .offset = 0}};
+    // 一半的key在前部就能区分、后面跟着随机的字节；另一半只在最后几个字节不同，分隔key无法截断
+    std::mt19937 rng(7);
+    std::vector<std::string> keys;
+    for (int i = 0; i < num_keys; i++) {
+        char key[key_len + 1];
+        if (i % 2 == 0) {
+            snprintf(key, sizeof(key), "warehouse-district-customer-%08d-", i);
+            for (size_t j = strlen(key); j < key_len; j++) key[j] = 'a' + rng() % 26;
+        } else {
+            memset(key, 'x', key_len);
+            snprintf(key + key_len - 8, 9, "%08d", i);
+        }
+        keys.emplace_back(key, key_len);
+    }
+    std::vector<int> order(num_keys);
+    for (int i = 0; i < num_keys; i++) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+    auto check_scan = [&](IxIndexHandle *ih, int step) {
+        std::vector<std::string> expected;
+        for (int i = 0; i < num_keys; i += step) expected.push_back(keys[i]);
+        std::sort(expected.begin(), expected.end());
+        size_t pos = 0;
+        for (IxScan scan(ih, buffer_pool_manager.get()); !scan.is_end(); scan.next()) {
+            assert(pos < expected.size() && keys[scan.rid().page_no] == expected[pos]);
+            pos++;
+        }
+        assert(pos == expected.size());
+    };
+
+    if (ix_manager->exists(filename, index_cols)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    for (int i : order) {
+        page_id_t leaf = ih->insert_entry(keys[i].data(), Rid{i, i}, nullptr);
+        assert(leaf != IX_NO_PAGE);
+    }
+    for (int i = 0; i < num_keys; i++) {
+        std::vector<Rid> result;
+        bool found = ih->get_value(keys[i].data(), &result, nullptr);
+        assert(found && result[0].page_no == i);
+    }
+    check_scan(ih.get(), 1);
+    // 删除3/4的key，触发合并与重分配
+    for (int i : order) {
+        if (i % 4 != 0) {
+            bool deleted = ih->delete_entry(keys[i].data(), nullptr);
+            assert(deleted);
+        }
+    }
+    for (int i = 0; i < num_keys; i++) {
+        std::vector<Rid> result;
+        bool found = ih->get_value(keys[i].data(), &result, nullptr);
+        assert(found == (i % 4 == 0));
+    }
+    check_scan(ih.get(), 4);
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+
+    // 批量加载排好序的key
+    ix_manager->create_index(filename, index_cols);
+    ih = ix_manager->open_index(filename, index_cols);
+    std::vector<int> sorted = order;
+    std::sort(sorted.begin(), sorted.end(), [&](int a, int b) { return keys[a] < keys[b]; });
+    std::string data;
+    std::vector<Rid> rids;
+    for (int i : sorted) {
+        data += keys[i];
+        rids.push_back(Rid{i, i});
+    }
+    ih->bulk_load(data.data(), rids.data(), num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        std::vector<Rid> result;
+        bool found = ih->get_value(keys[i].data(), &result, nullptr);
+        assert(found && result[0].page_no == i);
+    }
+    check_scan(ih.get(), 1);
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief 外部排序：多个生产者并行加入键值对，内存不够时写入临时文件，归并结果必须有序且不丢失；
+ * 按填充因子批量构建的B+树，叶结点不超过填充因子对应的容量，之后仍能正常插入和删除
+ */
+TEST(IndexManagerTest, BulkBuildTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "bulk_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "a", .type = TYPE_INT, .len = 4, .offset = 0}};
+    if (ix_manager->exists(filename, index_cols)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    const IxKeyCodec &codec = ih->get_key_codec();
+
+    // 每个key出现两次，rid记录第几次出现
+    constexpr int num_threads = 3;
+    constexpr int num_keys = 30000;
+    {
+        IxExternalSorter sorter(filename, 4, 64 << 10, num_threads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                IxSortWriter writer(&sorter);
+                std::vector<int> keys;
+                for (int k = t; k < num_keys * 2; k += num_threads) keys.push_back(k);
+                std::shuffle(keys.begin(), keys.end(), std::mt19937(t));
+                for (int k : keys) {
+                    int key = k / 2 - num_keys / 2;
+                    char encoded[4];
+                    codec.encode((const char *)&key, encoded);
+                    writer.add(encoded, Rid{key, k % 2});
+                }
+                writer.finish();
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        constexpr int fill_factor = 70;
+        IxBulkBuilder builder(ih.get(), fill_factor);
+        sorter.start_merge();
+        const char *key;
+        Rid rid;
+        int count = 0, prev = INT32_MIN;
+        while (sorter.next(&key, &rid)) {
+            char decoded[4];
+            codec.decode(key, decoded);
+            assert(*(int *)decoded == rid.page_no && rid.page_no >= prev);
+            prev = rid.page_no;
+            bool appended = builder.append(key, rid);
+            assert(appended == (count % 2 == 0));
+            count++;
+        }
+        assert(count == num_keys * 2);
+        builder.finish();
+        assert(builder.num_entries() == num_keys);
+    }
+
+    for (int key = -num_keys / 2; key < num_keys / 2; key++) {
+        std::vector<Rid> result;
+        bool found = ih->get_value((const char *)&key, &result, nullptr);
+        assert(found && result[0].page_no == key);
+    }
+    int num_scanned = 0;
+    for (IxScan scan(ih.get(), buffer_pool_manager.get()); !scan.is_end(); scan.next()) {
+        assert(scan.rid().page_no == num_scanned - num_keys / 2);
+        num_scanned++;
+    }
+    assert(num_scanned == num_keys);
+
+    // 填充因子留出的空间可以直接插入，不需要分裂
+    Iid first = ih->leaf_begin();
+    int key = -num_keys / 2 - 1;
+    page_id_t leaf = ih->insert_entry((const char *)&key, Rid{key, 0}, nullptr);
+    assert(leaf == first.page_no);
+    for (int key = -num_keys / 2; key < num_keys / 2; key += 2) {
+        bool deleted = ih->delete_entry((const char *)&key, nullptr);
+        assert(deleted);
+    }
+    for (int key = -num_keys / 2; key < num_keys / 2; key++) {
+        std::vector<Rid> result;
+        bool found = ih->get_value((const char *)&key, &result, nullptr);
+        assert(found == (key % 2 != 0));
+    }
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief 复合索引上的范围扫描：等值前缀之后的字段不受限制时，按编码后的key把这些字段填成全0或全0xff，
+ * 再按严格或不严格的上下界扫描
+ */
+TEST(IndexManagerTest, RangeScanTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "range_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "w", .type = TYPE_INT, .len = 4, .offset = 0},
+                                       {.tab_name = filename, .name = "d", .type = TYPE_INT, .len = 4, .offset = 4}};
+    if (ix_manager->exists(filename, index_cols)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    const IxKeyCodec &codec = ih->get_key_codec();
+
+    constexpr int num_w = 10;
+    constexpr int num_d = 100;
+    for (int w = 0; w < num_w; w++) {
+        for (int d = -num_d / 2; d < num_d / 2; d++) {
+            int key[2] = {w, d};
+            ih->insert_entry((const char *)key, Rid{w, d}, nullptr);
+        }
+    }
+
+    // 编码raw的前raw_len个字节，其余字节填成fill
+    auto make_key = [&](int w, int d, int raw_len, char fill) {
+        int raw[2] = {w, d};
+        std::vector<char> key(8);
+        codec.encode((const char *)raw, key.data());
+        memset(key.data() + raw_len, fill, 8 - raw_len);
+        return key;
+    };
+    auto count = [&](const std::vector<char> &lower, bool lower_strict, const std::vector<char> &upper,
+                     bool upper_strict, int w_lo, int w_hi, int d_lo, int d_hi) {
+        int n = 0;
+        for (IxScan scan(ih.get(), lower.data(), lower_strict, upper.data(), upper_strict, buffer_pool_manager.get());
+             !scan.is_end(); scan.next()) {
+            Rid rid = scan.rid();
+            assert(rid.page_no >= w_lo && rid.page_no <= w_hi && rid.slot_no >= d_lo && rid.slot_no <= d_hi);
+            n++;
+        }
+        return n;
+    };
+
+    // w = 3
+    auto lo = make_key(3, 0, 4, 0), hi = make_key(3, 0, 4, (char)0xff);
+    assert(count(lo, false, hi, false, 3, 3, -50, 49) == num_d);
+    // w = 3 and d > 10 and d <= 20
+    lo = make_key(3, 10, 8, 0), hi = make_key(3, 20, 8, 0);
+    assert(count(lo, true, hi, false, 3, 3, 11, 20) == 10);
+    // w > 7
+    lo = make_key(7, 0, 4, (char)0xff), hi = make_key(0, 0, 0, (char)0xff);
+    assert(count(lo, true, hi, false, 8, 9, -50, 49) == 2 * num_d);
+    // w >= 2 and w < 4
+    lo = make_key(2, 0, 4, 0), hi = make_key(4, 0, 4, 0);
+    assert(count(lo, false, hi, true, 2, 3, -50, 49) == 2 * num_d);
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief 按叶结点成批读取的索引扫描：随机的[lower, upper)范围内按key升序输出全部键值对，entry解码出的key正确；
+ * 扫描期间不固定任何页面；起点位于叶结点末尾时从下一个叶结点开始
+ */
+TEST(IndexManagerTest, LeafBatchScanTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(TEST_BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "batch_scan_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "k", .type = TYPE_INT, .len = 4, .offset = 0}};
+    if (ix_manager->exists(filename, index_cols)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    const IxKeyCodec &codec = ih->get_key_codec();
+
+    // 插入[0, 2 * num_keys)中的偶数
+    constexpr int num_keys = 20000;
+    std::vector<int> keys(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        keys[i] = 2 * i;
+    }
+    std::mt19937 rng(39);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (int k : keys) {
+        page_id_t leaf = ih->insert_entry((const char *)&k, Rid{k, -k}, nullptr);
+        assert(leaf != IX_NO_PAGE);
+    }
+
+    auto num_pinned = [&]() {
+        int n = 0;
+        for (size_t i = 0; i < buffer_pool_manager->pool_size_; i++) {
+            n += buffer_pool_manager->pages_[i].pin_count_ > 0;
+        }
+        return n;
+    };
+    auto encode = [&](int k) {
+        std::vector<char> key(4);
+        codec.encode((const char *)&k, key.data());
+        return key;
+    };
+    // 扫描[lower, upper]，检查输出的key从first开始连续递增，返回输出的个数
+    auto check_scan = [&](const char *lower, const char *upper, int first) {
+        int n = 0;
+        IxScan scan(ih.get(), lower, false, upper, false, buffer_pool_manager.get());
+        assert(num_pinned() == 0);
+        for (; !scan.is_end(); scan.next()) {
+            int k;
+            Rid rid = scan.entry((char *)&k);
+            assert(k == first + 2 * n && rid.page_no == k && rid.slot_no == -k);
+            if (n % 500 == 0) {
+                assert(num_pinned() == 0);
+            }
+            n++;
+        }
+        return n;
+    };
+
+    assert(check_scan(nullptr, nullptr, 0) == num_keys);
+    for (int iter = 0; iter < 200; iter++) {
+        int lo = static_cast<int>(rng() % (2 * num_keys + 20)) - 10;
+        int hi = lo + static_cast<int>(rng() % 3000);
+        auto lo_key = encode(lo), hi_key = encode(hi);
+        int first = std::max(0, lo + (lo & 1));
+        int last = std::min(2 * num_keys - 2, hi - (hi & 1));
+        int expected = last >= first ? (last - first) / 2 + 1 : 0;
+        assert(check_scan(lo_key.data(), hi_key.data(), first) == expected);
+    }
+
+    // 起点在第一个叶结点的最后一个key之后
+    IxNodeHandle *first_leaf = ih->fetch_node(ih->leaf_begin().page_no);
+    int first_size = first_leaf->get_size();
+    buffer_pool_manager->unpin_page(first_leaf->get_page_id(), false);
+    delete first_leaf;
+    auto lower = encode(2 * first_size - 1);
+    assert(check_scan(lower.data(), nullptr, 2 * first_size) == num_keys - first_size);
+
+    // 扫描期间插入的奇数key使范围内和上界所在的叶结点分裂，之后再删掉它们使叶结点合并：
+    // 输出仍按key升序、不超过上界，范围内的偶数key一个不漏
+    int upper = num_keys + 1;
+    auto upper_key = encode(upper);
+    int prev = -1, num_even = 0, n = 0;
+    for (IxScan scan(ih.get(), nullptr, false, upper_key.data(), false, buffer_pool_manager.get()); !scan.is_end();
+         scan.next(), n++) {
+        int k;
+        scan.entry((char *)&k);
+        assert(k > prev && k <= upper);
+        prev = k;
+        num_even += k % 2 == 0;
+        if (n == 10) {
+            for (int j = 1; j < upper + 2000; j += 2) {
+                ih->insert_entry((const char *)&j, Rid{j, -j}, nullptr);
+            }
+        } else if (n == 2000) {
+            for (int j = 1; j < upper + 2000; j += 2) {
+                bool deleted = ih->delete_entry((const char *)&j, nullptr);
+                assert(deleted);
+            }
+        }
+    }
+    assert(num_even == num_keys / 2 + 1);
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief 可扩展哈希索引：插入足够多的key使目录跨越多个目录页，重复的key插入失败；删除一部分后关闭再打开，
+ * 从磁盘读回的目录和桶仍能查到剩下的key
+ */
+TEST(IndexManagerTest, HashIndexTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "hash_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "w", .type = TYPE_INT, .len = 4, .offset = 0},
+                                       {.tab_name = filename, .name = "d", .type = TYPE_INT, .len = 4, .offset = 4}};
+    if (ix_manager->exists(filename, index_cols)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_hash_index(filename, index_cols);
+    auto ih = ix_manager->open_hash_index(filename, index_cols);
+
+    constexpr int num_w = 100;
+    constexpr int num_d = 1000;
+    for (int w = 0; w < num_w; w++) {
+        for (int d = 0; d < num_d; d++) {
+            int key[2] = {w, d};
+            bool inserted = ih->insert_entry((const char *)key, Rid{w, d}, nullptr);
+            assert(inserted);
+        }
+    }
+    assert((1 << ih->get_global_depth()) > IX_HASH_DIR_ENTRIES_PER_PAGE);
+    int dup[2] = {7, 7};
+    bool inserted = ih->insert_entry((const char *)dup, Rid{0, 0}, nullptr);
+    assert(!inserted);
+    for (int w = 0; w < num_w; w += 2) {
+        for (int d = 0; d < num_d; d++) {
+            int key[2] = {w, d};
+            bool deleted = ih->delete_entry((const char *)key, nullptr);
+            assert(deleted);
+        }
+    }
+
+    ix_manager->close_hash_index(ih.get());
+    ih = ix_manager->open_hash_index(filename, index_cols);
+    for (int w = 0; w < num_w; w++) {
+        for (int d = 0; d < num_d; d++) {
+            int key[2] = {w, d};
+            std::vector<Rid> result;
+            bool found = ih->get_value((const char *)key, &result, nullptr);
+            assert(found == (w % 2 == 1));
+            assert(!found || (result[0].page_no == w && result[0].slot_no == d));
+        }
+    }
+
+    ix_manager->close_hash_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief ART索引：int key覆盖各种结点大小的增长和收缩，长公共前缀的字符串key覆盖超过结点中存放长度的压缩路径；
+ * 随机插入删除后与std::map的结果逐一对比
+ */
+TEST(IndexManagerTest, ArtIndexTest) {
+    std::mt19937 rng(41);
+
+    IxArtIndex int_index({TYPE_INT}, {4});
+    std::map<int, Rid> int_ref;
+    for (int i = 0; i < 200000; i++) {
+        int key = static_cast<int>(rng() % 100000) - 50000;
+        if (rng() % 3 == 0) {
+            bool deleted = int_index.delete_entry((const char *)&key);
+            bool ref_deleted = int_ref.erase(key) == 1;
+            assert(deleted == ref_deleted);
+        } else {
+            Rid rid{key, i};
+            bool inserted = int_index.insert_entry((const char *)&key, rid);
+            bool ref_inserted = int_ref.emplace(key, rid).second;
+            assert(inserted == ref_inserted);
+        }
+    }
+    assert(int_index.size() == int_ref.size());
+    for (int key = -50000; key < 50000; key++) {
+        std::vector<Rid> result;
+        auto it = int_ref.find(key);
+        bool found = int_index.get_value((const char *)&key, &result);
+        assert(found == (it != int_ref.end()));
+        assert(it == int_ref.end() || result[0] == it->second);
+    }
+
+    constexpr int str_len = 24;
+    IxArtIndex str_index({TYPE_STRING, TYPE_INT}, {str_len, 4});
+    std::map<std::string, Rid> str_ref;
+    auto make_key = [&](int i) {
+        std::string key(str_len + 4, 'p');
+        // key[16, str_len - 1)存放补0的i / 16
+        for (int pos = str_len - 2, n = i / 16; pos >= 16; pos--, n /= 10) {
+            key[pos] = '0' + n % 10;
+        }
+        key[str_len - 1] = 'a' + i % 16;
+        int v = i % 3;
+        memcpy(&key[str_len], &v, sizeof(v));
+        return key;
+    };
+    for (int i = 0; i < 100000; i++) {
+        std::string key = make_key(rng() % 20000);
+        if (rng() % 3 == 0) {
+            bool deleted = str_index.delete_entry(key.data());
+            bool ref_deleted = str_ref.erase(key) == 1;
+            assert(deleted == ref_deleted);
+        } else {
+            Rid rid{i, 0};
+            bool inserted = str_index.insert_entry(key.data(), rid);
+            bool ref_inserted = str_ref.emplace(key, rid).second;
+            assert(inserted == ref_inserted);
+        }
+    }
+    assert(str_index.size() == str_ref.size());
+    for (int i = 0; i < 20000; i++) {
+        std::string key = make_key(i);
+        std::vector<Rid> result;
+        auto it = str_ref.find(key);
+        bool found = str_index.get_value(key.data(), &result);
+        assert(found == (it != str_ref.end()));
+        assert(it == str_ref.end() || result[0] == it->second);
+    }
+    for (auto &entry : str_ref) {
+        bool deleted = str_index.delete_entry(entry.first.data());
+        assert(deleted);
+    }
+    assert(str_index.size() == 0);
+}
+
+/**
+ * @brief Bloom过滤器：批量加载后按key的个数扩大位图，存在的key都能查到，不存在的key大部分被过滤器直接排除；
+ * 逐条插入的key同时写入位图页面，关闭再打开后仍能查到
+ */
+TEST(IndexManagerTest, BloomFilterTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "bloom_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "a", .type = TYPE_INT, .len = 4, .offset = 0}};
+    if (ix_manager->exists(filename, index_cols)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols, true);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    assert(ih->has_bloom() && ih->get_bloom_stats().num_pages == 1);
+
+    // 批量加载偶数key
+    constexpr int num_keys = 100000;
+    std::vector<int> keys;
+    std::vector<Rid> rids;
+    for (int i = 0; i < num_keys; i++) {
+        keys.push_back(2 * i);
+        rids.push_back(Rid{i, i});
+    }
+    ih->bulk_load((const char *)keys.data(), rids.data(), num_keys);
+    IxBloomStats stats = ih->get_bloom_stats();
+    assert(stats.num_pages == (num_keys * IX_BLOOM_BITS_PER_KEY + PAGE_SIZE * 8 - 1) / (PAGE_SIZE * 8));
+    assert(stats.estimated_fpr < 0.02);
+    for (int i = 0; i < num_keys; i++) {
+        std::vector<Rid> result;
+        bool found = ih->get_value((const char *)&keys[i], &result, nullptr);
+        assert(found && result[0].page_no == i);
+    }
+    for (int i = 0; i < num_keys; i++) {
+        int key = 2 * i + 1;
+        std::vector<Rid> result;
+        bool found = ih->get_value((const char *)&key, &result, nullptr);
+        assert(!found);
+    }
+    stats = ih->get_bloom_stats();
+    assert(stats.probes == 2 * num_keys);
+    assert(stats.negatives + stats.false_positives == num_keys);
+    assert(stats.false_positives < num_keys * 0.03);
+
+    // 逐条插入一部分奇数key，关闭再打开后位图从页面读回
+    for (int i = 0; i < num_keys; i += 100) {
+        int key = 2 * i + 1;
+        page_id_t leaf = ih->insert_entry((const char *)&key, Rid{i, -i}, nullptr);
+        assert(leaf != IX_NO_PAGE);
+    }
+    ix_manager->close_index(ih.get());
+    ih = ix_manager->open_index(filename, index_cols);
+    assert(ih->get_bloom_stats().num_pages == stats.num_pages);
+    for (int i = 0; i < num_keys; i++) {
+        int key = 2 * i + 1;
+        std::vector<Rid> result;
+        bool found = ih->get_value((const char *)&key, &result, nullptr);
+        assert(found == (i % 100 == 0));
+        found = ih->get_value((const char *)&keys[i], &result, nullptr);
+        assert(found);
+    }
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief 索引统计信息：批量构建后得到准确的前缀取值个数；随机插入删除时增量维护的键值对数量、叶结点数量和树高
+ * 与扫描整棵树重新计算的结果一致，关闭再打开后从文件头读回
+ */
+TEST(IndexManagerTest, IndexStatsTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "stats_index";
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "a", .type = TYPE_INT, .len = 4, .offset = 0},
+                                       {.tab_name = filename, .name = "b", .type = TYPE_INT, .len = 4, .offset = 4}};
+    if (ix_manager->exists(filename, index_cols)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    IxIndexStats stats = ih->get_stats();
+    assert(stats.num_entries == 0 && stats.num_leaves == 1 && stats.height == 1);
+
+    constexpr int num_a = 100;
+    constexpr int num_b = 1000;
+    std::vector<int> keys;
+    std::vector<Rid> rids;
+    for (int a = 0; a < num_a; a++) {
+        for (int b = 0; b < num_b; b++) {
+            keys.push_back(a);
+            keys.push_back(b);
+            rids.push_back(Rid{a, b});
+        }
+    }
+    ih->bulk_load((const char *)keys.data(), rids.data(), num_a * num_b);
+    stats = ih->get_stats();
+    assert(stats.num_entries == num_a * num_b && stats.height > 1);
+    assert(stats.distinct_prefixes == std::vector<int64_t>({num_a, num_a * num_b}));
+    ih->refresh_stats();
+    IxIndexStats refreshed = ih->get_stats();
+    assert(refreshed.num_leaves == stats.num_leaves && refreshed.height == stats.height);
+    assert(refreshed.distinct_prefixes == stats.distinct_prefixes);
+
+    // 删除a为偶数的一半key，再插入a更大的新key，触发分裂与合并
+    std::mt19937 rng(45);
+    std::vector<int> order(num_a * num_b);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    for (int i : order) {
+        if (keys[2 * i] % 2 == 0) {
+            bool deleted = ih->delete_entry((const char *)&keys[2 * i], nullptr);
+            assert(deleted);
+        }
+    }
+    for (int i : order) {
+        int key[2] = {keys[2 * i] + num_a, keys[2 * i + 1]};
+        if (key[1] % 4 == 0) {
+            page_id_t leaf = ih->insert_entry((const char *)key, Rid{0, i}, nullptr);
+            assert(leaf != IX_NO_PAGE);
+        }
+    }
+    stats = ih->get_stats();
+    int64_t expected = num_a * num_b / 2 + num_a * num_b / 4;
+    assert(stats.num_entries == expected);
+    ih->refresh_stats();
+    refreshed = ih->get_stats();
+    assert(refreshed.num_entries == expected);
+    assert(refreshed.num_leaves == stats.num_leaves && refreshed.height == stats.height);
+    assert(refreshed.distinct_prefixes == std::vector<int64_t>({num_a / 2 + num_a, expected}));
+    assert(refreshed.avg_fill > 0 && refreshed.avg_fill <= 1);
+
+    ix_manager->close_index(ih.get());
+    ih = ix_manager->open_index(filename, index_cols);
+    stats = ih->get_stats();
+    assert(stats.num_entries == refreshed.num_entries && stats.num_leaves == refreshed.num_leaves &&
+           stats.height == refreshed.height && stats.distinct_prefixes == refreshed.distinct_prefixes);
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief 编译后的谓词：各种类型组合、比较符以及右侧为字段或常量时，求值结果必须与按ix_compare比较的结果一致，
+ * INT与FLOAT比较时都转换成FLOAT；下推到RmScan的on_field直接对字段值求值
+ */
+TEST(ExecutionTest, CompiledPredicateTest) {
+    std::string tab = "pred";
+    std::vector<ColMeta> cols = {{.tab_name = tab, .name = "a", .type = TYPE_INT, .len = 4, .offset = 0},
+                                 {.tab_name = tab, .name = "b", .type = TYPE_FLOAT, .len = 4, .offset = 4},
+                                 {.tab_name = tab, .name = "c", .type = TYPE_STRING, .len = 8, .offset = 8},
+                                 {.tab_name = tab, .name = "d", .type = TYPE_DATETIME, .len = 8, .offset = 16},
+                                 {.tab_name = tab, .name = "e", .type = TYPE_INT, .len = 4, .offset = 24}};
+    const int rec_len = 28;
+    auto expect = [](CompOp op, int cmp) {
+        switch (op) {
+            case OP_EQ: return cmp == 0;
+            case OP_NE: return cmp != 0;
+            case OP_LT: return cmp < 0;
+            case OP_GT: return cmp > 0;
+            case OP_LE: return cmp <= 0;
+            default: return cmp >= 0;
+        }
+    };
+    auto col_cond = [&](const std::string &lhs, CompOp op, const std::string &rhs) {
+        Condition cond;
+        cond.lhs_col = {.tab_name = tab, .col_name = lhs};
+        cond.op = op;
+        cond.is_rhs_val = false;
+        cond.rhs_col = {.tab_name = tab, .col_name = rhs};
+        return cond;
+    };
+    auto val_cond = [&](const std::string &lhs, CompOp op, Value val, int len) {
+        Condition cond;
+        cond.lhs_col = {.tab_name = tab, .col_name = lhs};
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val = std::move(val);
+        cond.rhs_val.init_raw(len);
+        return cond;
+    };
+
+    std::mt19937 rng(50);
+    std::vector<char> rec(rec_len);
+    for (int iter = 0; iter < 2000; iter++) {
+        int a = rng() % 20 - 10, e = rng() % 20 - 10;
+        float b = (rng() % 40 - 20) / 2.0f;
+        int64_t d = 20230101000000LL + rng() % 5;
+        char c[8] = {};
+        for (int i = 0; i < 3; i++) {
+            c[i] = 'a' + rng() % 3;
+        }
+        memcpy(rec.data(), &a, 4);
+        memcpy(rec.data() + 4, &b, 4);
+        memcpy(rec.data() + 8, c, 8);
+        memcpy(rec.data() + 16, &d, 8);
+        memcpy(rec.data() + 24, &e, 4);
+
+        int iv = rng() % 20 - 10;
+        float fv = (rng() % 40 - 20) / 2.0f;
+        char sv[8] = {};
+        for (int i = 0; i < 3; i++) {
+            sv[i] = 'a' + rng() % 3;
+        }
+        Value int_val, float_val, str_val, dt_val;
+        int_val.set_int(iv);
+        float_val.set_float(fv);
+        str_val.set_str(sv);
+        dt_val.set_dateTime("2023-01-01 00:00:0" + std::to_string(rng() % 5));
+        int64_t dv = dt_val.datetime_val;
+        float af = a, iv_f = iv;
+        for (CompOp op : {OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE}) {
+            std::vector<std::pair<Condition, int>> cases = {
+                {col_cond("a", op, "e"), ix_compare((char *)&a, (char *)&e, TYPE_INT, 4)},
+                {col_cond("b", op, "a"), ix_compare((char *)&b, (char *)&af, TYPE_FLOAT, 4)},
+                {val_cond("a", op, int_val, 4), ix_compare((char *)&a, (char *)&iv, TYPE_INT, 4)},
+                {val_cond("a", op, float_val, 4), ix_compare((char *)&af, (char *)&fv, TYPE_FLOAT, 4)},
+                {val_cond("b", op, int_val, 4), ix_compare((char *)&b, (char *)&iv_f, TYPE_FLOAT, 4)},
+                {val_cond("c", op, str_val, 8), ix_compare(c, sv, TYPE_STRING, 8)},
+                {val_cond("d", op, dt_val, 8), ix_compare((char *)&d, (char *)&dv, TYPE_DATETIME, 8)},
+            };
+            for (auto &[cond, cmp] : cases) {
+                CompiledPredicate pred = CompiledPredicate::compile(cols, cond);
+                assert(pred.eval(rec.data()) == expect(op, cmp));
+                if (pred.rhs_is_val()) {
+                    assert(pred.on_field().eval(rec.data() + pred.lhs_offset()) == expect(op, cmp));
+                }
+            }
+            std::vector<Condition> conds = {cases[0].first, cases[5].first};
+            PredicateList preds(cols, conds);
+            assert(preds.eval(rec.data()) == (expect(op, cases[0].second) && expect(op, cases[5].second)));
+        }
+    }
+
+    Condition bad = col_cond("a", OP_EQ, "c");
+    bool thrown = false;
+    try {
+        CompiledPredicate::compile(cols, bad);
+    } catch (IncompatibleTypeError &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+/**
+ * @brief 执行层的测试基类：每个测试在新建的数据库TEST_EXEC_DB_NAME中进行，结束时关闭并删除数据库；
+ * 提供按表扫描全部记录、以及检查表上每个索引与堆表是否一致的辅助函数
+ */
+class ExecutorTest : public ::testing::Test {
+   public:
+    const std::string TEST_EXEC_DB_NAME = "ExecutorTest_db";
+    static constexpr int EXEC_BUFFER_LENGTH = 8192;
+
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> bpm_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Analyze> analyze_;
+    std::unique_ptr<Planner> planner_;
+    std::unique_ptr<Optimizer> optimizer_;
+    std::unique_ptr<Portal> portal_;
+    std::unique_ptr<Context> context_;
+    char data_send_[EXEC_BUFFER_LENGTH];
+    int offset_ = 0;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        bpm_ = std::make_unique<BufferPoolManager>(TEST_BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), bpm_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), bpm_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), bpm_.get(), rm_manager_.get(), ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        analyze_ = std::make_unique<Analyze>(sm_manager_.get());
+        planner_ = std::make_unique<Planner>(sm_manager_.get());
+        optimizer_ = std::make_unique<Optimizer>(sm_manager_.get(), planner_.get());
+        portal_ = std::make_unique<Portal>(sm_manager_.get());
+        if (sm_manager_->is_dir(TEST_EXEC_DB_NAME)) {
+            sm_manager_->drop_db(TEST_EXEC_DB_NAME);
+        }
+        sm_manager_->create_db(TEST_EXEC_DB_NAME);
+        sm_manager_->open_db(TEST_EXEC_DB_NAME);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, nullptr, data_send_, &offset_);
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+        sm_manager_->drop_db(TEST_EXEC_DB_NAME);
+    }
+
+    /* 清空发送给客户端的缓冲区，返回清空前的内容 */
+    std::string take_output() {
+        std::string out(data_send_, offset_);
+        offset_ = 0;
+        return out;
+    }
+
+    /* 按物理顺序扫描表中的所有记录 */
+    std::vector<std::pair<Rid, std::vector<char>>> scan_table(const std::string &tab_name) {
+        RmFileHandle *fh = sm_manager_->fhs_.at(tab_name).get();
+        int record_size = fh->get_file_hdr().record_size;
+        std::vector<std::pair<Rid, std::vector<char>>> records;
+        for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+            auto rec = fh->get_record(scan.rid(), nullptr);
+            records.emplace_back(scan.rid(), std::vector<char>(rec->data, rec->data + record_size));
+        }
+        return records;
+    }
+
+    /* 表中的每条记录都能通过每个索引按key找到自己的rid，B+树索引的键值对个数与记录条数相同 */
+    void check_indexes(const std::string &tab_name) {
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+        auto records = scan_table(tab_name);
+        for (auto &index : tab.indexes) {
+            std::vector<char> key(index.col_tot_len);
+            for (auto &[rid, rec] : records) {
+                SmManager::get_index_key(index, rec.data(), key.data());
+                std::vector<Rid> found;
+                bool exists = sm_manager_->get_index_value(index, key.data(), &found, nullptr);
+                assert(exists);
+                assert(std::find(found.begin(), found.end(), rid) != found.end());
+            }
+            if (index.type == INDEX_BTREE) {
+                auto ih = sm_manager_->ihs_.at(ix_manager_->get_index_name(tab_name, index.cols)).get();
+                assert(ih->get_stats().num_entries == (int64_t)records.size());
+            }
+        }
+    }
+
+    static void write_file(const std::string &file_name, const std::string &content) {
+        std::ofstream ofs(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+        ofs << content;
+    }
+
+    /* 建表并导入rows，每个元素是CSV中的一行 */
+    void create_table(const std::string &tab_name, const std::vector<ColDef> &col_defs,
+                      const std::vector<std::string> &rows) {
+        sm_manager_->create_table(tab_name, col_defs, "", context_.get());
+        load_rows(tab_name, rows);
+    }
+
+    void load_rows(const std::string &tab_name, const std::vector<std::string> &rows) {
+        std::string csv;
+        for (auto &row : rows) {
+            csv += row + "\n";
+        }
+        write_file(tab_name + ".csv", csv);
+        sm_manager_->load_data(tab_name + ".csv", tab_name, context_.get());
+        take_output();
+    }
+
+    /* 条件tab_name.col op val，val按字段的类型和长度初始化 */
+    Condition val_cond(const std::string &tab_name, const std::string &col_name, CompOp op, Value val) {
+        Condition cond;
+        cond.lhs_col = {.tab_name = tab_name, .col_name = col_name};
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val = std::move(val);
+        cond.rhs_val.init_raw(sm_manager_->db_.get_table(tab_name).get_col(col_name)->len);
+        return cond;
+    }
+
+    Condition int_cond(const std::string &tab_name, const std::string &col_name, CompOp op, int int_val) {
+        Value val;
+        val.set_int(int_val);
+        return val_cond(tab_name, col_name, op, std::move(val));
+    }
+
+    static Condition col_cond(const TabCol &lhs, CompOp op, const TabCol &rhs) {
+        Condition cond;
+        cond.lhs_col = lhs;
+        cond.op = op;
+        cond.is_rhs_val = false;
+        cond.rhs_col = rhs;
+        return cond;
+    }
+
+    /* set tab_name.col_name = int_val */
+    static SetClause int_set(const std::string &tab_name, const std::string &col_name, int int_val) {
+        SetClause set_clause;
+        set_clause.lhs = {.tab_name = tab_name, .col_name = col_name};
+        set_clause.rhs.set_int(int_val);
+        set_clause.flag = false;
+        return set_clause;
+    }
+
+    /* 满足conds的记录的rid，按物理顺序排列 */
+    std::vector<Rid> matching_rids(const std::string &tab_name, const std::vector<Condition> &conds) {
+        std::vector<Rid> rids;
+        SeqScanExecutor scan(sm_manager_.get(), tab_name, conds, context_.get());
+        for (scan.beginTuple(); !scan.is_end(); scan.nextTuple()) {
+            rids.push_back(scan.rid());
+        }
+        return rids;
+    }
+
+    void update_rows(const std::string &tab_name, const std::vector<SetClause> &set_clauses,
+                     const std::vector<Condition> &conds) {
+        UpdateExecutor update(sm_manager_.get(), tab_name, set_clauses, conds, matching_rids(tab_name, conds),
+                              context_.get());
+        update.Next();
+    }
+
+    void delete_rows(const std::string &tab_name, const std::vector<Condition> &conds) {
+        DeleteExecutor del(sm_manager_.get(), tab_name, conds, matching_rids(tab_name, conds), context_.get());
+        del.Next();
+    }
+
+    /* 按元组接口取出算子的全部输出，排序后返回，用于与其他算子的输出按多重集比较 */
+    static std::vector<std::string> collect(AbstractExecutor &exec) {
+        std::vector<std::string> rows;
+        for (exec.beginTuple(); !exec.is_end(); exec.nextTuple()) {
+            auto rec = exec.Next();
+            rows.emplace_back(rec->data, rec->size);
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    /* 按批接口取出算子的全部输出，排序后返回 */
+    static std::vector<std::string> collect_batches(AbstractExecutor &exec) {
+        std::vector<std::string> rows;
+        TupleBatch batch;
+        exec.beginBatch();
+        while (exec.NextBatch(batch)) {
+            for (size_t k = 0; k < batch.num_sel; k++) {
+                rows.emplace_back(batch.selected(k), batch.tuple_len);
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    /* 解析、分析并优化一条SQL语句 */
+    std::shared_ptr<Plan> plan_sql(const std::string &sql) {
+        YY_BUFFER_STATE buf = yy_scan_string(sql.c_str());
+        int res = yyparse();
+        yy_delete_buffer(buf);
+        assert(res == 0 && ast::parse_tree != nullptr);
+        std::shared_ptr<Query> query = analyze_->do_analyze(ast::parse_tree);
+        ast::parse_tree.reset();
+        return optimizer_->plan_query(query, context_.get());
+    }
+
+    /* 执行一条select语句，返回排序后的输出元组，plan不为空时传出执行计划 */
+    std::vector<std::string> run_select(const std::string &sql, std::shared_ptr<Plan> *plan = nullptr) {
+        std::shared_ptr<Plan> select_plan = plan_sql(sql);
+        auto stmt = portal_->start(select_plan, context_.get());
+        auto rows = collect_batches(*stmt->root);
+        if (plan != nullptr) {
+            *plan = select_plan;
+        }
+        return rows;
+    }
+
+    /* 执行计划中扫描tab_name的结点 */
+    static std::shared_ptr<ScanPlan> find_scan(const std::shared_ptr<Plan> &plan, const std::string &tab_name) {
+        if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+            return x->tab_name_ == tab_name ? x : nullptr;
+        }
+        if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+            auto scan = find_scan(x->left_, tab_name);
+            return scan != nullptr ? scan : find_scan(x->right_, tab_name);
+        }
+        if (auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)) {
+            return find_scan(x->subplan_, tab_name);
+        }
+        if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
+            return find_scan(x->subplan_, tab_name);
+        }
+        if (auto x = std::dynamic_pointer_cast<DMLPlan>(plan)) {
+            return find_scan(x->subplan_, tab_name);
+        }
+        return nullptr;
+    }
+
+    /* 导入content时必须抛出Error，并且表中仍然只有num_records条记录 */
+    template <typename Error>
+    void expect_load_error(const std::string &tab_name, const std::string &content, size_t num_records) {
+        write_file("bad.csv", content);
+        bool thrown = false;
+        try {
+            sm_manager_->load_data("bad.csv", tab_name, context_.get());
+        } catch (Error &) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(scan_table(tab_name).size() == num_records);
+    }
+};
+
+/**
+ * @brief CSV批量导入：表头跳过、\r\n与空行、INT/FLOAT/CHAR/DATETIME的解析；各种格式错误的行以及违反唯一约束的文件
+ * 整体报错、不写入任何记录；导入后每个索引（B+树、哈希、ART）都与堆表一致，导入速度通过context输出给客户端
+ */
+TEST_F(ExecutorTest, LoadDataTest) {
+    std::vector<ColDef> col_defs = {{.name = "id", .type = TYPE_INT, .len = 4},
+                                    {.name = "score", .type = TYPE_FLOAT, .len = 4},
+                                    {.name = "name", .type = TYPE_STRING, .len = 8},
+                                    {.name = "ts", .type = TYPE_DATETIME, .len = 8}};
+    sm_manager_->create_table("t", col_defs, "", context_.get());
+    sm_manager_->create_index("t", {"id"}, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_BTREE, true);
+    sm_manager_->create_index("t", {"name"}, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_HASH, true);
+    sm_manager_->create_index("t", {"ts"}, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_ART, true);
+    sm_manager_->create_index("t", {"score", "id"}, context_.get());
+    // 哈希和ART索引中每个key只保存一个rid，不能建立非唯一的哈希或ART索引
+    for (IndexType type : {INDEX_HASH, INDEX_ART}) {
+        bool thrown = false;
+        try {
+            sm_manager_->create_index("t", {"score"}, context_.get(), IX_DEFAULT_FILL_FACTOR, type);
+        } catch (InvalidIndexError &) {
+            thrown = true;
+        }
+        assert(thrown && !sm_manager_->db_.get_table("t").is_index({"score"}));
+    }
+
+    const int num_rows = 3000;
+    std::string csv = "id,score,name,ts\n";
+    for (int i = 0; i < num_rows; i++) {
+        char line[64];
+        snprintf(line, sizeof(line), "%d,%d.5,n%d,2023-05-%02d %02d:%02d:%02d", num_rows - i, i % 100, i,
+                 1 + i % 28, i % 24, i % 60, i / 60 % 60);
+        csv += line;
+        csv += (i % 2 == 0) ? "\r\n" : "\n";
+        if (i % 500 == 0) {
+            csv += "\n";
+        }
+    }
+    write_file("t.csv", csv);
+    take_output();
+    sm_manager_->load_data("t.csv", "t", context_.get());
+    std::string out = take_output();
+    assert(out.find("Rows/s") != std::string::npos);
+    assert(out.find(std::to_string(num_rows)) != std::string::npos);
+
+    TabMeta &tab = sm_manager_->db_.get_table("t");
+    auto records = scan_table("t");
+    assert((int)records.size() == num_rows);
+    std::set<int> ids;
+    for (auto &[rid, rec] : records) {
+        int id = *(int *)(rec.data() + tab.get_col("id")->offset);
+        int i = num_rows - id;
+        assert(i >= 0 && i < num_rows);
+        ids.insert(id);
+        assert(*(float *)(rec.data() + tab.get_col("score")->offset) == i % 100 + 0.5f);
+        std::string name = "n" + std::to_string(i);
+        char expected_name[8] = {};
+        memcpy(expected_name, name.data(), name.size());
+        assert(memcmp(rec.data() + tab.get_col("name")->offset, expected_name, 8) == 0);
+        char ts[32];
+        snprintf(ts, sizeof(ts), "2023-05-%02d %02d:%02d:%02d", 1 + i % 28, i % 24, i % 60, i / 60 % 60);
+        Value ts_val;
+        ts_val.set_dateTime(ts);
+        assert(*(int64_t *)(rec.data() + tab.get_col("ts")->offset) == ts_val.datetime_val);
+    }
+    assert((int)ids.size() == num_rows);
+    check_indexes("t");
+
+    // 格式错误的行：出错时整个文件都不导入
+    std::string good_row = "100000,1.5,ok,2023-01-01 00:00:00\n";
+    expect_load_error<InvalidValueCountError>("t", good_row + "100001,1.5,ok\n", num_rows);
+    expect_load_error<InvalidValueCountError>("t", good_row + "100001,1.5,ok,2023-01-01 00:00:00,9\n", num_rows);
+    expect_load_error<IncompatibleTypeError>("t", good_row + "abc,1.5,ok,2023-01-01 00:00:00\n", num_rows);
+    expect_load_error<IncompatibleTypeError>("t", good_row + "100001,x1,ok,2023-01-01 00:00:00\n", num_rows);
+    expect_load_error<StringOverflowError>("t", good_row + "100001,1.5,too_long_name,2023-01-01 00:00:00\n", num_rows);
+    expect_load_error<DateTimeAbsurdError>("t", good_row + "100001,1.5,ok,2023/01/01 00:00:00\n", num_rows);
+    expect_load_error<UniqueConstraintError>("t", good_row + "1,1.5,dup,2023-01-01 00:00:00\n", num_rows);
+    check_indexes("t");
+
+    // 没有表头的文件也能导入，导入到已有数据的表时索引逐条插入
+    write_file("more.csv", "100000,1.5,more,2023-01-01 00:00:00\n100001,2.5,more2,2023-01-02 00:00:00");
+    sm_manager_->load_data("more.csv", "t", context_.get());
+    assert((int)scan_table("t").size() == num_rows + 2);
+    check_indexes("t");
+}
+
+/**
+ * @brief 交换队列：多个生产者并发放入的数据全部被取出，所有生产者结束后pop返回false；
+ * 队列满时阻塞的生产者在消费者close()后被唤醒并得到false
+ */
+TEST(ExecutionTest, ExchangeQueueTest) {
+    ExchangeQueue<int> queue(4);
+    const int num_producers = 4;
+    const int num_items = 10000;
+    queue.reset(num_producers);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; p++) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < num_items; i++) {
+                bool pushed = queue.push(p * num_items + i);
+                assert(pushed);
+            }
+            queue.producer_done();
+        });
+    }
+    std::vector<int> items;
+    int item;
+    while (queue.pop(&item)) {
+        items.push_back(item);
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    std::sort(items.begin(), items.end());
+    std::vector<int> expected(num_producers * num_items);
+    std::iota(expected.begin(), expected.end(), 0);
+    assert(items == expected);
+
+    // 消费者只取走一项就关闭队列，阻塞在push上的生产者必须退出
+    queue.reset(num_producers);
+    std::atomic<int> num_rejected{0};
+    producers.clear();
+    for (int p = 0; p < num_producers; p++) {
+        producers.emplace_back([&]() {
+            while (queue.push(0)) {
+            }
+            num_rejected++;
+            queue.producer_done();
+        });
+    }
+    bool popped = queue.pop(&item);
+    assert(popped);
+    queue.close();
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    assert(num_rejected == num_producers);
+    popped = queue.pop(&item);
+    assert(!popped);
+}
+
+/**
+ * @brief 并行顺序扫描：不同工作线程个数、不同条件下，元组接口和批接口输出的多重集都与SeqScanExecutor相同；
+ * 只取出一部分结果后重新开始或直接销毁算子时，工作线程都能退出；工作线程抛出的异常在上层线程重新抛出
+ */
+TEST_F(ExecutorTest, ParallelSeqScanTest) {
+    const int num_rows = 40000;
+    std::vector<std::string> rows;
+    std::mt19937 rng(30);
+    for (int i = 0; i < num_rows; i++) {
+        rows.push_back(std::to_string(i) + "," + std::to_string(rng() % num_rows) + ",s" + std::to_string(i % 97));
+    }
+    create_table("p",
+                 {{.name = "a", .type = TYPE_INT, .len = 4},
+                  {.name = "b", .type = TYPE_INT, .len = 4},
+                  {.name = "c", .type = TYPE_STRING, .len = 8}},
+                 rows);
+    assert(sm_manager_->fhs_.at("p")->get_file_hdr().num_pages > 64 * 2);
+
+    std::vector<std::vector<Condition>> cond_sets = {
+        {},
+        {int_cond("p", "a", OP_LT, num_rows / 3)},
+        {col_cond({"p", "a"}, OP_GT, {"p", "b"})},
+        {int_cond("p", "a", OP_GE, num_rows / 2), col_cond({"p", "a"}, OP_LE, {"p", "b"})},
+        {int_cond("p", "a", OP_LT, 0)},
+    };
+    for (auto &conds : cond_sets) {
+        SeqScanExecutor seq_scan(sm_manager_.get(), "p", conds, context_.get());
+        auto expected = collect(seq_scan);
+        for (size_t num_workers : {1, 4}) {
+            ParallelSeqScanExecutor scan(sm_manager_.get(), "p", conds, context_.get(), num_workers);
+            assert(collect(scan) == expected);
+            assert(collect_batches(scan) == expected);
+        }
+    }
+
+    // LIMIT式的提前结束：只取出一部分结果，之后重新开始扫描或直接销毁算子
+    std::vector<Condition> no_conds;
+    SeqScanExecutor seq_scan(sm_manager_.get(), "p", no_conds, context_.get());
+    auto expected = collect(seq_scan);
+    for (int iter = 0; iter < 10; iter++) {
+        auto scan = std::make_unique<ParallelSeqScanExecutor>(sm_manager_.get(), "p", no_conds, context_.get(), 4);
+        scan->beginTuple();
+        for (int i = 0; i < 10 && !scan->is_end(); i++) {
+            scan->nextTuple();
+        }
+        if (iter % 2 == 0) {
+            assert(collect(*scan) == expected);
+        }
+        scan.reset();
+    }
+
+    // 工作线程读到不存在的页面时抛出异常，上层线程在取完其他线程的结果后重新抛出
+    RmFileHandle *fh = sm_manager_->fhs_.at("p").get();
+    int num_pages = fh->file_hdr_.num_pages;
+    fh->file_hdr_.num_pages = num_pages + 64 * 8;
+    ParallelSeqScanExecutor scan(sm_manager_.get(), "p", no_conds, context_.get(), 4);
+    bool thrown = false;
+    try {
+        collect(scan);
+    } catch (InternalError &) {
+        thrown = true;
+    }
+    fh->file_hdr_.num_pages = num_pages;
+    assert(thrown);
+    assert(collect(scan) == expected);
+}
+
+/**
+ * @brief 并行顺序扫描的性能对比，默认不运行：--gtest_also_run_disabled_tests --gtest_filter=*ParallelSeqScanBench*
+ */
+TEST_F(ExecutorTest, DISABLED_ParallelSeqScanBench) {
+    const int num_rows = 2000000;
+    std::vector<std::string> rows;
+    rows.reserve(num_rows);
+    std::mt19937 rng(30);
+    for (int i = 0; i < num_rows; i++) {
+        rows.push_back(std::to_string(i) + "," + std::to_string(rng() % num_rows) + ",s" + std::to_string(i % 97));
+    }
+    create_table("p",
+                 {{.name = "a", .type = TYPE_INT, .len = 4},
+                  {.name = "b", .type = TYPE_INT, .len = 4},
+                  {.name = "c", .type = TYPE_STRING, .len = 8}},
+                 rows);
+    std::vector<Condition> conds = {col_cond({"p", "a"}, OP_GT, {"p", "b"})};
+    size_t max_workers = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t num_workers = 0; num_workers <= max_workers; num_workers = std::max<size_t>(1, num_workers * 2)) {
+        std::unique_ptr<AbstractExecutor> scan;
+        if (num_workers == 0) {
+            scan = std::make_unique<SeqScanExecutor>(sm_manager_.get(), "p", conds, context_.get());
+        } else {
+            scan = std::make_unique<ParallelSeqScanExecutor>(sm_manager_.get(), "p", conds, context_.get(), num_workers);
+        }
+        auto start = std::chrono::steady_clock::now();
+        size_t num_out = 0;
+        for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
+            num_out += scan->Next() != nullptr;
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "workers=" << num_workers << " rows=" << num_out << " time=" << elapsed.count() << "ms\n";
+    }
+}
+
+/* 暴露IndexScanExecutor推导出的上下界，用于检查build_range选出的条件 */
+class IndexScanProbe : public IndexScanExecutor {
+   public:
+    using IndexScanExecutor::IndexScanExecutor;
+    using IndexScanExecutor::fed_conds_;
+    using IndexScanExecutor::is_empty_range_;
+    using IndexScanExecutor::lower_key_;
+    using IndexScanExecutor::lower_strict_;
+    using IndexScanExecutor::upper_key_;
+    using IndexScanExecutor::upper_strict_;
+
+    /* 上界或下界中第col_idx个索引字段的值 */
+    int bound(bool lower, int col_idx) const {
+        std::vector<char> raw(index_meta_.col_tot_len);
+        ih_->get_key_codec().decode(lower ? lower_key_.data() : upper_key_.data(), raw.data());
+        return *(int *)(raw.data() + col_idx * sizeof(int));
+    }
+};
+
+/**
+ * @brief 索引范围扫描推导上下界：同一字段上混合的>、>=、<、<=取最紧的一对，相等时取严格的；
+ * 等值前缀之后的严格范围依靠0x00/0xff填充跳过相等的前缀；互相矛盾的条件得到空范围；
+ * 没有用于上下界的条件仍在取出记录后检查。随机条件组合下元组接口和批接口的结果都与顺序扫描相同
+ */
+TEST_F(ExecutorTest, IndexRangeScanTest) {
+    const int num_a = 40, num_b = 100;
+    std::vector<std::string> rows;
+    std::vector<int> ids(num_a * num_b);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::mt19937 rng(37);
+    std::shuffle(ids.begin(), ids.end(), rng);
+    for (int a = 0; a < num_a; a++) {
+        for (int b = 0; b < num_b; b++) {
+            rows.push_back(std::to_string(a) + "," + std::to_string(b) + "," + std::to_string(ids[a * num_b + b]));
+        }
+    }
+    std::shuffle(rows.begin(), rows.end(), rng);
+    create_table("r",
+                 {{.name = "a", .type = TYPE_INT, .len = 4},
+                  {.name = "b", .type = TYPE_INT, .len = 4},
+                  {.name = "c", .type = TYPE_INT, .len = 4}},
+                 rows);
+    std::vector<std::string> index_cols = {"a", "b", "c"};
+    sm_manager_->create_index("r", index_cols, context_.get());
+
+    auto check = [&](const std::vector<Condition> &conds) {
+        SeqScanExecutor seq_scan(sm_manager_.get(), "r", conds, context_.get());
+        auto expected = collect(seq_scan);
+        IndexScanExecutor index_scan(sm_manager_.get(), "r", conds, index_cols, context_.get());
+        assert(collect(index_scan) == expected);
+        assert(collect_batches(index_scan) == expected);
+        return expected.size();
+    };
+
+    // 同一字段上的多个范围条件取最紧的
+    {
+        std::vector<Condition> conds = {int_cond("r", "a", OP_GT, 3),  int_cond("r", "a", OP_GE, 5),
+                                        int_cond("r", "a", OP_GE, 4),  int_cond("r", "a", OP_LT, 15),
+                                        int_cond("r", "a", OP_LE, 12), int_cond("r", "a", OP_LT, 12)};
+        IndexScanProbe probe(sm_manager_.get(), "r", conds, index_cols, context_.get());
+        assert(probe.bound(true, 0) == 5 && !probe.lower_strict_);
+        assert(probe.bound(false, 0) == 12 && probe.upper_strict_);
+        assert(probe.fed_conds_.size() == conds.size() - 2);
+        assert(check(conds) == 7 * num_b);
+    }
+    {
+        std::vector<Condition> conds = {int_cond("r", "a", OP_GE, 5), int_cond("r", "a", OP_GT, 5),
+                                        int_cond("r", "a", OP_LE, 9), int_cond("r", "a", OP_LT, 9)};
+        IndexScanProbe probe(sm_manager_.get(), "r", conds, index_cols, context_.get());
+        assert(probe.bound(true, 0) == 5 && probe.lower_strict_);
+        assert(probe.bound(false, 0) == 9 && probe.upper_strict_);
+        assert(check(conds) == 3 * num_b);
+    }
+
+    // 等值前缀之后的严格范围：下界之后填0xff、上界之后填0x00，跳过与边界相等的整段前缀
+    {
+        std::vector<Condition> conds = {int_cond("r", "a", OP_EQ, 7), int_cond("r", "b", OP_GT, 10),
+                                        int_cond("r", "b", OP_LT, 20)};
+        IndexScanProbe probe(sm_manager_.get(), "r", conds, index_cols, context_.get());
+        assert(probe.bound(true, 0) == 7 && probe.bound(true, 1) == 10 && probe.lower_strict_);
+        assert(probe.bound(false, 0) == 7 && probe.bound(false, 1) == 20 && probe.upper_strict_);
+        int key_len = probe.lower_key_.size();
+        assert(std::all_of(probe.lower_key_.begin() + 8, probe.lower_key_.begin() + key_len,
+                           [](char c) { return (unsigned char)c == 0xff; }));
+        assert(std::all_of(probe.upper_key_.begin() + 8, probe.upper_key_.begin() + key_len,
+                           [](char c) { return c == 0; }));
+        assert(probe.fed_conds_.empty());
+        assert(check(conds) == 9);
+    }
+    assert(check({int_cond("r", "a", OP_EQ, 7), int_cond("r", "b", OP_GE, 10), int_cond("r", "b", OP_LE, 20)}) == 11);
+    assert(check({int_cond("r", "a", OP_GT, 38)}) == num_b);
+    assert(check({int_cond("r", "a", OP_LT, 1)}) == num_b);
+    assert(check({int_cond("r", "a", OP_EQ, 0), int_cond("r", "b", OP_EQ, 0)}) == 1);
+
+    // 互相矛盾的条件
+    for (auto &conds : std::vector<std::vector<Condition>>{
+             {int_cond("r", "a", OP_GT, 10), int_cond("r", "a", OP_LT, 5)},
+             {int_cond("r", "a", OP_GT, 10), int_cond("r", "a", OP_LE, 10)},
+             {int_cond("r", "a", OP_GE, 10), int_cond("r", "a", OP_LT, 10)},
+             {int_cond("r", "a", OP_EQ, 3), int_cond("r", "b", OP_GT, 50), int_cond("r", "b", OP_LT, 50)},
+         }) {
+        IndexScanProbe probe(sm_manager_.get(), "r", conds, index_cols, context_.get());
+        assert(probe.is_empty_range_);
+        assert(check(conds) == 0);
+    }
+    {
+        std::vector<Condition> conds = {int_cond("r", "a", OP_GE, 10), int_cond("r", "a", OP_LE, 10)};
+        IndexScanProbe probe(sm_manager_.get(), "r", conds, index_cols, context_.get());
+        assert(!probe.is_empty_range_);
+        assert(check(conds) == num_b);
+    }
+
+    // 不能用于上下界的条件在取出记录后检查：!=、第二个等值条件、范围之后的字段、字段之间的比较
+    {
+        std::vector<Condition> conds = {int_cond("r", "a", OP_GE, 30), int_cond("r", "a", OP_NE, 31),
+                                        int_cond("r", "b", OP_LT, 10), int_cond("r", "c", OP_GT, 1000),
+                                        col_cond({"r", "b"}, OP_LT, {"r", "a"})};
+        IndexScanProbe probe(sm_manager_.get(), "r", conds, index_cols, context_.get());
+        assert(probe.fed_conds_.size() == conds.size() - 1);
+        check(conds);
+    }
+    assert(check({int_cond("r", "a", OP_EQ, 3), int_cond("r", "a", OP_EQ, 4)}) == 0);
+
+    // 随机的条件组合
+    std::vector<std::pair<std::string, int>> col_ranges = {{"a", num_a}, {"b", num_b}, {"c", num_a * num_b}};
+    std::vector<CompOp> ops = {OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE};
+    for (int iter = 0; iter < 150; iter++) {
+        std::vector<Condition> conds;
+        int num_conds = 1 + rng() % 4;
+        for (int i = 0; i < num_conds; i++) {
+            auto &[col, range] = col_ranges[rng() % (iter % 3 == 0 ? 3 : 2)];
+            int val = static_cast<int>(rng() % (range + 4)) - 2;
+            conds.push_back(int_cond("r", col, ops[rng() % ops.size()], val));
+        }
+        check(conds);
+    }
+}
+
+/**
+ * @brief 只访问索引的扫描：查询用到的字段都在索引中时计划使用IndexOnlyScan，输出与没有索引的同一份数据的顺序扫描相同，
+ * 执行期间不读取数据文件；用到索引之外的字段时仍使用IndexScan。索引字段包含负数、浮点数和字符串，检查key的解码
+ */
+TEST_F(ExecutorTest, IndexOnlyScanTest) {
+    std::vector<ColDef> col_defs = {{.name = "s", .type = TYPE_STRING, .len = 6},
+                                    {.name = "a", .type = TYPE_INT, .len = 4},
+                                    {.name = "b", .type = TYPE_FLOAT, .len = 4},
+                                    {.name = "x", .type = TYPE_INT, .len = 4}};
+    std::vector<std::string> rows;
+    for (int i = 0; i < 3000; i++) {
+        char row[64];
+        snprintf(row, sizeof(row), "k%d,%d,%d.25,%d", i % 10, i - 1500, i % 37 - 18, i * 7);
+        rows.push_back(row);
+    }
+    create_table("o", col_defs, rows);
+    create_table("o_seq", col_defs, rows);
+    sm_manager_->create_index("o", {"s", "a", "b"}, context_.get());
+
+    RmFileHandle *fh = sm_manager_->fhs_.at("o").get();
+    auto check = [&](const std::string &select, const std::string &where, PlanTag expected_tag) {
+        std::shared_ptr<Plan> plan;
+        auto expected = run_select("select " + select + " from o_seq " + where + ";", &plan);
+        assert(find_scan(plan, "o_seq")->tag == T_SeqScan);
+        auto index_plan = plan_sql("select " + select + " from o " + where + ";");
+        assert(find_scan(index_plan, "o")->tag == expected_tag);
+        // 只访问索引时把数据文件的页面数改成只有文件头，读取任何记录都会出错
+        int num_pages = fh->file_hdr_.num_pages;
+        if (expected_tag == T_IndexOnlyScan) {
+            fh->file_hdr_.num_pages = RM_FIRST_RECORD_PAGE;
+        }
+        auto stmt = portal_->start(index_plan, context_.get());
+        auto result = collect_batches(*stmt->root);
+        fh->file_hdr_.num_pages = num_pages;
+        assert(result == expected);
+        return result.size();
+    };
+
+    assert(check("s, a, b", "where s = 'k3'", T_IndexOnlyScan) == 300);
+    assert(check("a", "where s = 'k5' and a < 0 and b > 1.5", T_IndexOnlyScan) > 0);
+    assert(check("b, s", "where s >= 'k1' and s <= 'k4' and a <> 2", T_IndexOnlyScan) == 1199);
+    assert(check("*", "where s = 'k3' and a > 100", T_IndexScan) > 0);
+    assert(check("x", "where s = 'k3'", T_IndexScan) == 300);
+    assert(check("s, a", "where s = 'k3' and x > 1000", T_IndexScan) > 0);
+    check("a, b", "where s > 'k8' and b < -10.0", T_IndexOnlyScan);
+    check("s", "where s = 'k9' and a = -1491", T_IndexOnlyScan);
+}
+
+/**
+ * @brief 选择B+树索引：等值前缀更长的优先，其次是等值前缀之后还有范围条件的，再按统计信息估计的匹配行数和字段个数选择；
+ * 每个字段都有等值条件时优先使用哈希索引，但不能比B+树的等值前缀短。检查计划选出的索引，并与没有索引的同一份数据比较结果
+ */
+TEST_F(ExecutorTest, IndexSelectionTest) {
+    std::vector<ColDef> col_defs = {{.name = "a", .type = TYPE_INT, .len = 4},
+                                    {.name = "b", .type = TYPE_INT, .len = 4},
+                                    {.name = "c", .type = TYPE_INT, .len = 4},
+                                    {.name = "d", .type = TYPE_INT, .len = 4},
+                                    {.name = "e", .type = TYPE_INT, .len = 4}};
+    std::vector<std::string> rows;
+    for (int i = 0; i < 5000; i++) {
+        rows.push_back(std::to_string(i % 10) + "," + std::to_string(i % 100) + "," + std::to_string(i % 1000) + "," +
+                       std::to_string(i) + "," + std::to_string(i % 7));
+    }
+    create_table("g", col_defs, rows);
+    create_table("g_seq", col_defs, rows);
+    sm_manager_->create_index("g", {"a", "d"}, context_.get());
+    sm_manager_->create_index("g", {"a", "b", "d"}, context_.get());
+    sm_manager_->create_index("g", {"b", "c", "d"}, context_.get());
+    sm_manager_->create_index("g", {"c", "d"}, context_.get());
+    sm_manager_->create_index("g", {"d"}, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_HASH, true);
+
+    auto check = [&](const std::string &where, PlanTag expected_tag, const std::vector<std::string> &expected_cols) {
+        auto expected = run_select("select * from g_seq where " + where + ";");
+        std::shared_ptr<Plan> plan;
+        auto result = run_select("select * from g where " + where + ";", &plan);
+        auto scan = find_scan(plan, "g");
+        assert(scan->tag == expected_tag);
+        assert(scan->index_col_names_ == expected_cols);
+        assert(result == expected);
+    };
+
+    // 等值前缀更长的优先
+    check("a = 1 and b = 2", T_IndexScan, {"a", "b", "d"});
+    check("a = 2 and b = 12 and e = 5", T_IndexScan, {"a", "b", "d"});
+    check("a > 3 and b = 2", T_IndexScan, {"b", "c", "d"});
+    // 等值前缀相同时，之后还有范围条件的优先
+    check("a = 1 and b > 50", T_IndexScan, {"a", "b", "d"});
+    check("a = 1 and d > 100", T_IndexScan, {"a", "d"});
+    check("b = 3 and c > 10", T_IndexScan, {"b", "c", "d"});
+    check("b > 90", T_IndexScan, {"b", "c", "d"});
+    // 其余都相同时字段少的优先
+    check("a = 1", T_IndexScan, {"a", "d"});
+    check("a > 3 and e = 1", T_IndexScan, {"a", "d"});
+    // 等值前缀长度相同时，按前缀的不同取值个数估计匹配的行数，少的优先
+    check("a = 1 and c = 7", T_IndexScan, {"c", "d"});
+    check("a = 2 and b = 12 and c = 12", T_IndexScan, {"b", "c", "d"});
+    // 哈希索引只在它覆盖的等值字段不少于B+树的等值前缀时使用
+    check("d = 5", T_PointIndexScan, {"d"});
+    check("d = 5 and e = 5", T_PointIndexScan, {"d"});
+    check("b = 5 and c = 5 and d = 5", T_IndexScan, {"b", "c", "d"});
+    // 没有可用的前缀
+    check("e = 5", T_SeqScan, {});
+    check("a <> 1 and e = 3", T_SeqScan, {});
+}
+
+/**
+ * @brief 索引嵌套循环连接的结果与块嵌套循环连接相同：外表有重复的连接key、有内表中不存在的key，
+ * 探测key由连接字段和内表上的常量条件组成，内表上还有不参与探测的条件
+ */
+TEST_F(ExecutorTest, IndexNestedLoopJoinTest) {
+    const int num_outer = 3000;
+    const int num_keys = 400;
+    std::vector<std::string> rows;
+    for (int i = 0; i < num_outer; i++) {
+        rows.push_back(std::to_string(i) + "," + std::to_string(i % 500));
+    }
+    std::mt19937 rng(48);
+    std::shuffle(rows.begin(), rows.end(), rng);
+    create_table("o", {{.name = "id", .type = TYPE_INT, .len = 4}, {.name = "k", .type = TYPE_INT, .len = 4}}, rows);
+    rows.clear();
+    for (int k = 0; k < num_keys; k++) {
+        for (int v = 0; v < 3; v++) {
+            rows.push_back(std::to_string(k) + "," + std::to_string(v) + "," + std::to_string((k * 3 + v) % 11));
+        }
+    }
+    std::shuffle(rows.begin(), rows.end(), rng);
+    create_table("r",
+                 {{.name = "k", .type = TYPE_INT, .len = 4},
+                  {.name = "v", .type = TYPE_INT, .len = 4},
+                  {.name = "w", .type = TYPE_INT, .len = 4}},
+                 rows);
+    sm_manager_->create_index("r", {"k", "v"}, context_.get());
+    sm_manager_->create_index("r", {"v", "k"}, context_.get());
+
+    auto outer = [&] {
+        return std::make_unique<SeqScanExecutor>(sm_manager_.get(), "o", std::vector<Condition>(), context_.get());
+    };
+    auto check = [&](const std::vector<Condition> &inner_conds, const std::vector<Condition> &conds,
+                     const std::vector<std::string> &index_cols) {
+        BlockNestedLoopJoinExecutor bnlj(outer(), std::make_unique<SeqScanExecutor>(sm_manager_.get(), "r", inner_conds, context_.get()),
+                                         conds, bpm_.get());
+        auto expected = collect(bnlj);
+        IndexNestedLoopJoinExecutor inlj(outer(), sm_manager_.get(), "r", inner_conds, index_cols, conds, context_.get());
+        assert(collect(inlj) == expected);
+        assert(collect_batches(inlj) == expected);
+        return expected.size();
+    };
+    Condition join = col_cond({"o", "k"}, OP_EQ, {"r", "k"});
+
+    // 只有k在探测key中，每个外表key匹配内表的3条记录
+    assert(check({}, {join}, {"k", "v"}) == (size_t)num_outer * num_keys / 500 * 3);
+    // 内表上不参与探测的条件和额外的连接条件在取出记录后检查
+    check({int_cond("r", "w", OP_LT, 5)}, {join, col_cond({"o", "id"}, OP_GT, {"r", "w"})}, {"k", "v"});
+    // 常量条件v = 1与连接字段k一起组成探测key
+    assert(check({int_cond("r", "v", OP_EQ, 1)}, {join}, {"v", "k"}) == (size_t)num_outer * num_keys / 500);
+    // 连接条件写成r.k = o.k
+    check({int_cond("r", "v", OP_EQ, 2)}, {col_cond({"r", "k"}, OP_EQ, {"o", "k"})}, {"v", "k"});
+
+    // 索引的第一个字段上没有等值条件时不能构造
+    bool thrown = false;
+    try {
+        IndexNestedLoopJoinExecutor inlj(outer(), sm_manager_.get(), "r", {}, {"v", "k"}, {join}, context_.get());
+    } catch (InternalError &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+/**
+ * @brief 非唯一B+树索引保存key重复的每一条记录：批量构建、向空索引和非空索引导入、UPDATE、DELETE和REINDEX之后
+ * 每条记录都能通过索引找到，范围扫描和只扫描索引的结果与顺序扫描相同，统计信息中不含附加的rid字段
+ */
+TEST_F(ExecutorTest, NonUniqueIndexTest) {
+    const int num_vals = 7;
+    auto make_rows = [](int from, int to) {
+        std::vector<std::string> rows;
+        for (int i = from; i < to; i++) {
+            rows.push_back(std::to_string(i % num_vals) + "," + std::to_string(i));
+        }
+        return rows;
+    };
+    ColDef col_a = {.name = "a", .type = TYPE_INT, .len = 4};
+    ColDef col_b = {.name = "b", .type = TYPE_INT, .len = 4};
+    std::vector<std::string> a_col = {"a"};
+    auto check_scans = [&](const std::string &tab_name) {
+        std::vector<std::vector<Condition>> cases = {
+            {int_cond(tab_name, "a", OP_EQ, 3)},
+            {int_cond(tab_name, "a", OP_GT, 4)},
+            {int_cond(tab_name, "a", OP_GE, 2), int_cond(tab_name, "a", OP_LT, 5)},
+            {int_cond(tab_name, "a", OP_LE, 1)},
+        };
+        for (auto &conds : cases) {
+            SeqScanExecutor seq_scan(sm_manager_.get(), tab_name, conds, context_.get());
+            auto expected = collect(seq_scan);
+            IndexScanExecutor index_scan(sm_manager_.get(), tab_name, conds, a_col, context_.get());
+            assert(collect(index_scan) == expected);
+            IndexOnlyScanExecutor index_only_scan(sm_manager_.get(), tab_name, conds, a_col, context_.get());
+            auto keys = collect_batches(index_only_scan);
+            assert(keys.size() == expected.size());
+            for (size_t i = 0; i < keys.size(); i++) {
+                assert(keys[i] == expected[i].substr(0, sizeof(int)));
+            }
+        }
+    };
+
+    // 表中已有的记录批量构建，之后导入的记录逐条插入非空的索引
+    create_table("n", {col_a, col_b}, make_rows(0, 2000));
+    sm_manager_->create_index("n", a_col, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_BTREE, false, true);
+    IxIndexHandle *ih = sm_manager_->ihs_.at(ix_manager_->get_index_name("n", a_col)).get();
+    assert(!ih->is_unique() && ih->user_key_len() == (int)sizeof(int));
+    check_indexes("n");
+    load_rows("n", make_rows(2000, 3000));
+    check_indexes("n");
+    check_scans("n");
+    ih->refresh_stats();
+    IxIndexStats stats = ih->get_stats();
+    assert(stats.num_entries == 3000);
+    assert(stats.distinct_prefixes == std::vector<int64_t>{num_vals});
+    std::vector<Rid> found;
+    int key = 3;
+    assert(ih->get_value((const char *)&key, &found, nullptr));
+    assert(found.size() == matching_rids("n", {int_cond("n", "a", OP_EQ, key)}).size());
+
+    // key改成另一个重复的值，删除key重复的一部分记录
+    update_rows("n", {int_set("n", "a", 5)}, {int_cond("n", "b", OP_LT, 300)});
+    check_indexes("n");
+    delete_rows("n", {int_cond("n", "a", OP_EQ, 5), int_cond("n", "b", OP_GE, 150)});
+    check_indexes("n");
+    check_scans("n");
+    sm_manager_->reindex("n", a_col, context_.get());
+    ih = sm_manager_->ihs_.at(ix_manager_->get_index_name("n", a_col)).get();
+    assert(!ih->is_unique());
+    // 重建时重新计算了前缀取值个数
+    int64_t num_rows = matching_rids("n", {}).size();
+    int64_t num_distinct = 0;
+    for (int v = 0; v < num_vals; v++) {
+        num_distinct += !matching_rids("n", {int_cond("n", "a", OP_EQ, v)}).empty();
+    }
+    stats = ih->get_stats();
+    assert(stats.num_entries == num_rows && stats.distinct_prefixes == std::vector<int64_t>{num_distinct});
+    check_indexes("n");
+    check_scans("n");
+
+    // 向空的非唯一索引导入，排序后key相同的记录按rid排列
+    sm_manager_->create_table("m", {col_a, col_b}, "", context_.get());
+    sm_manager_->create_index("m", a_col, context_.get());
+    load_rows("m", make_rows(0, 3000));
+    check_indexes("m");
+    check_scans("m");
+}
+
+/**
+ * @brief 多条记录的UPDATE中某条记录违反唯一约束时整条语句不生效：之前已经修改的记录和所有索引都恢复原样
+ */
+TEST_F(ExecutorTest, UpdateUniqueConflictTest) {
+    std::vector<std::string> rows;
+    for (int i = 0; i < 200; i++) {
+        rows.push_back(std::to_string(i) + "," + std::to_string(i % 10) + "," + std::to_string(i % 3));
+    }
+    create_table("u",
+                 {{.name = "id", .type = TYPE_INT, .len = 4},
+                  {.name = "v", .type = TYPE_INT, .len = 4},
+                  {.name = "w", .type = TYPE_INT, .len = 4}},
+                 rows);
+    sm_manager_->create_index("u", {"id"}, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_BTREE, true);
+    sm_manager_->create_index("u", {"v"}, context_.get());
+    sm_manager_->create_index("u", {"w", "id"}, context_.get());
+    sm_manager_->create_index("u", {"v", "id"}, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_HASH, true);
+    auto before = scan_table("u");
+
+    auto expect_conflict = [&](const std::vector<SetClause> &set_clauses, const std::vector<Condition> &conds) {
+        bool thrown = false;
+        try {
+            update_rows("u", set_clauses, conds);
+        } catch (UniqueConstraintError &) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(scan_table("u") == before);
+        check_indexes("u");
+    };
+    // 第一条记录改成1000成功，第二条记录与它冲突，要撤销第一条记录
+    expect_conflict({int_set("u", "id", 1000), int_set("u", "v", 42)}, {int_cond("u", "id", OP_GE, 50)});
+    // 第一条记录就与表中原有的key冲突，非唯一索引(w, id)中已经删除的旧key也要恢复
+    expect_conflict({int_set("u", "w", 7), int_set("u", "id", 150)}, {int_cond("u", "id", OP_GE, 140),
+                                                                        int_cond("u", "id", OP_LT, 151)});
+
+    // 不冲突的UPDATE正常生效
+    update_rows("u", {int_set("u", "id", 1000), int_set("u", "v", 42)}, {int_cond("u", "id", OP_EQ, 50)});
+    check_indexes("u");
+    assert(matching_rids("u", {int_cond("u", "id", OP_EQ, 1000), int_cond("u", "v", OP_EQ, 42)}).size() == 1);
+}
+
+/**
+ * @brief UPDATE只维护key的字节发生变化的索引：key不涉及被修改字段的索引、被修改的字段取值没变的索引都不访问，
+ * key变化的索引中旧key被删除、新key指向同一条记录；违反唯一约束时变化的索引恢复旧key，不变的索引仍然不访问。
+ * 事先从不应被访问的索引中删掉这条记录的键值对，之后它仍然不在索引中，就说明UPDATE没有访问这个索引
+ */
+TEST_F(ExecutorTest, UpdateIndexMaintenanceTest) {
+    std::vector<std::string> rows;
+    for (int i = 0; i < 100; i++) {
+        rows.push_back(std::to_string(i) + "," + std::to_string(i % 5) + "," + std::to_string(i % 4));
+    }
+    create_table("k",
+                 {{.name = "id", .type = TYPE_INT, .len = 4},
+                  {.name = "v", .type = TYPE_INT, .len = 4},
+                  {.name = "w", .type = TYPE_INT, .len = 4}},
+                 rows);
+    sm_manager_->create_index("k", {"id"}, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_BTREE, true);
+    sm_manager_->create_index("k", {"v"}, context_.get());
+    sm_manager_->create_index("k", {"w"}, context_.get());
+    sm_manager_->create_index("k", {"v", "id"}, context_.get());
+    TabMeta &tab = sm_manager_->db_.get_table("k");
+    Rid rid = matching_rids("k", {int_cond("k", "id", OP_EQ, 10)}).at(0);
+
+    auto has_entry = [&](const std::vector<std::string> &col_names, const std::vector<int> &key) {
+        std::vector<Rid> found;
+        sm_manager_->get_index_value(*tab.get_index_meta(col_names), (const char *)key.data(), &found, nullptr);
+        return std::find(found.begin(), found.end(), rid) != found.end();
+    };
+    auto remove_sentinels = [&]() {
+        for (auto &col_name : {"v", "w"}) {
+            int key = col_name == std::string("v") ? 0 : 2;
+            assert(sm_manager_->delete_index_entry(*tab.get_index_meta({col_name}), (const char *)&key, rid, nullptr));
+        }
+    };
+    auto restore_sentinels = [&]() {
+        for (auto &col_name : {"v", "w"}) {
+            int key = col_name == std::string("v") ? 0 : 2;
+            assert(sm_manager_->insert_index_entry(*tab.get_index_meta({col_name}), (const char *)&key, rid, nullptr));
+        }
+    };
+
+    // id改变，v写入原来的值，w不在set子句中
+    remove_sentinels();
+    update_rows("k", {int_set("k", "v", 0), int_set("k", "id", 1010)}, {int_cond("k", "id", OP_EQ, 10)});
+    assert(!has_entry({"v"}, {0}) && !has_entry({"w"}, {2}));
+    assert(!has_entry({"id"}, {10}) && has_entry({"id"}, {1010}));
+    assert(!has_entry({"v", "id"}, {0, 10}) && has_entry({"v", "id"}, {0, 1010}));
+    restore_sentinels();
+    check_indexes("k");
+
+    // 违反唯一约束：变化的索引恢复旧key，不变的索引仍然不访问
+    remove_sentinels();
+    bool thrown = false;
+    try {
+        update_rows("k", {int_set("k", "v", 0), int_set("k", "id", 20)}, {int_cond("k", "id", OP_EQ, 1010)});
+    } catch (UniqueConstraintError &) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(!has_entry({"v"}, {0}) && !has_entry({"w"}, {2}));
+    assert(has_entry({"id"}, {1010}) && has_entry({"v", "id"}, {0, 1010}) && !has_entry({"v", "id"}, {0, 20}));
+    restore_sentinels();
+    check_indexes("k");
+    assert(matching_rids("k", {int_cond("k", "id", OP_EQ, 1010)}) == std::vector<Rid>{rid});
+}
+
+/**
+ * @brief REINDEX与对表的并发修改同时进行：定长和slotted两种格式的表各有一个线程不断地插入、删除和更新记录，
+ * 更新会改变索引字段和变长字段的长度，slotted格式下记录会被搬到其他页面。重建完成后新索引与表中的记录一致
+ */
+TEST_F(ExecutorTest, ConcurrentReindexTest) {
+    const int num_rows = 20000;
+    std::vector<std::string> tab_names = {"cf", "cs"};
+    for (auto &tab_name : tab_names) {
+        std::vector<std::string> rows;
+        for (int i = 0; i < num_rows; i++) {
+            rows.push_back(std::to_string(i) + "," + std::to_string(i % 50) + "," + std::string(i % 40 + 1, 'a'));
+        }
+        create_table(tab_name,
+                     {{.name = "id", .type = TYPE_INT, .len = 4},
+                      {.name = "k", .type = TYPE_INT, .len = 4},
+                      {.name = "s", .type = tab_name == "cf" ? TYPE_STRING : TYPE_VARCHAR, .len = 160}},
+                     rows);
+        sm_manager_->create_index(tab_name, {"id"}, context_.get(), IX_DEFAULT_FILL_FACTOR, INDEX_BTREE, true);
+        sm_manager_->create_index(tab_name, {"k"}, context_.get());
+        sm_manager_->create_index(tab_name, {"k", "s"}, context_.get());
+    }
+    assert(sm_manager_->fhs_.at("cs")->get_file_hdr().layout == RM_LAYOUT_SLOTTED);
+
+    // 与执行器相同，先修改记录文件再维护索引
+    std::atomic<bool> stop{false};
+    std::atomic<int> num_ops{0};
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < tab_names.size(); t++) {
+        std::string tab_name = tab_names[t];
+        RmFileHandle *fh = sm_manager_->fhs_.at(tab_name).get();
+        std::vector<Rid> live;
+        for (auto &[rid, rec] : scan_table(tab_name)) {
+            live.push_back(rid);
+        }
+        writers.emplace_back([&, tab_name, fh, live, t]() mutable {
+            std::mt19937 rng(t);
+            TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+            int k_offset = tab.get_col("k")->offset, s_offset = tab.get_col("s")->offset;
+            RmRecord rec(fh->get_file_hdr().record_size);
+            auto fill = [&](char *data, int k) {
+                memcpy(data + k_offset, &k, sizeof(int));
+                memset(data + s_offset, 0, 160);
+                memset(data + s_offset, 'a' + k % 26, rng() % 160 + 1);
+            };
+            for (int next_id = num_rows; !stop.load(); next_id++) {
+                int op = rng() % 3;
+                if (op == 0 || live.empty()) {
+                    memcpy(rec.data, &next_id, sizeof(int));
+                    fill(rec.data, rng() % 50);
+                    Rid rid = fh->insert_record(rec.data, nullptr);
+                    sm_manager_->insert_index_entries(tab, rec.data, rid, nullptr);
+                    live.push_back(rid);
+                } else {
+                    size_t pos = rng() % live.size();
+                    Rid rid = live[pos];
+                    auto old_rec = fh->get_record(rid, nullptr);
+                    if (op == 1) {
+                        fh->delete_record(rid, nullptr);
+                        sm_manager_->delete_index_entries(tab, old_rec->data, rid, nullptr);
+                        live[pos] = live.back();
+                        live.pop_back();
+                    } else {
+                        memcpy(rec.data, old_rec->data, rec.size);
+                        fill(rec.data, rng() % 50);
+                        fh->update_record(rid, rec.data, nullptr);
+                        sm_manager_->delete_index_entries(tab, old_rec->data, rid, nullptr);
+                        sm_manager_->insert_index_entries(tab, rec.data, rid, nullptr);
+                    }
+                }
+                num_ops++;
+            }
+        });
+    }
+
+    for (int round = 0; round < 3; round++) {
+        for (auto &tab_name : tab_names) {
+            for (auto &index : std::vector<std::vector<std::string>>{{"id"}, {"k"}, {"k", "s"}}) {
+                sm_manager_->reindex(tab_name, index, context_.get());
+            }
+        }
+    }
+    stop = true;
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    assert(num_ops.load() > 0);
+    for (auto &tab_name : tab_names) {
+        check_indexes(tab_name);
+    }
+}